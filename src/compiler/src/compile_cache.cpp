@@ -0,0 +1,74 @@
+#include "compile_cache.h"
+#include <cstdlib>
+
+using namespace std;
+
+CompileCache::CompileCache(size_t capacityBytes)
+    : capacity(capacityBytes) {}
+
+// Payload plus a rough allowance for the list node, index slot and control block
+size_t CompileCache::entryBytes(const CompileResult& r) {
+    return r.output.size() + sizeof(Entry) + sizeof(CompileResult) + 64;
+}
+
+shared_ptr<const CompileResult> CompileCache::get(const Key& key) {
+    lock_guard<mutex> lock(entriesMutex);
+
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+
+    lru.splice(lru.begin(), lru, it->second);
+    if (key.kind == KeyKind::RAW) ++counters.rawHits;
+    else                          ++counters.irHits;
+    return it->second->result;
+}
+
+void CompileCache::put(const Key& key, shared_ptr<const CompileResult> result) {
+    size_t bytes = entryBytes(*result);
+    if (bytes > capacity) return;
+
+    lock_guard<mutex> lock(entriesMutex);
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        usedBytes -= it->second->bytes;
+        it->second->result = move(result);
+        it->second->bytes = bytes;
+        lru.splice(lru.begin(), lru, it->second);
+    } else {
+        lru.push_front({key, move(result), bytes});
+        index.emplace(key, lru.begin());
+    }
+    usedBytes += bytes;
+    evictLocked();
+}
+
+void CompileCache::evictLocked() {
+    while (usedBytes > capacity && !lru.empty()) {
+        Entry& victim = lru.back();
+        usedBytes -= victim.bytes;
+        index.erase(victim.key);
+        lru.pop_back();
+        ++counters.evictions;
+    }
+}
+
+void CompileCache::recordMiss() {
+    lock_guard<mutex> lock(entriesMutex);
+    ++counters.misses;
+}
+
+CompileCache::Stats CompileCache::stats() const {
+    lock_guard<mutex> lock(entriesMutex);
+    Stats s = counters;
+    s.entries = index.size();
+    s.bytes = usedBytes;
+    s.capacityBytes = capacity;
+    return s;
+}
+
+size_t CompileCache::defaultCapacity() {
+    if (const char* env = getenv("SIMRUN_COMPILE_CACHE_MB"))
+        return static_cast<size_t>(strtoull(env, nullptr, 10)) << 20;
+    return size_t(64) << 20;
+}
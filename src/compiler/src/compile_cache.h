@@ -0,0 +1,101 @@
+#pragma once
+#include "content_hash.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+struct CompileResult {
+    bool ok = false;
+    string output;              // compiled IR, or the error message
+};
+
+/*
+ * Content-addressed cache of compile results, bounded by bytes (LRU).
+ *
+ * A result is stored under two kinds of key: a hash of the raw request bytes,
+ * which answers exact resubmissions without parsing, and a hash of the parsed
+ * IR, which also matches exports that only differ in formatting or UI-only
+ * fields. Both carry the catalog version and the output options, so a profile
+ * reload never serves a stale result; old entries simply age out.
+ *
+ * Safe to share between request threads. Compiles happen outside the lock, so
+ * two concurrent misses on the same input may both compile; the second store
+ * just refreshes the entry.
+ */
+class CompileCache {
+public:
+    enum class KeyKind : uint8_t { RAW, IR };
+
+    struct Key {
+        Hash128  content;
+        uint64_t catalogVersion = 0;
+        KeyKind  kind = KeyKind::RAW;
+        uint8_t  format = 0;
+        bool     compact = false;
+
+        bool operator==(const Key& o) const {
+            return content == o.content && catalogVersion == o.catalogVersion
+                && kind == o.kind && format == o.format && compact == o.compact;
+        }
+    };
+
+    struct Stats {
+        uint64_t rawHits = 0;
+        uint64_t irHits = 0;
+        uint64_t misses = 0;        // requests that had to be compiled
+        uint64_t evictions = 0;
+        size_t   entries = 0;
+        size_t   bytes = 0;
+        size_t   capacityBytes = 0;
+    };
+
+    explicit CompileCache(size_t capacityBytes);
+
+    CompileCache(const CompileCache&) = delete;
+    CompileCache& operator=(const CompileCache&) = delete;
+
+    // Counts a hit on success; a failed lookup is not a miss by itself
+    shared_ptr<const CompileResult> get(const Key& key);
+
+    // Results larger than the whole cache are not stored. A result stored
+    // under both a RAW and an IR key is charged to each, so the bound is
+    // conservative.
+    void put(const Key& key, shared_ptr<const CompileResult> result);
+
+    void recordMiss();
+
+    Stats stats() const;
+
+    // $SIMRUN_COMPILE_CACHE_MB, else 64 MB; 0 disables caching
+    static size_t defaultCapacity();
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return static_cast<size_t>(k.content.lo ^ (k.catalogVersion * 0x9e3779b97f4a7c15ULL)
+                                       ^ (uint64_t(k.kind) << 8 | uint64_t(k.format) << 1 | k.compact));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        shared_ptr<const CompileResult> result;
+        size_t bytes;
+    };
+
+    mutable mutex entriesMutex;
+    list<Entry> lru;                                            // front = most recent
+    unordered_map<Key, list<Entry>::iterator, KeyHash> index;
+    size_t capacity;
+    size_t usedBytes = 0;
+    Stats counters;
+
+    static size_t entryBytes(const CompileResult& r);
+    void evictLocked();
+};
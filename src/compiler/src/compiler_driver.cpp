@@ -1,25 +1,163 @@
 #include "compiler_driver.h"
 #include "ir_parser.h"
 #include "validator.h"
-#include "profile_repository.h"
 #include "profile_resolver.h"
 #include "ir_serializer.h"
+#include "ir_binary_writer.h"
+#include "json_writer.h"
+#include <stdexcept>
 
-string compileIR(const string& rawIR, bool& ok) {
+using namespace std;
 
-    IR ir = parseIR(rawIR);
+static void writeIds(JsonWriter& w, string_view key, const vector<string>& ids) {
+    w.key(key);
+    w.beginArray();
+    for (auto& id : ids) w.text(id);
+    w.endArray();
+}
 
-    string err = validateIR(ir);
-    if (!err.empty()) {
-        ok = false;
-        return err;
+// What the UI gets back when validation stops a compile: totals, the issues
+// the validator kept (rule code, rendered message, entities) and a count per
+// rule of the findings its caps left out
+static void validationReport(const simrun::ValidationResult& r, bool compact, string& out) {
+    JsonWriter w(out, compact);
+    w.beginObject();
+    w.key("errors");   w.integer(static_cast<int64_t>(r.errorCount()));
+    w.key("warnings"); w.integer(static_cast<int64_t>(r.warningCount()));
+
+    w.key("issues");
+    w.beginArray();
+    for (auto& issue : r.issues) {
+        w.beginObject();
+        w.key("severity"); w.text(simrun::severityStr(issue.severity));
+        w.key("code");     w.text(simrun::issueCodeStr(issue.code));
+        w.key("module");   w.text(issue.source_module);
+        w.key("message");  w.text(issue.message());
+        writeIds(w, "components", issue.related_components);
+        writeIds(w, "connections", issue.related_connections);
+        if (issue.omitted_components) {
+            w.key("omitted_components");
+            w.integer(static_cast<int64_t>(issue.omitted_components));
+        }
+        w.endObject();
+    }
+    w.endArray();
+
+    w.key("suppressed");
+    w.beginArray();
+    for (auto& rule : r.rules) {
+        if (rule.total == rule.reported) continue;
+        w.beginObject();
+        w.key("code");     w.text(simrun::issueCodeStr(rule.code));
+        w.key("severity"); w.text(simrun::severityStr(rule.severity));
+        w.key("module");   w.text(rule.source_module);
+        w.key("count");    w.integer(static_cast<int64_t>(rule.total - rule.reported));
+        w.endObject();
     }
+    w.endArray();
+
+    w.endObject();
+    if (!compact) out += '\n';
+}
+
+// Validate, resolve and serialize an already parsed IR into `out`, which is
+// overwritten; its capacity is kept for the next compile on this thread
+static void compileParsed(IR& ir, const ProfileCatalog& profiles, bool& ok,
+                          const CompileOptions& options, string& out) {
+    out.clear();
 
-    ProfileRepository repo("../profiles");
-    ProfileResolver resolver(repo);
+    // Modules are stateless, so one validator serves every request thread
+    static const simrun::Validator validator = simrun::Validator::createDefault();
 
-    resolver.resolve(ir);
+    simrun::ValidationResult report = validator.validate(ir);
+    if (!report.canProceed) {
+        ok = false;
+        validationReport(report, options.compact, out);
+        return;
+    }
+
+    try {
+        ProfileResolver(profiles).resolve(ir);
+    } catch (const exception& e) {
+        ok = false;
+        out = e.what();
+        return;
+    }
 
     ok = true;
-    return serializeIR(ir);
+    if (options.format == OutputFormat::BINARY)
+        serializeIRBinary(ir, out);
+    else
+        serializeIR(ir, out, options.compact);
+}
+
+string compileIR(const string& rawIR, const ProfileCatalog& profiles, bool& ok,
+                 const CompileOptions& options) {
+
+    IR ir;
+    try {
+        ir = parseIR(rawIR);
+    } catch (const exception& e) {
+        ok = false;
+        return e.what();
+    }
+
+    string output;
+    compileParsed(ir, profiles, ok, options, output);
+    return output;
+}
+
+static CompileCache::Key cacheKey(const Hash128& content, CompileCache::KeyKind kind,
+                                  const ProfileCatalog& profiles, const CompileOptions& options) {
+    CompileCache::Key key;
+    key.content = content;
+    key.catalogVersion = profiles.version();
+    key.kind = kind;
+    key.format = static_cast<uint8_t>(options.format);
+    key.compact = options.format == OutputFormat::JSON && options.compact;
+    return key;
+}
+
+string compileIR(const string& rawIR, const ProfileCatalog& profiles, bool& ok,
+                 const CompileOptions& options, CompileCache& cache) {
+
+    // 1. Exact resubmission: no parsing at all
+    auto rawKey = cacheKey(hashBytes(rawIR), CompileCache::KeyKind::RAW, profiles, options);
+    if (auto hit = cache.get(rawKey)) {
+        ok = hit->ok;
+        return hit->output;
+    }
+
+    auto store = [&](const CompileCache::Key* irKey, string output) {
+        auto result = make_shared<CompileResult>();
+        result->ok = ok;
+        result->output = move(output);
+        cache.put(rawKey, result);
+        if (irKey) cache.put(*irKey, result);
+        return result;
+    };
+
+    IR ir;
+    try {
+        ir = parseIR(rawIR);
+    } catch (const exception& e) {
+        cache.recordMiss();
+        ok = false;
+        return store(nullptr, e.what())->output;
+    }
+
+    // 2. Same diagram, different bytes (formatting, key order, UI-only fields)
+    auto irKey = cacheKey(hashIR(ir), CompileCache::KeyKind::IR, profiles, options);
+    if (auto hit = cache.get(irKey)) {
+        cache.put(rawKey, hit);
+        ok = hit->ok;
+        return hit->output;
+    }
+
+    // Serialized into this thread's buffer - a job worker or a server thread -
+    // so the growth happens once per thread; the cache keeps an exact-size copy
+    static thread_local string buffer;
+    cache.recordMiss();
+    compileParsed(ir, profiles, ok, options, buffer);
+    return store(&irKey, string(buffer))->output;
 }
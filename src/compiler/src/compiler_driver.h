@@ -1,6 +1,28 @@
 #pragma once
 #include <string>
+#include "compile_cache.h"
+#include "profile_catalog.h"
 
 using namespace std;
 
-string compileIR(const string& rawIR, bool& ok);
+enum class OutputFormat {
+    JSON,       // for the UI
+    BINARY      // mmap-able image for the simulator (ir_binary_format.h)
+};
+
+struct CompileOptions {
+    OutputFormat format = OutputFormat::JSON;
+    bool compact = false;       // JSON only: no indentation or newlines
+};
+
+// Parse, validate, resolve, serialize - all on the one IR, in place.
+// `profiles` is typically *ProfileRepository::current(), held for the call.
+// On failure `ok` is false and the result is the error: plain text for input
+// or profile errors, a JSON report of the issues when validation fails.
+string compileIR(const string& rawIR, const ProfileCatalog& profiles, bool& ok,
+                 const CompileOptions& options = {});
+
+// Same, but answers from `cache` when this input - or one that parses to the
+// same IR - was already compiled against the same catalog with the same options
+string compileIR(const string& rawIR, const ProfileCatalog& profiles, bool& ok,
+                 const CompileOptions& options, CompileCache& cache);
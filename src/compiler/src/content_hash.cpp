@@ -0,0 +1,174 @@
+#include "content_hash.h"
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+static constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+static constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+static inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+static inline uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+Hasher::Hasher(uint64_t seed)
+    : h1(seed ^ 0x9e3779b97f4a7c15ULL), h2(seed ^ 0x6a09e667f3bcc909ULL) {}
+
+void Hasher::word(uint64_t k) {
+    uint64_t k1 = rotl(k * C1, 31) * C2;
+    uint64_t k2 = rotl(k * C2, 33) * C1;
+
+    h1 ^= k1;
+    h1 = rotl(h1, 27) + h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    h2 ^= k2;
+    h2 = rotl(h2, 31) + h1;
+    h2 = h2 * 5 + 0x38495ab5;
+}
+
+void Hasher::bytes(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    length += size;
+
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        word(k);
+    }
+    if (size) {
+        uint64_t k = 0;
+        memcpy(&k, p, size);
+        word(k ^ (uint64_t(size) << 56));     // tail marked with its length
+    }
+}
+
+void Hasher::text(string_view s) {
+    u64(s.size());
+    bytes(s.data(), s.size());
+}
+
+void Hasher::u64(uint64_t v) {
+    length += 8;
+    word(v);
+}
+
+void Hasher::number(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof bits);
+    u64(bits);
+}
+
+Hash128 Hasher::finish() const {
+    uint64_t a = h1 ^ length;
+    uint64_t b = h2 ^ length;
+    a += b;
+    b += a;
+    a = fmix(a);
+    b = fmix(b);
+    a += b;
+    b += a;
+    return {a, b};
+}
+
+Hash128 hashBytes(string_view raw) {
+    Hasher h(1);
+    h.bytes(raw.data(), raw.size());
+    return h.finish();
+}
+
+// ---------- IR ----------
+
+static void hashParams(Hasher& h, const IR& ir, ParamRange range, vector<uint32_t>& order) {
+    const ParamSlot* slots = ir.slots(range);
+    orderByName(ir, slots, range.count, order);
+
+    h.u64(range.count);
+    for (uint32_t i : order) {
+        const ParamSlot& p = slots[i];
+        h.text(ir.paramName(p.key));
+        h.u64(static_cast<uint64_t>(p.type));
+        switch (p.type) {
+            case ParamType::INT:    h.u64(static_cast<uint64_t>(p.i)); break;
+            case ParamType::DOUBLE: h.number(p.d); break;
+            case ParamType::BOOL:   h.u64(p.b); break;
+            case ParamType::STRING: h.text(p.text()); break;
+        }
+    }
+}
+
+static void hashOptional(Hasher& h, const optional<double>& v) {
+    h.u64(v.has_value());
+    if (v) h.number(*v);
+}
+
+Hash128 hashIR(const IR& ir) {
+    Hasher h(2);
+    vector<uint32_t> order;
+
+    h.u64(ir.components.size());
+    for (auto& c : ir.components) {
+        h.text(c.id);
+        h.text(c.category);
+        h.text(c.implementation);
+        hashParams(h, ir, c.user_params, order);
+    }
+
+    h.u64(ir.links.size());
+    for (auto& l : ir.links) {
+        h.text(l.id);
+        h.text(l.from);
+        h.text(l.to);
+        h.text(l.type);
+        hashParams(h, ir, l.user_params, order);
+    }
+
+    h.u64(ir.routes.size());
+    for (auto& r : ir.routes) {
+        h.text(r.id);
+        h.text(r.name);
+        h.text(r.entry);
+        h.number(r.weight);
+        h.u64(r.path.size());
+        for (auto& hop : r.path) h.text(hop);
+    }
+
+    const auto& w = ir.workload;
+    h.text(w.type);
+    h.number(w.base_rps);
+    h.number(w.duration_ms);
+    h.text(w.distribution);
+    h.u64(w.distribution_params.size());
+    for (auto& [k, v] : w.distribution_params) {
+        h.text(k);
+        h.number(v);
+    }
+    h.u64(w.spikes.size());
+    for (auto& s : w.spikes) {
+        h.text(s.id);
+        h.number(s.time_ms);
+        h.number(s.rps);
+        h.number(s.duration_ms);
+    }
+
+    h.u64(ir.faults.size());
+    for (auto& f : ir.faults) {
+        h.text(f.id);
+        h.text(f.target);
+        h.text(f.target_type);
+        h.text(f.fault_type);
+        h.text(f.mode);
+        hashOptional(h, f.probability);
+        hashOptional(h, f.scheduled_time_ms);
+        hashOptional(h, f.duration_ms);
+    }
+
+    return h.finish();
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "ir.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+using namespace std;
+
+/*
+ * 128-bit content hashes for the compile cache.
+ *
+ * Not cryptographic: this is a MurmurHash3-style mixer over 8-byte words,
+ * fast enough to hash a multi-megabyte export in well under a millisecond per
+ * megabyte. Every variable-length field is length-prefixed, so concatenations
+ * of different fields cannot collide by construction.
+ */
+
+struct Hash128 {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const Hash128& o) const { return lo == o.lo && hi == o.hi; }
+    bool operator!=(const Hash128& o) const { return !(*this == o); }
+};
+
+class Hasher {
+public:
+    explicit Hasher(uint64_t seed = 0);
+
+    void bytes(const void* data, size_t size);
+    void text(string_view s);               // length-prefixed
+    void u64(uint64_t v);
+    void number(double d);                  // by bit pattern: -0.0 serializes differently from 0.0
+
+    Hash128 finish() const;
+
+private:
+    uint64_t h1;
+    uint64_t h2;
+    uint64_t length = 0;
+
+    void word(uint64_t k);
+};
+
+// Hash of the exact request bytes
+Hash128 hashBytes(string_view raw);
+
+/*
+ * Hash of everything in a parsed (unresolved) IR that can affect compile
+ * output. Two exports that differ only in whitespace, key order, escaping or
+ * UI-only fields (positions, labels, metadata) hash the same.
+ */
+Hash128 hashIR(const IR& ir);
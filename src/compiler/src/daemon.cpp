@@ -0,0 +1,340 @@
+#include "daemon.h"
+#include "json_writer.h"
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+using namespace std;
+using namespace daemon_protocol;
+
+// ---------- Raw I/O ----------
+
+// False on end of file or error
+static bool readAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int n = _read(fd, data, static_cast<unsigned>(min(size, size_t(1) << 30)));
+#else
+        ssize_t n = read(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned>(min(size, size_t(1) << 30)));
+#else
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool skip(int fd, size_t size) {
+    char buf[65536];
+    while (size > 0) {
+        size_t n = min(size, sizeof(buf));
+        if (!readAll(fd, buf, n)) return false;
+        size -= n;
+    }
+    return true;
+}
+
+static void putU32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<char>(v >> (8 * i));
+}
+
+static uint32_t getU32(const char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= uint32_t(static_cast<unsigned char>(p[i])) << (8 * i);
+    return v;
+}
+
+// ---------- Session ----------
+
+/*
+ * One client. Job callbacks hold a reference, so a session outlives the
+ * connection if a delivery is still in flight; close() makes sure nothing is
+ * written once the caller may have closed the descriptor.
+ */
+class CompilerDaemon::Session : public enable_shared_from_this<Session> {
+public:
+    Session(CompilerDaemon& daemon, int outFd) : daemon(daemon), outFd(outFd) {}
+
+    void handle(uint32_t id, uint8_t type, uint8_t flags, string payload);
+    void send(uint32_t id, uint8_t type, uint8_t flags, string_view payload);
+    void close();
+
+private:
+    struct Pending {
+        string   jobId;
+        uint64_t token = 0;
+    };
+
+    CompilerDaemon& daemon;
+    int outFd;
+
+    mutex writeMutex;
+    bool closed = false;
+
+    mutex pendingMutex;
+    unordered_map<uint32_t, Pending> pending;       // COMPILE requests by client id
+
+    void compile(uint32_t id, uint8_t flags, string input);
+    void sendResult(uint32_t id, bool ok, string_view output);
+};
+
+void CompilerDaemon::Session::send(uint32_t id, uint8_t type, uint8_t flags, string_view payload) {
+    char header[HEADER_BYTES];
+    putU32(header, static_cast<uint32_t>(payload.size() + HEADER_BYTES - 4));
+    putU32(header + 4, id);
+    header[8] = static_cast<char>(type);
+    header[9] = static_cast<char>(flags);
+
+    lock_guard<mutex> lock(writeMutex);
+    if (closed) return;
+    if (!writeAll(outFd, header, sizeof(header)) || !writeAll(outFd, payload.data(), payload.size()))
+        closed = true;      // the reader sees the hang-up too and ends the session
+}
+
+void CompilerDaemon::Session::sendResult(uint32_t id, bool ok, string_view output) {
+    uint8_t flags = ok ? OK : 0;
+    do {
+        string_view chunk = output.substr(0, RESULT_CHUNK_BYTES);
+        output.remove_prefix(chunk.size());
+        send(id, RESULT, flags | (output.empty() ? 0 : MORE), chunk);
+    } while (!output.empty());
+}
+
+void CompilerDaemon::Session::close() {
+    unordered_map<uint32_t, Pending> left;
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        left.swap(pending);
+    }
+    for (auto& [id, p] : left) {
+        daemon.jobs.unsubscribe(p.token);
+        daemon.jobs.cancel(p.jobId);
+    }
+
+    lock_guard<mutex> lock(writeMutex);
+    closed = true;
+}
+
+void CompilerDaemon::Session::handle(uint32_t id, uint8_t type, uint8_t flags, string payload) {
+    switch (type) {
+        case COMPILE:
+            compile(id, flags, move(payload));
+            return;
+
+        case CANCEL: {
+            string jobId;
+            {
+                lock_guard<mutex> lock(pendingMutex);
+                auto it = pending.find(id);
+                if (it != pending.end()) jobId = it->second.jobId;
+            }
+            // The job's final event answers the COMPILE request itself
+            if (jobId.empty() || !daemon.jobs.cancel(jobId))
+                send(id, REJECTED, 0, "No running request with this id");
+            return;
+        }
+
+        case RELOAD: {
+            string error;
+            bool ok = daemon.profiles.reload(&error);
+            sendResult(id, ok, error);
+            return;
+        }
+
+        case STATS: {
+            CompileCache::Stats c = daemon.cache.stats();
+            JobManager::Stats j = daemon.jobs.stats();
+
+            string body;
+            JsonWriter w(body, true);
+            w.beginObject();
+            w.key("cache");
+            w.beginObject();
+            w.key("raw_hits");  w.integer(c.rawHits);
+            w.key("ir_hits");   w.integer(c.irHits);
+            w.key("misses");    w.integer(c.misses);
+            w.key("entries");   w.integer(c.entries);
+            w.key("bytes");     w.integer(c.bytes);
+            w.endObject();
+            w.key("jobs");
+            w.beginObject();
+            w.key("workers");   w.integer(j.workers);
+            w.key("queued");    w.integer(j.queued);
+            w.key("running");   w.integer(j.running);
+            w.key("succeeded"); w.integer(j.succeeded);
+            w.key("failed");    w.integer(j.failed);
+            w.key("cancelled"); w.integer(j.cancelled);
+            w.key("rejected");  w.integer(j.rejected);
+            w.endObject();
+            w.endObject();
+            sendResult(id, true, body);
+            return;
+        }
+
+        default:
+            send(id, REJECTED, 0, "Unknown request type " + to_string(type));
+    }
+}
+
+void CompilerDaemon::Session::compile(uint32_t id, uint8_t flags, string input) {
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        if (pending.count(id)) {
+            send(id, REJECTED, 0, "A request with this id is still running");
+            return;
+        }
+    }
+
+    JobManager::Request request;
+    request.input = move(input);
+    request.options.format = flags & BINARY ? OutputFormat::BINARY : OutputFormat::JSON;
+    request.options.compact = (flags & COMPACT) != 0;
+
+    string jobId;
+    switch (daemon.jobs.submit(move(request), jobId)) {
+        case JobManager::Admission::ACCEPTED: break;
+        case JobManager::Admission::TOO_LARGE:
+            send(id, REJECTED, 0, "Input too large");
+            return;
+        case JobManager::Admission::QUEUE_FULL:
+        case JobManager::Admission::SHUTTING_DOWN:
+            send(id, REJECTED, 0, "Busy, try again");
+            return;
+    }
+
+    // Registered first: a job that is already done reports through the
+    // callback before subscribe() returns
+    {
+        lock_guard<mutex> lock(pendingMutex);
+        pending[id].jobId = jobId;
+    }
+
+    shared_ptr<Session> self = shared_from_this();
+    uint64_t token = daemon.jobs.subscribe(jobId, [self, id, jobId](const JobEvent& e) {
+        if (!isFinal(e.state)) {
+            string message;
+            JsonWriter w(message, true);
+            w.beginObject();
+            writeJobEvent(w, e);
+            w.endObject();
+            self->send(id, PROGRESS, 0, message);
+            return;
+        }
+
+        {
+            lock_guard<mutex> lock(self->pendingMutex);
+            self->pending.erase(id);
+        }
+        shared_ptr<const JobResult> result = self->daemon.jobs.result(jobId);
+        if (result) self->sendResult(id, result->ok, result->output);
+        else        self->sendResult(id, false, e.error);
+    });
+
+    lock_guard<mutex> lock(pendingMutex);
+    auto it = pending.find(id);
+    if (it != pending.end()) it->second.token = token;
+}
+
+// ---------- CompilerDaemon ----------
+
+CompilerDaemon::CompilerDaemon(ProfileRepository& profiles, CompileCache& cache, JobManager& jobs)
+    : profiles(profiles), cache(cache), jobs(jobs) {}
+
+void CompilerDaemon::serve(int inFd, int outFd) {
+    auto session = make_shared<Session>(*this, outFd);
+
+    char header[HEADER_BYTES];
+    while (readAll(inFd, header, sizeof(header))) {
+        uint32_t length = getU32(header);
+        uint32_t id = getU32(header + 4);
+        uint8_t type = static_cast<uint8_t>(header[8]);
+        uint8_t flags = static_cast<uint8_t>(header[9]);
+
+        // Without a sane length there is no next frame to resynchronize on
+        if (length < HEADER_BYTES - 4) {
+            session->send(id, REJECTED, 0, "Malformed frame");
+            break;
+        }
+
+        // No request carries more than a job input; larger frames are skipped unread
+        size_t size = length - (HEADER_BYTES - 4);
+        if (size > jobs.maxInputBytes()) {
+            if (!skip(inFd, size)) break;
+            session->send(id, REJECTED, 0, "Input too large");
+            continue;
+        }
+
+        string payload(size, '\0');
+        if (!readAll(inFd, payload.data(), size)) break;
+        session->handle(id, type, flags, move(payload));
+    }
+
+    session->close();
+}
+
+void CompilerDaemon::listen(const string& socketPath) {
+#ifdef __linux__
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path))
+        throw runtime_error("Socket path too long: " + socketPath);
+    memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) throw runtime_error(string("socket: ") + strerror(errno));
+
+    unlink(socketPath.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        string err = strerror(errno);
+        ::close(fd);
+        throw runtime_error("Cannot listen on " + socketPath + ": " + err);
+    }
+
+    while (true) {
+        int client = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            throw runtime_error(string("accept: ") + strerror(errno));
+        }
+        thread([this, client] {
+            serve(client, client);
+            ::close(client);
+        }).detach();
+    }
+#else
+    (void)socketPath;
+    throw runtime_error("Unix sockets are not supported on this platform; use --daemon over stdio");
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "compile_cache.h"
+#include "job_manager.h"
+#include "profile_repository.h"
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+/*
+ * Long-lived backend for the desktop shell.
+ *
+ * Instead of one process per run, the shell starts the compiler once with
+ * --daemon and talks to it over stdin/stdout (or a Unix socket). Profiles,
+ * the compile cache and the job workers stay warm between requests, and
+ * inputs and results never touch the filesystem.
+ *
+ * Every message is one frame, integers little-endian:
+ *
+ *     u32 length      bytes that follow this field (at least 6)
+ *     u32 id          chosen by the client, echoed in every reply
+ *     u8  type
+ *     u8  flags
+ *     ... payload
+ *
+ * Requests are handled concurrently; replies to different ids interleave.
+ */
+namespace daemon_protocol {
+
+    constexpr size_t HEADER_BYTES = 10;
+
+    enum Type : uint8_t {
+        // client -> daemon
+        COMPILE  = 0x01,    // payload: the UI's export. Runs as a job: compile, then simulate if installed
+        CANCEL   = 0x02,    // cancels the COMPILE request with the same id
+        RELOAD   = 0x03,    // re-reads the profiles
+        STATS    = 0x04,    // compile cache and job counters as JSON
+
+        // daemon -> client
+        RESULT   = 0x81,    // the output (or error) of a request; large ones span several frames
+        PROGRESS = 0x82,    // a job event as JSON, see writeJobEvent()
+        REJECTED = 0x83,    // the request was not understood or not admitted; nothing else follows
+    };
+
+    enum Flags : uint8_t {
+        BINARY   = 0x01,    // COMPILE: binary IR output
+        COMPACT  = 0x02,    // COMPILE: unindented JSON output
+
+        OK       = 0x01,    // RESULT: success; otherwise the payload is the error
+        MORE     = 0x02,    // RESULT: further frames with the same id follow
+    };
+
+    constexpr size_t RESULT_CHUNK_BYTES = size_t(1) << 20;
+}
+
+class CompilerDaemon {
+public:
+    CompilerDaemon(ProfileRepository& profiles, CompileCache& cache, JobManager& jobs);
+
+    // Serves one client until `inFd` reaches end of file. Requests still
+    // running then are cancelled.
+    void serve(int inFd, int outFd);
+
+    // Accepts clients on a Unix socket, one session each; does not return
+    // unless the socket cannot be set up (runtime_error)
+    void listen(const string& socketPath);
+
+private:
+    ProfileRepository& profiles;
+    CompileCache& cache;
+    JobManager& jobs;
+
+    class Session;
+};
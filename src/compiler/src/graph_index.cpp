@@ -0,0 +1,69 @@
+#include "graph_index.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace simrun {
+
+GraphIndex::GraphIndex(const DiagramIR& ir) : ir_(&ir) {
+    const std::size_t n = ir.components.size();
+    if (ir.by_id.size() != n)
+        throw std::invalid_argument("GraphIndex: IR is not indexed (indexIR)");
+
+    rank_.resize(n);
+    for (std::size_t v = 0; v < n; ++v) rank_[ir.by_id[v]] = static_cast<NodeId>(v);
+
+    // Map endpoints to node numbers and flag repeated IDs
+    const std::size_t m = ir.links.size();
+    connFrom_.resize(m);
+    connTo_.resize(m);
+    connDuplicate_.assign(m, 0);
+
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(m);
+    std::vector<std::uint64_t> edges;
+    edges.reserve(m);
+    for (std::size_t i = 0; i < m; ++i) {
+        const Connection& c = ir.links[i];
+        connFrom_[i] = c.from_index == NO_COMPONENT ? NONE : rank_[c.from_index];
+        connTo_[i]   = c.to_index == NO_COMPONENT ? NONE : rank_[c.to_index];
+        if (!c.id.empty() && !seen.insert(c.id).second) connDuplicate_[i] = 1;
+        if (connFrom_[i] != NONE && connTo_[i] != NONE)
+            edges.push_back(std::uint64_t(connFrom_[i]) << 32 | connTo_[i]);
+    }
+
+    // Sorted (from, to) pairs are the forward CSR rows, already in order
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    outStart_.assign(n + 1, 0);
+    inStart_.assign(n + 1, 0);
+    outTargets_.resize(edges.size());
+    inSources_.resize(edges.size());
+
+    for (std::uint64_t e : edges) {
+        ++outStart_[(e >> 32) + 1];
+        ++inStart_[(e & 0xffffffffu) + 1];
+    }
+    for (std::size_t v = 0; v < n; ++v) {
+        outStart_[v + 1] += outStart_[v];
+        inStart_[v + 1]  += inStart_[v];
+    }
+
+    // Scattering in (from, to) order leaves every reverse row sorted by source
+    std::vector<std::uint32_t> inFill(inStart_.begin(), inStart_.end() - 1);
+    for (std::size_t k = 0; k < edges.size(); ++k) {
+        NodeId from = static_cast<NodeId>(edges[k] >> 32);
+        NodeId to   = static_cast<NodeId>(edges[k] & 0xffffffffu);
+        outTargets_[k] = to;
+        inSources_[inFill[to]++] = from;
+    }
+}
+
+GraphIndex::NodeId GraphIndex::find(std::string_view id) const {
+    std::uint32_t c = ir_->find(id);
+    return c == NO_COMPONENT ? NONE : rank_[c];
+}
+
+} // namespace simrun
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "validator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace simrun {
+
+// ---- GraphIndex ----
+//
+// The connection graph of one DiagramIR, built once per Validator::validate
+// and shared read-only by every module. Components are numbered 0..size()-1
+// in id order (DiagramIR::by_id), and adjacency is stored in CSR form in both
+// directions. Neighbour lists hold each distinct neighbour once, in ascending
+// number (hence id) order; connections whose endpoints do not both exist are
+// left out of the adjacency. Endpoints come from the indices indexIR()
+// resolved, so building the index does no string lookups.
+//
+// Holds pointers into the DiagramIR, which must outlive it.
+
+class GraphIndex {
+public:
+    using NodeId = std::uint32_t;
+    static constexpr NodeId NONE = UINT32_MAX;
+
+    struct Range {
+        const NodeId* first;
+        const NodeId* last;
+        const NodeId* begin() const { return first; }
+        const NodeId* end()   const { return last; }
+        std::size_t   size()  const { return static_cast<std::size_t>(last - first); }
+        bool          empty() const { return first == last; }
+    };
+
+    // Throws std::invalid_argument unless `ir` is indexed
+    explicit GraphIndex(const DiagramIR& ir);
+
+    std::size_t size() const { return rank_.size(); }
+    std::size_t edgeCount() const { return outTargets_.size(); }    // distinct (from, to) pairs
+
+    std::string_view id(NodeId v) const { return component(v).id; }
+    const Component& component(NodeId v) const { return ir_->components[ir_->by_id[v]]; }
+    NodeId           find(std::string_view id) const;               // NONE if absent
+
+    Range successors(NodeId v) const   { return {outTargets_.data() + outStart_[v], outTargets_.data() + outStart_[v + 1]}; }
+    Range predecessors(NodeId v) const { return {inSources_.data() + inStart_[v], inSources_.data() + inStart_[v + 1]}; }
+
+    // Per DiagramIR::links entry
+    NodeId source(std::size_t conn) const { return connFrom_[conn]; }
+    NodeId target(std::size_t conn) const { return connTo_[conn]; }
+    bool   duplicateId(std::size_t conn) const { return connDuplicate_[conn] != 0; }  // an earlier connection has the same ID
+
+private:
+    const DiagramIR*    ir_;
+    std::vector<NodeId> rank_;                          // per DiagramIR::components entry
+
+    std::vector<std::uint32_t> outStart_, inStart_;     // size() + 1 offsets
+    std::vector<NodeId>        outTargets_, inSources_;
+
+    std::vector<NodeId> connFrom_, connTo_;
+    std::vector<char>   connDuplicate_;
+};
+
+} // namespace simrun
@@ -0,0 +1,1015 @@
+#include "incremental_validator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace simrun {
+
+static bool sameIssue(const ValidationIssue& a, const ValidationIssue& b) {
+    return a.severity == b.severity
+        && a.code == b.code
+        && a.source_module == b.source_module
+        && a.params == b.params
+        && a.related_components == b.related_components
+        && a.related_connections == b.related_connections;
+}
+
+// ============================================================
+// Construction / reset
+// ============================================================
+
+IncrementalValidator::IncrementalValidator(const Validator& validator) {
+    for (auto& m : validator.modules()) {
+        std::size_t rank = moduleRank_.size();
+        moduleRank_.emplace(m->name(), rank);
+        (m->incremental() ? incremental_ : fallback_).push_back(m.get());
+    }
+}
+
+ValidationDelta IncrementalValidator::reset(const DiagramIR& ir) {
+    if (ir.by_id.size() != ir.components.size())
+        throw std::invalid_argument("IncrementalValidator::reset: IR is not indexed (indexIR)");
+
+    ValidationDelta delta;
+    delta.removed = result().issues;
+
+    store_ = DiagramIR{};
+    storeLive_ = 0;
+    nodes_.clear();
+    freeNodes_.clear();
+    nodeOf_.clear();
+    sccs_.clear();
+    freeSccs_.clear();
+    conns_.clear();
+    freeConns_.clear();
+    connsById_.clear();
+    connsByEndpoint_.clear();
+    connIssues_.clear();
+    typeCounts_ = {};
+    ingress_.clear();
+    entryDepths_.clear();
+    summaryIssues_.clear();
+    fallbackIssues_.clear();
+    errors_ = warnings_ = 0;
+
+    delta_ = &delta;
+
+    nodes_.reserve(ir.components.size());
+    for (std::uint32_t c : ir.by_id) {
+        NodeId x = allocNode();
+        Node& n = nodes_[x];
+        n.component = keep(ir, ir.components[c]);
+        n.id = n.component.id;
+        n.alive = true;
+        nodeOf_.emplace(n.id, x);
+        ++typeCounts_[static_cast<std::size_t>(n.component.type)];
+    }
+
+    // Bulk load: adjacency only, the topology is derived once afterwards
+    for (auto& link : ir.links) {
+        std::uint32_t slot;
+        if (!freeConns_.empty()) { slot = freeConns_.back(); freeConns_.pop_back(); }
+        else { slot = static_cast<std::uint32_t>(conns_.size()); conns_.emplace_back(); }
+        const Connection c = keep(ir, link);
+        conns_[slot] = ConnSlot{c, true, false};
+        const std::string id(c.id);
+        connsById_[id].push_back(slot);
+        connsByEndpoint_[std::string(c.from)].push_back(slot);
+        if (c.to != c.from)
+            connsByEndpoint_[std::string(c.to)].push_back(slot);
+        markConn(id);
+
+        auto f = nodeOf_.find(c.from);
+        auto t = nodeOf_.find(c.to);
+        if (f == nodeOf_.end() || t == nodeOf_.end()) continue;
+        ++nodes_[f->second].out[t->second];
+        ++nodes_[t->second].in[f->second];
+        conns_[slot].linked = true;
+    }
+
+    rebuildTopology();
+
+    for (auto& [_, x] : nodeOf_) {
+        markNode(x);
+        entrySync_.push_back(x);
+    }
+    for (SccId s = 0; s < sccs_.size(); ++s)
+        if (isCyclic(sccs_[s])) markScc(s);
+    summaryDirty_ = true;
+    changed_ = true;
+
+    flush();
+    delta_ = nullptr;
+
+    delta.errorCount = errors_;
+    delta.warningCount = warnings_;
+    delta.canProceed = errors_ == 0;
+    return delta;
+}
+
+ValidationDelta IncrementalValidator::apply(const DiagramDelta& d) {
+    ValidationDelta delta;
+    delta_ = &delta;
+
+    for (auto& id : d.removeConnections) removeConnections(id);
+    for (auto& id : d.removeComponents)  removeComponent(id);
+
+    for (auto& c : d.upsert.components) {
+        auto it = nodeOf_.find(c.id);
+        if (it == nodeOf_.end()) addComponent(keep(d.upsert, c));
+        else                     updateComponent(it->second, keep(d.upsert, c));
+    }
+
+    // An upsert replaces the connections that had its ID before this delta;
+    // duplicates within the delta are kept, as they would be in a DiagramIR
+    std::unordered_set<std::string> replaced;
+    for (auto& c : d.upsert.links) {
+        std::string id(c.id);
+        if (replaced.insert(id).second) removeConnections(id);
+        addConnection(keep(d.upsert, c));
+    }
+
+    flush();
+    delta_ = nullptr;
+    compactStore();
+
+    delta.errorCount = errors_;
+    delta.warningCount = warnings_;
+    delta.canProceed = errors_ == 0;
+    return delta;
+}
+
+// ============================================================
+// Arena
+// ============================================================
+
+// Below this many slots and strings the arena is never compacted
+static constexpr std::size_t COMPACT_MIN = 4096;
+
+Component IncrementalValidator::keep(const DiagramIR& from, const Component& c) {
+    Component k;
+    k.id = store_.store(c.id);
+    k.category = store_.store(c.category);
+    k.implementation = store_.store(c.implementation);
+    k.type = c.type;
+    k.user_params = keepParams(from, c.user_params);
+    storeLive_ += 3;
+    return k;
+}
+
+Connection IncrementalValidator::keep(const DiagramIR& from, const Connection& c) {
+    Connection k;
+    k.id = store_.store(c.id);
+    k.from = store_.store(c.from);
+    k.to = store_.store(c.to);
+    k.type = store_.store(c.type);
+    k.user_params = keepParams(from, c.user_params);
+    storeLive_ += 4;
+    return k;
+}
+
+ParamRange IncrementalValidator::keepParams(const DiagramIR& from, ParamRange r) {
+    ParamRange out;
+    out.begin = static_cast<std::uint32_t>(store_.params.size());
+    out.count = r.count;
+    for (std::uint32_t i = 0; i < r.count; ++i) {
+        ParamSlot p = from.slots(r)[i];
+        p.key = store_.adoptParamKey(from, p.key);
+        if (p.type == ParamType::STRING) p = ParamSlot::text(p.key, store_.store(p.text()));
+        store_.params.push_back(p);
+    }
+    out.count = static_cast<std::uint32_t>(normalizeParams(store_.params.data() + out.begin, out.count));
+    store_.params.resize(out.begin + out.count);
+    storeLive_ += footprint(out);
+    return out;
+}
+
+std::size_t IncrementalValidator::footprint(ParamRange r) const {
+    std::size_t n = r.count;
+    const ParamSlot* p = store_.slots(r);
+    for (std::uint32_t i = 0; i < r.count; ++i) n += p[i].type == ParamType::STRING;
+    return n;
+}
+
+// Copies what is still live into a fresh arena once garbage outweighs it.
+// Only called between edits, when no view into the old arena is held.
+void IncrementalValidator::compactStore() {
+    std::size_t used = store_.params.size() + store_.strings.size();
+    if (used < COMPACT_MIN || used <= 2 * storeLive_) return;
+
+    DiagramIR old = std::move(store_);
+    store_ = DiagramIR{};
+    storeLive_ = 0;
+    for (auto& n : nodes_)
+        if (n.alive) n.component = keep(old, n.component);
+    for (auto& cs : conns_)
+        if (cs.alive) cs.conn = keep(old, cs.conn);
+}
+
+// ============================================================
+// Edits
+// ============================================================
+
+void IncrementalValidator::addComponent(const Component& c) {
+    const std::string key(c.id);
+    NodeId x = allocNode();
+    SccId s = allocScc();
+    {
+        Node& n = nodes_[x];
+        n.id = key;
+        n.component = c;
+        n.alive = true;
+        n.scc = s;
+    }
+    sccs_[s].members = {x};
+
+    nodeOf_.emplace(key, x);
+    ++typeCounts_[static_cast<std::size_t>(c.type)];
+    summaryDirty_ = true;
+    changed_ = true;
+    markNode(x);
+    entrySync_.push_back(x);
+
+    // Connections that were waiting for this component
+    auto ep = connsByEndpoint_.find(key);
+    if (ep == connsByEndpoint_.end()) return;
+    for (std::uint32_t slot : ep->second) {
+        ConnSlot& cs = conns_[slot];
+        markConn(std::string(cs.conn.id));
+        if (cs.linked) continue;
+        auto f = nodeOf_.find(cs.conn.from);
+        auto t = nodeOf_.find(cs.conn.to);
+        if (f == nodeOf_.end() || t == nodeOf_.end()) continue;
+        linkEdge(f->second, t->second);
+        cs.linked = true;
+    }
+}
+
+void IncrementalValidator::updateComponent(NodeId x, const Component& c) {
+    Node& n = nodes_[x];
+    if (n.component.type != c.type) {
+        --typeCounts_[static_cast<std::size_t>(n.component.type)];
+        ++typeCounts_[static_cast<std::size_t>(c.type)];
+        summaryDirty_ = true;
+        entrySync_.push_back(x);
+    }
+    release(n.component);
+    n.component = c;
+    changed_ = true;
+
+    // Neighbours' findings depend on this component's type and config too
+    markNode(x);
+    for (auto& [y, _] : n.out) markNode(y);
+    for (auto& [y, _] : n.in)  markNode(y);
+}
+
+void IncrementalValidator::removeComponent(const std::string& id) {
+    auto it = nodeOf_.find(id);
+    if (it == nodeOf_.end()) return;
+    NodeId x = it->second;
+
+    auto ep = connsByEndpoint_.find(id);
+    if (ep != connsByEndpoint_.end()) {
+        for (std::uint32_t slot : ep->second) {
+            ConnSlot& cs = conns_[slot];
+            markConn(std::string(cs.conn.id));
+            if (!cs.linked) continue;
+            unlinkEdge(nodeOf_.find(cs.conn.from)->second, nodeOf_.find(cs.conn.to)->second);
+            cs.linked = false;
+        }
+    }
+
+    // Isolated now, so it is alone in its SCC
+    Node& n = nodes_[x];
+    for (auto& issue : n.issues) {
+        count(issue, -1);
+        delta_->removed.push_back(std::move(issue));
+    }
+    dropEntry(n);
+    --typeCounts_[static_cast<std::size_t>(n.component.type)];
+    freeScc(n.scc);
+    release(n.component);
+    n = Node{};
+    freeNodes_.push_back(x);
+    nodeOf_.erase(it);
+
+    summaryDirty_ = true;
+    changed_ = true;
+}
+
+void IncrementalValidator::addConnection(const Connection& c) {
+    std::uint32_t slot;
+    if (!freeConns_.empty()) { slot = freeConns_.back(); freeConns_.pop_back(); }
+    else { slot = static_cast<std::uint32_t>(conns_.size()); conns_.emplace_back(); }
+    conns_[slot] = ConnSlot{c, true, false};
+
+    const std::string id(c.id);
+    connsById_[id].push_back(slot);
+    connsByEndpoint_[std::string(c.from)].push_back(slot);
+    if (c.to != c.from)
+        connsByEndpoint_[std::string(c.to)].push_back(slot);
+    markConn(id);
+    changed_ = true;
+
+    auto f = nodeOf_.find(c.from);
+    auto t = nodeOf_.find(c.to);
+    if (f == nodeOf_.end() || t == nodeOf_.end()) return;
+    linkEdge(f->second, t->second);
+    conns_[slot].linked = true;
+}
+
+void IncrementalValidator::removeConnections(const std::string& id) {
+    auto it = connsById_.find(id);
+    if (it == connsById_.end()) return;
+
+    auto eraseEndpoint = [&](std::string_view endpoint, std::uint32_t slot) {
+        auto ep = connsByEndpoint_.find(std::string(endpoint));
+        if (ep == connsByEndpoint_.end()) return;
+        auto& slots = ep->second;
+        slots.erase(std::find(slots.begin(), slots.end(), slot));
+        if (slots.empty()) connsByEndpoint_.erase(ep);
+    };
+
+    for (std::uint32_t slot : it->second) {
+        ConnSlot& cs = conns_[slot];
+        if (cs.linked)
+            unlinkEdge(nodeOf_.find(cs.conn.from)->second, nodeOf_.find(cs.conn.to)->second);
+        eraseEndpoint(cs.conn.from, slot);
+        if (cs.conn.to != cs.conn.from)
+            eraseEndpoint(cs.conn.to, slot);
+        release(cs.conn);
+        cs = ConnSlot{};
+        freeConns_.push_back(slot);
+    }
+    connsById_.erase(it);
+    markConn(id);
+    changed_ = true;
+}
+
+// ============================================================
+// Graph maintenance
+// ============================================================
+
+int IncrementalValidator::sccHeight(SccId s) const {
+    int h = 0;
+    for (NodeId x : sccs_[s].members)
+        for (auto& [y, _] : nodes_[x].out) {
+            SccId t = nodes_[y].scc;
+            if (t != s) h = std::max(h, sccs_[t].height + 1);
+        }
+    return h;
+}
+
+// Only a lone component can lack incoming connections
+bool IncrementalValidator::isEntryScc(const Scc& s) const {
+    return s.members.size() == 1 && nodes_[s.members[0]].in.empty();
+}
+
+bool IncrementalValidator::isCyclic(const Scc& s) const {
+    if (!s.alive || s.members.empty()) return false;
+    if (s.members.size() > 1) return true;
+    NodeId x = s.members[0];
+    return nodes_[x].out.count(x) > 0;
+}
+
+void IncrementalValidator::linkEdge(NodeId u, NodeId v) {
+    if (nodes_[u].out[v]++ > 0) {          // parallel connection: nothing structural changes
+        ++nodes_[v].in[u];
+        return;
+    }
+    nodes_[v].in[u] = 1;
+
+    markNode(u);
+    markNode(v);
+    entrySync_.push_back(v);
+
+    SccId su = nodes_[u].scc, sv = nodes_[v].scc;
+    if (su == sv) {
+        // A self-loop makes a lone component cyclic and gives it an incoming
+        // edge; any other edge inside an SCC changes nothing
+        if (u == v) {
+            markScc(su);
+            refreshReach({su});
+        }
+        return;
+    }
+
+    // v can only reach u if it sits strictly higher in the condensation
+    std::vector<SccId> cycle;
+    if (sccs_[sv].height > sccs_[su].height && findCycleThrough(sv, su, cycle)) {
+        mergeSccs(cycle);
+        return;
+    }
+
+    if (sccs_[su].reachable) ++sccs_[sv].reachPreds;
+    refreshReach({sv});
+    updateHeights({su});
+}
+
+void IncrementalValidator::unlinkEdge(NodeId u, NodeId v) {
+    auto it = nodes_[u].out.find(v);
+    if (--it->second > 0) {
+        --nodes_[v].in[u];
+        return;
+    }
+    nodes_[u].out.erase(it);
+    nodes_[v].in.erase(u);
+
+    markNode(u);
+    markNode(v);
+    entrySync_.push_back(v);
+
+    SccId su = nodes_[u].scc, sv = nodes_[v].scc;
+    if (u == v) {
+        markScc(su);
+        refreshReach({su});
+        return;
+    }
+    if (su != sv) {
+        if (sccs_[su].reachable) --sccs_[sv].reachPreds;
+        refreshReach({sv});
+        updateHeights({su});
+        return;
+    }
+    splitScc(su);
+}
+
+// Does `from` reach `to`? If so, collects every SCC on a from -> to path
+// (both ends included): adding the edge to -> from fuses them into one SCC.
+// The forward search skips SCCs no higher than `to`, which cannot reach it.
+bool IncrementalValidator::findCycleThrough(SccId from, SccId to, std::vector<SccId>& onCycle) {
+    const int floor = sccs_[to].height;
+
+    std::unordered_set<SccId> seen{from};
+    std::vector<SccId> stack{from};
+    bool found = false;
+    while (!stack.empty()) {
+        SccId s = stack.back();
+        stack.pop_back();
+        for (NodeId x : sccs_[s].members)
+            for (auto& [y, _] : nodes_[x].out) {
+                SccId t = nodes_[y].scc;
+                if (t == s || seen.count(t)) continue;
+                if (t == to) {
+                    found = true;
+                    seen.insert(t);
+                    continue;
+                }
+                if (sccs_[t].height <= floor) continue;
+                seen.insert(t);
+                stack.push_back(t);
+            }
+    }
+    if (!found) return false;
+
+    // Backwards from `to` within what the forward search saw
+    std::unordered_set<SccId> inCycle{to};
+    onCycle = {to};
+    stack = {to};
+    while (!stack.empty()) {
+        SccId s = stack.back();
+        stack.pop_back();
+        for (NodeId x : sccs_[s].members)
+            for (auto& [y, _] : nodes_[x].in) {
+                SccId t = nodes_[y].scc;
+                if (t == s || !seen.count(t) || !inCycle.insert(t).second) continue;
+                onCycle.push_back(t);
+                stack.push_back(t);
+            }
+    }
+    return true;
+}
+
+void IncrementalValidator::mergeSccs(const std::vector<SccId>& group) {
+    const SccId m = group.front();
+
+    std::vector<std::pair<NodeId, bool>> wasReachable;
+    for (SccId s : group)
+        for (NodeId x : sccs_[s].members) wasReachable.push_back({x, sccs_[s].reachable});
+
+    for (std::size_t i = 1; i < group.size(); ++i) {
+        for (NodeId x : sccs_[group[i]].members) {
+            nodes_[x].scc = m;
+            sccs_[m].members.push_back(x);
+        }
+        freeScc(group[i]);
+    }
+    markScc(m);
+
+    // Every member has an incoming edge now, so only edges from outside count
+    Scc& M = sccs_[m];
+    M.height = sccHeight(m);
+    M.reachPreds = 0;
+    std::vector<SccId> preds;
+    for (NodeId x : M.members)
+        for (auto& [y, _] : nodes_[x].in) {
+            SccId t = nodes_[y].scc;
+            if (t == m) continue;
+            preds.push_back(t);
+            if (sccs_[t].reachable) ++M.reachPreds;
+        }
+    M.reachable = M.reachPreds > 0;
+
+    std::vector<SccId> succs;
+    for (auto& [x, was] : wasReachable) {
+        if (was == M.reachable) continue;
+        markNode(x);
+        for (auto& [y, _] : nodes_[x].out) {
+            SccId t = nodes_[y].scc;
+            if (t == m) continue;
+            if (M.reachable) ++sccs_[t].reachPreds;
+            else             --sccs_[t].reachPreds;
+            succs.push_back(t);
+        }
+    }
+
+    refreshReach(std::move(succs));
+    updateHeights(std::move(preds));
+}
+
+void IncrementalValidator::splitScc(SccId s) {
+    std::vector<std::vector<NodeId>> parts;
+    tarjan(sccs_[s].members,
+           [&](NodeId y) { return nodes_[y].scc == s; },
+           [&](std::vector<NodeId>&& part) { parts.push_back(std::move(part)); });
+    if (parts.size() == 1) return;
+
+    const bool wasReachable = sccs_[s].reachable;
+    markScc(s);
+
+    // Parts come out sinks first; the first keeps the old id
+    std::vector<SccId> ids(parts.size());
+    std::unordered_set<SccId> isPart;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        SccId t = i == 0 ? s : allocScc();
+        ids[i] = t;
+        isPart.insert(t);
+        for (NodeId x : parts[i]) nodes_[x].scc = t;
+        sccs_[t].members = std::move(parts[i]);
+        if (isCyclic(sccs_[t])) markScc(t);
+    }
+
+    // Heights sinks first, reachability sources first
+    for (SccId t : ids) {
+        sccs_[t].height = sccHeight(t);
+        if (sccs_[t].members.size() == 1) entrySync_.push_back(sccs_[t].members[0]);
+    }
+
+    std::vector<SccId> preds, succs;
+    for (auto it = ids.rbegin(); it != ids.rend(); ++it) {
+        Scc& T = sccs_[*it];
+        T.reachPreds = 0;
+        for (NodeId x : T.members)
+            for (auto& [y, _] : nodes_[x].in) {
+                SccId p = nodes_[y].scc;
+                if (p == *it) continue;
+                if (!isPart.count(p)) preds.push_back(p);
+                if (sccs_[p].reachable) ++T.reachPreds;
+            }
+        T.reachable = isEntryScc(T) || T.reachPreds > 0;
+        if (T.reachable == wasReachable) continue;
+
+        for (NodeId x : T.members) {
+            markNode(x);
+            for (auto& [y, _] : nodes_[x].out) {
+                SccId q = nodes_[y].scc;
+                if (isPart.count(q)) continue;
+                if (T.reachable) ++sccs_[q].reachPreds;
+                else             --sccs_[q].reachPreds;
+                succs.push_back(q);
+            }
+        }
+    }
+
+    refreshReach(std::move(succs));
+    updateHeights(std::move(preds));
+}
+
+// Recomputes heights from successors until nothing changes
+void IncrementalValidator::updateHeights(std::vector<SccId> work) {
+    for (std::size_t i = 0; i < work.size(); ++i) {
+        SccId s = work[i];
+        if (!sccs_[s].alive) continue;
+        int h = sccHeight(s);
+        if (h == sccs_[s].height) continue;
+        sccs_[s].height = h;
+
+        if (sccs_[s].members.size() == 1) entrySync_.push_back(sccs_[s].members[0]);
+        for (NodeId x : sccs_[s].members)
+            for (auto& [y, _] : nodes_[x].in) {
+                SccId t = nodes_[y].scc;
+                if (t != s) work.push_back(t);
+            }
+    }
+}
+
+// Re-derives `reachable` where reachPreds or entry status changed, pushing
+// every flip on to the successors' counts
+void IncrementalValidator::refreshReach(std::vector<SccId> work) {
+    for (std::size_t i = 0; i < work.size(); ++i) {
+        SccId s = work[i];
+        Scc& S = sccs_[s];
+        if (!S.alive) continue;
+        bool r = isEntryScc(S) || S.reachPreds > 0;
+        if (r == S.reachable) continue;
+        S.reachable = r;
+
+        for (NodeId x : S.members) {
+            markNode(x);
+            for (auto& [y, _] : nodes_[x].out) {
+                SccId t = nodes_[y].scc;
+                if (t == s) continue;
+                if (r) ++sccs_[t].reachPreds;
+                else   --sccs_[t].reachPreds;
+                work.push_back(t);
+            }
+        }
+    }
+}
+
+void IncrementalValidator::rebuildTopology() {
+    std::vector<NodeId> all;
+    all.reserve(nodeOf_.size());
+    for (auto& [_, x] : nodeOf_) all.push_back(x);
+
+    std::vector<SccId> order;       // sinks first
+    tarjan(all,
+           [](NodeId) { return true; },
+           [&](std::vector<NodeId>&& part) {
+               SccId s = allocScc();
+               for (NodeId x : part) nodes_[x].scc = s;
+               sccs_[s].members = std::move(part);
+               order.push_back(s);
+           });
+
+    for (SccId s : order) sccs_[s].height = sccHeight(s);
+
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        Scc& S = sccs_[*it];
+        S.reachPreds = 0;
+        for (NodeId x : S.members)
+            for (auto& [y, _] : nodes_[x].in) {
+                SccId p = nodes_[y].scc;
+                if (p != *it && sccs_[p].reachable) ++S.reachPreds;
+            }
+        S.reachable = isEntryScc(S) || S.reachPreds > 0;
+    }
+}
+
+// Iterative Tarjan over the nodes accepted by `inSubset`, starting from
+// `roots`. SCCs are emitted in reverse topological order (sinks first).
+template <typename InSubset, typename Emit>
+void IncrementalValidator::tarjan(const std::vector<NodeId>& roots, InSubset inSubset, Emit emit) {
+    if (tIndex_.size() < nodes_.size()) {
+        tIndex_.resize(nodes_.size(), 0);
+        tLow_.resize(nodes_.size(), 0);
+        tOnStack_.resize(nodes_.size(), 0);
+    }
+
+    struct Frame {
+        NodeId node;
+        EdgeMap::const_iterator next;
+    };
+    std::vector<Frame>  frames;
+    std::vector<NodeId> stack, visited;
+    std::uint32_t counter = 0;
+
+    auto enter = [&](NodeId x) {
+        tIndex_[x] = tLow_[x] = ++counter;
+        tOnStack_[x] = 1;
+        stack.push_back(x);
+        visited.push_back(x);
+        frames.push_back({x, nodes_[x].out.begin()});
+    };
+
+    for (NodeId root : roots) {
+        if (tIndex_[root]) continue;
+        enter(root);
+
+        while (!frames.empty()) {
+            NodeId x = frames.back().node;
+            auto& next = frames.back().next;
+
+            if (next != nodes_[x].out.end()) {
+                NodeId y = next->first;
+                ++next;
+                if (!inSubset(y)) continue;
+                if (!tIndex_[y])         enter(y);
+                else if (tOnStack_[y])   tLow_[x] = std::min(tLow_[x], tIndex_[y]);
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                NodeId parent = frames.back().node;
+                tLow_[parent] = std::min(tLow_[parent], tLow_[x]);
+            }
+            if (tLow_[x] != tIndex_[x]) continue;
+
+            std::vector<NodeId> part;
+            NodeId y;
+            do {
+                y = stack.back();
+                stack.pop_back();
+                tOnStack_[y] = 0;
+                part.push_back(y);
+            } while (y != x);
+            emit(std::move(part));
+        }
+    }
+
+    for (NodeId x : visited) tIndex_[x] = tLow_[x] = 0;
+}
+
+IncrementalValidator::NodeId IncrementalValidator::allocNode() {
+    NodeId x;
+    if (!freeNodes_.empty()) { x = freeNodes_.back(); freeNodes_.pop_back(); }
+    else { x = static_cast<NodeId>(nodes_.size()); nodes_.emplace_back(); }
+    nodes_[x] = Node{};
+    return x;
+}
+
+IncrementalValidator::SccId IncrementalValidator::allocScc() {
+    SccId s;
+    if (!freeSccs_.empty()) { s = freeSccs_.back(); freeSccs_.pop_back(); }
+    else { s = static_cast<SccId>(sccs_.size()); sccs_.emplace_back(); }
+    sccs_[s] = Scc{};
+    sccs_[s].alive = true;
+    return s;
+}
+
+void IncrementalValidator::freeScc(SccId s) {
+    Scc& S = sccs_[s];
+    for (auto& issue : S.issues) {
+        count(issue, -1);
+        delta_->removed.push_back(std::move(issue));
+    }
+    S = Scc{};
+    freeSccs_.push_back(s);
+}
+
+// ============================================================
+// Issue buckets
+// ============================================================
+
+void IncrementalValidator::markNode(NodeId x) {
+    if (nodes_[x].dirty) return;
+    nodes_[x].dirty = true;
+    dirtyNodes_.push_back(x);
+}
+
+void IncrementalValidator::markScc(SccId s) {
+    if (sccs_[s].dirty) return;
+    sccs_[s].dirty = true;
+    dirtySccs_.push_back(s);
+}
+
+void IncrementalValidator::syncEntry(NodeId x) {
+    Node& n = nodes_[x];
+    if (!n.alive) return;
+
+    const bool entry = n.in.empty();
+    const bool ingress = entry && n.component.type != ComponentType::DATABASE;
+    const int h = sccs_[n.scc].height;
+
+    if (n.inEntries && (!entry || n.entryHeight != h)) {
+        entryDepths_.erase({-n.entryHeight, n.id});
+        n.inEntries = false;
+    }
+    if (entry && !n.inEntries) {
+        entryDepths_.insert({-h, n.id});
+        n.inEntries = true;
+        n.entryHeight = h;
+    }
+    if (ingress != n.inIngress) {
+        if (ingress) ingress_.insert(n.id);
+        else         ingress_.erase(n.id);
+        n.inIngress = ingress;
+        summaryDirty_ = true;
+    }
+}
+
+void IncrementalValidator::dropEntry(Node& n) {
+    if (n.inEntries) entryDepths_.erase({-n.entryHeight, n.id});
+    if (n.inIngress) ingress_.erase(n.id);
+    n.inEntries = n.inIngress = false;
+    summaryDirty_ = true;
+}
+
+void IncrementalValidator::count(const ValidationIssue& issue, int sign) {
+    if (issue.severity == Severity::ERROR)        errors_ += sign;
+    else if (issue.severity == Severity::WARNING) warnings_ += sign;
+}
+
+// Reports only what actually changed between the old and new bucket contents
+void IncrementalValidator::replaceBucket(std::vector<ValidationIssue>& bucket,
+                                         std::vector<ValidationIssue> fresh)
+{
+    std::vector<char> kept(bucket.size(), 0);
+    for (auto& f : fresh) {
+        bool matched = false;
+        for (std::size_t i = 0; i < bucket.size(); ++i)
+            if (!kept[i] && sameIssue(bucket[i], f)) { kept[i] = 1; matched = true; break; }
+        if (!matched) {
+            count(f, +1);
+            delta_->added.push_back(f);
+        }
+    }
+    for (std::size_t i = 0; i < bucket.size(); ++i)
+        if (!kept[i]) {
+            count(bucket[i], -1);
+            delta_->removed.push_back(std::move(bucket[i]));
+        }
+    bucket = std::move(fresh);
+}
+
+ComponentView IncrementalValidator::viewOf(const Node& n) const {
+    auto neighbours = [&](const EdgeMap& edges) {
+        std::vector<NodeId> ids;
+        ids.reserve(edges.size());
+        for (auto& [y, _] : edges) ids.push_back(y);
+        std::sort(ids.begin(), ids.end(), [&](NodeId a, NodeId b) { return nodes_[a].id < nodes_[b].id; });
+        std::vector<const Component*> r;
+        r.reserve(ids.size());
+        for (NodeId y : ids) r.push_back(&nodes_[y].component);
+        return r;
+    };
+    return ComponentView{n.component.id, n.component, store_, neighbours(n.out), neighbours(n.in),
+                         sccs_[n.scc].reachable};
+}
+
+DiagramSummary IncrementalValidator::summary() const {
+    DiagramSummary s;
+    s.componentCount = nodeOf_.size();
+    s.typeCounts = typeCounts_;
+    s.ingress.assign(ingress_.begin(), ingress_.end());
+    if (!entryDepths_.empty()) {
+        s.maxDepth = -entryDepths_.begin()->first;
+        s.deepestEntry = entryDepths_.begin()->second;
+    }
+    return s;
+}
+
+void IncrementalValidator::flush() {
+    // Entry sets first: the summary reads them. Only the deepest entry matters
+    // to the summary, so other depth changes do not dirty it.
+    auto top = [&] { return entryDepths_.empty() ? std::pair<int, std::string>{1, ""} : *entryDepths_.begin(); };
+    auto before = top();
+    for (NodeId x : entrySync_) syncEntry(x);
+    entrySync_.clear();
+    if (top() != before) summaryDirty_ = true;
+
+    for (NodeId x : dirtyNodes_) {
+        Node& n = nodes_[x];
+        if (!n.dirty) continue;
+        n.dirty = false;
+        if (!n.alive) continue;
+
+        std::vector<ValidationIssue> fresh;
+        ComponentView view = viewOf(n);
+        for (auto* m : incremental_) m->checkComponent(view, fresh);
+        replaceBucket(n.issues, std::move(fresh));
+    }
+    dirtyNodes_.clear();
+
+    for (auto& id : dirtyConns_) {
+        std::vector<ValidationIssue> fresh;
+        auto it = connsById_.find(id);
+        if (it != connsById_.end()) {
+            bool first = true;
+            for (std::uint32_t slot : it->second) {
+                const Connection& c = conns_[slot].conn;
+                ConnectionView view{c,
+                                    nodeOf_.find(c.from) != nodeOf_.end(),
+                                    nodeOf_.find(c.to) != nodeOf_.end(),
+                                    !first && !id.empty()};
+                first = false;
+                for (auto* m : incremental_) m->checkConnection(view, fresh);
+            }
+        }
+        auto& bucket = connIssues_[id];
+        replaceBucket(bucket, std::move(fresh));
+        if (bucket.empty()) connIssues_.erase(id);
+    }
+    dirtyConns_.clear();
+
+    for (SccId s : dirtySccs_) {
+        Scc& S = sccs_[s];
+        if (!S.dirty) continue;
+        S.dirty = false;
+        if (!S.alive) continue;
+
+        std::vector<ValidationIssue> fresh;
+        if (isCyclic(S)) {
+            std::vector<NodeId> ids = S.members;
+            std::sort(ids.begin(), ids.end(), [&](NodeId a, NodeId b) { return nodes_[a].id < nodes_[b].id; });
+            std::vector<const Component*> members;
+            members.reserve(ids.size());
+            for (NodeId x : ids) members.push_back(&nodes_[x].component);
+            for (auto* m : incremental_) m->checkCycle(members, fresh);
+        }
+        replaceBucket(S.issues, std::move(fresh));
+    }
+    dirtySccs_.clear();
+
+    if (summaryDirty_) {
+        std::vector<ValidationIssue> fresh;
+        DiagramSummary s = summary();
+        for (auto* m : incremental_) m->checkSummary(s, fresh);
+        replaceBucket(summaryIssues_, std::move(fresh));
+        summaryDirty_ = false;
+    }
+
+    if (changed_ && !fallback_.empty()) {
+        DiagramIR ir = diagram();
+        std::vector<ValidationIssue> fresh;
+        for (auto* m : fallback_)
+            for (auto& issue : m->validate(ir)) fresh.push_back(std::move(issue));
+        replaceBucket(fallbackIssues_, std::move(fresh));
+    }
+    changed_ = false;
+}
+
+// ============================================================
+// Snapshots
+// ============================================================
+
+ValidationResult IncrementalValidator::result() const {
+    std::vector<ValidationIssue> all;
+    auto append = [&](const std::vector<ValidationIssue>& bucket) {
+        all.insert(all.end(), bucket.begin(), bucket.end());
+    };
+
+    for (auto& [_, x] : nodeOf_) append(nodes_[x].issues);
+    for (auto& [_, bucket] : connIssues_) append(bucket);
+
+    std::vector<const Scc*> cyclic;
+    for (auto& s : sccs_)
+        if (s.alive && !s.issues.empty()) cyclic.push_back(&s);
+    std::sort(cyclic.begin(), cyclic.end(), [](const Scc* a, const Scc* b) {
+        return a->issues.front().related_components < b->issues.front().related_components;
+    });
+    for (auto* s : cyclic) append(s->issues);
+
+    append(summaryIssues_);
+    append(fallbackIssues_);
+
+    auto rank = [&](const ValidationIssue& i) {
+        auto it = moduleRank_.find(i.source_module);
+        return it == moduleRank_.end() ? moduleRank_.size() : it->second;
+    };
+    std::stable_sort(all.begin(), all.end(),
+                     [&](const ValidationIssue& a, const ValidationIssue& b) { return rank(a) < rank(b); });
+
+    ValidationResult r;
+    for (auto& issue : all) r.add(std::move(issue), ValidationLimits::unlimited());
+    return r;
+}
+
+DiagramIR IncrementalValidator::diagram() const {
+    // Views into store_ stay valid only as long as this validator does, so the
+    // snapshot gets copies of its own
+    DiagramIR ir;
+    auto copy = [&](ParamRange r) {
+        ParamRange out{static_cast<std::uint32_t>(ir.params.size()), r.count};
+        for (std::uint32_t i = 0; i < r.count; ++i) {
+            ParamSlot p = store_.slots(r)[i];
+            p.key = ir.adoptParamKey(store_, p.key);
+            if (p.type == ParamType::STRING) p = ParamSlot::text(p.key, ir.store(p.text()));
+            ir.params.push_back(p);
+        }
+        out.count = static_cast<std::uint32_t>(normalizeParams(ir.params.data() + out.begin, out.count));
+        ir.params.resize(out.begin + out.count);
+        return out;
+    };
+
+    ir.components.reserve(nodeOf_.size());
+    for (auto& [_, x] : nodeOf_) {
+        const Component& c = nodes_[x].component;
+        Component k;
+        k.id = ir.store(c.id);
+        k.category = ir.store(c.category);
+        k.implementation = ir.store(c.implementation);
+        k.user_params = copy(c.user_params);
+        ir.components.push_back(k);
+    }
+    for (auto& cs : conns_) {
+        if (!cs.alive) continue;
+        Connection k;
+        k.id = ir.store(cs.conn.id);
+        k.from = ir.store(cs.conn.from);
+        k.to = ir.store(cs.conn.to);
+        k.type = ir.store(cs.conn.type);
+        k.user_params = copy(cs.conn.user_params);
+        ir.links.push_back(k);
+    }
+
+    // indexIR derives types from the categories; keep the ones we were given
+    indexIR(ir);
+    std::size_t i = 0;
+    for (auto& [_, x] : nodeOf_) ir.components[i++].type = nodes_[x].component.type;
+    return ir;
+}
+
+} // namespace simrun
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "validator.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace simrun {
+
+// ---- Edits ----
+
+// `upsert` is read for its tables only: component types must be set (indexIR
+// sets them from the categories), endpoint indices are ignored. Its
+// components are new or replace the component with the same id; its links
+// are new or replace every connection with the same id.
+struct DiagramDelta {
+    DiagramIR                upsert;
+    std::vector<std::string> removeComponents;
+    std::vector<std::string> removeConnections;     // every connection with the id
+};
+
+struct ValidationDelta {
+    std::vector<ValidationIssue> added;
+    std::vector<ValidationIssue> removed;
+    std::size_t errorCount   = 0;                   // totals after the edit
+    std::size_t warningCount = 0;
+    bool canProceed = true;
+};
+
+// ---- IncrementalValidator ----
+//
+// Holds a diagram together with the indices the modules' incremental hooks
+// need, and keeps both up to date edit by edit:
+//
+//   * adjacency with parallel-connection counts, hence in/out degrees
+//   * strongly connected components: an added edge only searches SCCs whose
+//     longest-chain height lies between its endpoints', a removed edge only
+//     re-runs Tarjan inside the SCC it belonged to
+//   * each SCC's longest chain in the condensation, re-propagated only while
+//     it changes
+//   * reachability from components with no incoming connection, as a count
+//     of edges from reachable SCCs, flipped only where it changes
+//
+// Components and connections are copied into an arena of the validator's own
+// (an IR, so modules read them exactly as in a batch run) that is compacted
+// once edits have left more garbage in it than live data.
+//
+// Issues are kept in buckets (per component, per connection ID, per cyclic
+// SCC, diagram summary) and a bucket is recomputed only when its inputs
+// change, so apply() costs roughly the size of the edit plus the region whose
+// SCCs, depth or reachability it actually changed. Cycles are reported once
+// per SCC. Modules without incremental hooks are re-run over the whole
+// diagram on every edit.
+//
+// The Validator's modules are borrowed and must outlive this object.
+
+class IncrementalValidator {
+public:
+    explicit IncrementalValidator(const Validator& validator);
+
+    // `ir` must be indexed, as for Validator::validate
+    ValidationDelta reset(const DiagramIR& ir);
+    ValidationDelta apply(const DiagramDelta& delta);
+
+    // Current issue set, ordered by module like Validator::validate. Not capped:
+    // deltas are only meaningful against the full set.
+    ValidationResult result() const;
+    DiagramIR diagram() const;      // indexed, components in id order
+
+private:
+    using NodeId = std::uint32_t;
+    using SccId  = std::uint32_t;
+    using EdgeMap = std::unordered_map<NodeId, std::uint32_t>;     // neighbour -> parallel connections
+
+    struct Node {
+        std::string id;
+        Component   component;      // in store_
+        bool        alive = false;
+        EdgeMap     out, in;
+        SccId       scc = 0;
+
+        std::vector<ValidationIssue> issues;
+        bool dirty = false;
+
+        // Membership in ingress_ / entryDepths_
+        bool inIngress = false;
+        bool inEntries = false;
+        int  entryHeight = 0;
+    };
+
+    struct Scc {
+        std::vector<NodeId> members;
+        bool          alive = false;
+        int           height = 0;           // longest chain of SCC edges below this one
+        std::uint32_t reachPreds = 0;       // edges in from reachable SCCs
+        bool          reachable = true;
+
+        std::vector<ValidationIssue> issues;
+        bool dirty = false;
+    };
+
+    struct ConnSlot {
+        Connection conn;                    // in store_
+        bool alive  = false;
+        bool linked = false;                // counted in the adjacency
+    };
+
+    std::vector<const IValidatorModule*> incremental_, fallback_;
+    std::unordered_map<std::string, std::size_t> moduleRank_;
+
+    DiagramIR   store_;
+    std::size_t storeLive_ = 0;             // slots and strings still referenced
+
+    std::vector<Node>  nodes_;
+    std::vector<NodeId> freeNodes_;
+    std::map<std::string, NodeId, std::less<>> nodeOf_;
+
+    std::vector<Scc>   sccs_;
+    std::vector<SccId> freeSccs_;
+
+    std::vector<ConnSlot> conns_;
+    std::vector<std::uint32_t> freeConns_;
+    std::unordered_map<std::string, std::vector<std::uint32_t>> connsById_;         // insertion order
+    std::unordered_map<std::string, std::vector<std::uint32_t>> connsByEndpoint_;   // also dangling ones
+    std::map<std::string, std::vector<ValidationIssue>> connIssues_;
+
+    std::array<std::size_t, 5> typeCounts_{};
+    std::set<std::string> ingress_;                         // non-DATABASE, no incoming connection
+    std::set<std::pair<int, std::string>> entryDepths_;     // (-height, id), no incoming connection
+    std::vector<ValidationIssue> summaryIssues_;
+    std::vector<ValidationIssue> fallbackIssues_;
+
+    std::size_t errors_ = 0;
+    std::size_t warnings_ = 0;
+
+    // ---- per-apply() work lists ----
+    ValidationDelta* delta_ = nullptr;
+    std::vector<NodeId> dirtyNodes_;
+    std::vector<SccId>  dirtySccs_;
+    std::unordered_set<std::string> dirtyConns_;
+    std::vector<NodeId> entrySync_;
+    bool summaryDirty_ = false;
+    bool changed_ = false;
+
+    // ---- Tarjan scratch, indexed by NodeId ----
+    std::vector<std::uint32_t> tIndex_, tLow_;
+    std::vector<char> tOnStack_;
+
+    // ---- arena ----
+    Component  keep(const DiagramIR& from, const Component& c);
+    Connection keep(const DiagramIR& from, const Connection& c);
+    ParamRange keepParams(const DiagramIR& from, ParamRange r);
+    std::size_t footprint(ParamRange r) const;
+    void release(const Component& c)  { storeLive_ -= 3 + footprint(c.user_params); }
+    void release(const Connection& c) { storeLive_ -= 4 + footprint(c.user_params); }
+    void compactStore();
+
+    // ---- edits (arguments already kept in store_) ----
+    void addComponent(const Component& c);
+    void updateComponent(NodeId x, const Component& c);
+    void removeComponent(const std::string& id);
+    void addConnection(const Connection& c);
+    void removeConnections(const std::string& id);
+
+    // ---- graph maintenance ----
+    void linkEdge(NodeId u, NodeId v);
+    void unlinkEdge(NodeId u, NodeId v);
+    bool findCycleThrough(SccId from, SccId to, std::vector<SccId>& onCycle);
+    void mergeSccs(const std::vector<SccId>& group);
+    void splitScc(SccId s);
+    void updateHeights(std::vector<SccId> work);
+    void refreshReach(std::vector<SccId> work);
+    void rebuildTopology();
+
+    template <typename InSubset, typename Emit>
+    void tarjan(const std::vector<NodeId>& roots, InSubset inSubset, Emit emit);
+
+    int  sccHeight(SccId s) const;
+    bool isEntryScc(const Scc& s) const;
+    bool isCyclic(const Scc& s) const;
+
+    NodeId allocNode();
+    SccId  allocScc();
+    void   freeScc(SccId s);
+
+    // ---- issue buckets ----
+    void markNode(NodeId x);
+    void markScc(SccId s);
+    void markConn(const std::string& id) { dirtyConns_.insert(id); }
+    void syncEntry(NodeId x);
+    void dropEntry(Node& n);
+    void flush();
+    void replaceBucket(std::vector<ValidationIssue>& bucket, std::vector<ValidationIssue> fresh);
+    void count(const ValidationIssue& issue, int sign);
+    ComponentView viewOf(const Node& n) const;
+    DiagramSummary summary() const;
+};
+
+} // namespace simrun
@@ -0,0 +1,80 @@
+#include "ir.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+ComponentType componentTypeOf(string_view category) {
+    if (category == "api" || category == "service")              return ComponentType::SERVICE;
+    if (category == "cache")                                      return ComponentType::CACHE;
+    if (category == "database")                                   return ComponentType::DATABASE;
+    if (category == "load_balancer" || category == "loadbalancer") return ComponentType::LOAD_BALANCER;
+    return ComponentType::UNKNOWN;
+}
+
+ParamKey IR::paramKey(string_view name) {
+    ParamKey key;
+    if (ParamRegistry::find(name, key)) return key;
+    auto it = local_param_index.find(name);
+    if (it != local_param_index.end()) return it->second;
+
+    if (local_params.size() >= size_t(UINT16_MAX) + 1 - LOCAL_PARAM_KEY)
+        throw runtime_error("Too many distinct parameter names (limit " +
+                            to_string(size_t(UINT16_MAX) + 1 - LOCAL_PARAM_KEY) + ")");
+    key = static_cast<ParamKey>(LOCAL_PARAM_KEY + local_params.size());
+    local_params.push_back(name);
+    local_param_index.emplace(name, key);
+    return key;
+}
+
+string_view IR::paramName(ParamKey key) const {
+    if (key < LOCAL_PARAM_KEY) return ParamRegistry::name(key);
+    size_t i = key - LOCAL_PARAM_KEY;
+    return i < local_params.size() ? local_params[i] : string_view();
+}
+
+ParamKey IR::adoptParamKey(const IR& from, ParamKey key) {
+    if (key < LOCAL_PARAM_KEY) return key;
+    string_view name = from.paramName(key);
+    ParamKey known;
+    if (ParamRegistry::find(name, known)) return known;
+    auto it = local_param_index.find(name);
+    if (it != local_param_index.end()) return it->second;
+    return paramKey(store(name));
+}
+
+void orderByName(const IR& ir, const ParamSlot* slots, size_t count, vector<uint32_t>& order) {
+    order.resize(count);
+    for (size_t i = 0; i < count; ++i) order[i] = static_cast<uint32_t>(i);
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return ir.paramName(slots[a].key) < ir.paramName(slots[b].key);
+    });
+}
+
+uint32_t IR::find(string_view id) const {
+    auto it = lower_bound(by_id.begin(), by_id.end(), id,
+                          [&](uint32_t c, string_view key) { return components[c].id < key; });
+    return it != by_id.end() && components[*it].id == id ? *it : NO_COMPONENT;
+}
+
+void indexIR(IR& ir) {
+    const size_t n = ir.components.size();
+    ir.by_id.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        ir.by_id[i] = static_cast<uint32_t>(i);
+        ir.components[i].type = componentTypeOf(ir.components[i].category);
+    }
+    sort(ir.by_id.begin(), ir.by_id.end(),
+         [&](uint32_t a, uint32_t b) { return ir.components[a].id < ir.components[b].id; });
+
+    for (size_t k = 1; k < n; ++k) {
+        const auto& id = ir.components[ir.by_id[k]].id;
+        if (id == ir.components[ir.by_id[k - 1]].id)
+            throw runtime_error("Duplicate component id \"" + string(id) + "\"");
+    }
+
+    for (auto& l : ir.links) {
+        l.from_index = ir.find(l.from);
+        l.to_index = ir.find(l.to);
+    }
+}
@@ -1,31 +1,152 @@
 #pragma once
+#include "params.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <deque>
 #include <map>
-#include <variant>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
 
-using Value = variant<int, double, string, bool>;
+/*
+ * The one model every compile stage works on: the parser fills the flat
+ * tables, indexIR() derives the lookup fields, the validator reads them in
+ * place, the resolver adds resolved params and the writers encode the lot.
+ * No stage copies it into a model of its own.
+ *
+ * string_view fields point into the raw input the IR was parsed from
+ * (or into IR::strings when the parser had to decode escapes), so an IR
+ * must not outlive the buffer passed to parseIR. Resolved STRING params may
+ * also point into the ProfileCatalog they were resolved against.
+ */
+
+enum class ComponentType { SERVICE, CACHE, DATABASE, LOAD_BALANCER, UNKNOWN };
+
+inline string componentTypeStr(ComponentType t) {
+    switch (t) {
+        case ComponentType::SERVICE:       return "SERVICE";
+        case ComponentType::CACHE:         return "CACHE";
+        case ComponentType::DATABASE:      return "DATABASE";
+        case ComponentType::LOAD_BALANCER: return "LOAD_BALANCER";
+        default:                           return "UNKNOWN";
+    }
+}
+
+// Maps the export's component category ("api", "database", ...) to its type
+ComponentType componentTypeOf(string_view category);
+
+constexpr uint32_t NO_COMPONENT = UINT32_MAX;
 
 struct ComponentIR {
-    string id;
-    string category;
-    string implementation;
+    string_view id;
+    string_view category;
+    string_view implementation;
 
-    map<string, Value> user_params;
-    map<string, Value> resolved_params;
+    ParamRange user_params;         // in IR::params
+    ParamRange resolved_params;
+
+    ComponentType type = ComponentType::UNKNOWN;    // from category, set by indexIR
 };
 
 struct NetworkLinkIR {
-    string from;
-    string to;
-    string type;
+    string_view id;
+    string_view from;
+    string_view to;
+    string_view type;
+
+    ParamRange user_params;         // in IR::params
+    ParamRange resolved_params;
 
-    map<string, Value> resolved_params;
+    // Endpoints in IR::components, set by indexIR; NO_COMPONENT when the id is unknown
+    uint32_t from_index = NO_COMPONENT;
+    uint32_t to_index = NO_COMPONENT;
+};
+
+struct RouteIR {
+    string_view id;
+    string_view name;
+    string_view entry;
+    vector<string_view> path;
+    double weight = 0.0;
+};
+
+struct WorkloadSpikeIR {
+    string_view id;
+    double time_ms = 0.0;
+    double rps = 0.0;
+    double duration_ms = 0.0;
+};
+
+struct WorkloadIR {
+    string_view type;
+    double base_rps = 0.0;
+    double duration_ms = 0.0;
+    string_view distribution;
+    map<string, double> distribution_params;
+    vector<WorkloadSpikeIR> spikes;
+};
+
+struct FaultIR {
+    string_view id;
+    string_view target;
+    string_view target_type;
+    string_view fault_type;
+    string_view mode;
+    optional<double> probability;
+    optional<double> scheduled_time_ms;
+    optional<double> duration_ms;
 };
 
 struct IR {
     vector<ComponentIR> components;
     vector<NetworkLinkIR> links;
+    vector<RouteIR> routes;
+    WorkloadIR workload;
+    vector<FaultIR> faults;
+
+    // Every component's and link's parameter slots, addressed by ParamRange
+    vector<ParamSlot> params;
+
+    // Backing storage for strings that could not be viewed in place
+    deque<string> strings;
+
+    // Component indices in id order, set by indexIR
+    vector<uint32_t> by_id;
+
+    // Names behind this IR's local parameter keys: LOCAL_PARAM_KEY + i is local_params[i]
+    vector<string_view> local_params;
+    unordered_map<string_view, ParamKey> local_param_index;
+
+    const ParamSlot* slots(ParamRange r) const { return params.data() + r.begin; }
+    const ParamSlot* param(ParamRange r, ParamKey key) const { return findParam(slots(r), r.count, key); }
+
+    // Index of the component with this id, or NO_COMPONENT; needs indexIR
+    uint32_t find(string_view id) const;
+
+    // Copies `s` into `strings`, for IRs assembled in code rather than parsed
+    string_view store(string_view s) { return strings.emplace_back(s); }
+
+    // The registry's key for `name`, else a key local to this IR; `name` must
+    // live as long as the IR. Throws runtime_error past the local key space.
+    ParamKey paramKey(string_view name);
+    string_view paramName(ParamKey key) const;
+
+    // The key in this IR of a slot copied from `from`. Local keys are renumbered,
+    // so a copied run has to be normalizeParams'd again.
+    ParamKey adoptParamKey(const IR& from, ParamKey key);
 };
+
+// Indices of a run ordered by parameter name, for output that must not depend
+// on the order in which names were interned
+void orderByName(const IR& ir, const ParamSlot* slots, size_t count, vector<uint32_t>& order);
+
+/*
+ * Derives by_id, the components' types and the links' endpoint indices from
+ * the tables, in place. parseIR calls it; code that builds or edits an IR by
+ * hand calls it again before handing the IR on. Throws runtime_error when two
+ * components share an id.
+ */
+void indexIR(IR& ir);
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+
+/*
+ * Binary IR: the compiler -> simulator handoff format.
+ *
+ * Every section is a fixed-layout table, 8-byte aligned, addressed by an
+ * offset from the start of the image, so a reader can mmap the file and use
+ * the tables in place after checking the header. All integers are in host
+ * byte order; `byte_order` must read back as ENDIAN_TAG, which lets a reader
+ * reject an image written on a foreign-endian machine.
+ *
+ *   BinHeader
+ *   BinComponent[component_count]
+ *   BinLink[link_count]
+ *   BinParam[param_count]            (components' then links' slots, each run sorted by key name)
+ *   uint32_t[string_count + 1]       (string offsets into the data blob)
+ *   char[]                           (string data, every string NUL-terminated)
+ *
+ * This header is shared by the compiler (writer) and the simulator (reader),
+ * so it deliberately stays free of `using namespace`.
+ */
+
+namespace irbin {
+
+constexpr char     MAGIC[4]   = {'S', 'I', 'R', 'B'};
+constexpr uint16_t VERSION    = 1;
+constexpr uint32_t ENDIAN_TAG = 0x01020304;
+constexpr uint32_t NO_STRING  = 0xFFFFFFFF;
+
+struct BinHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t byte_order;
+
+    uint32_t component_count;
+    uint32_t link_count;
+    uint32_t param_count;
+    uint32_t string_count;
+
+    uint64_t components_offset;
+    uint64_t links_offset;
+    uint64_t params_offset;
+    uint64_t string_offsets_offset;
+    uint64_t string_data_offset;
+    uint64_t total_size;
+};
+
+struct BinComponent {
+    uint32_t id;                // string index
+    uint32_t category;          // string index
+    uint32_t implementation;    // string index
+    uint32_t param_begin;       // first slot in the param table
+    uint32_t param_count;
+    uint32_t reserved;
+};
+
+struct BinLink {
+    uint32_t id;
+    uint32_t from;
+    uint32_t to;
+    uint32_t type;
+    uint32_t param_begin;
+    uint32_t param_count;
+};
+
+enum BinParamType : uint8_t {
+    PARAM_INT    = 0,
+    PARAM_DOUBLE = 1,
+    PARAM_STRING = 2,
+    PARAM_BOOL   = 3
+};
+
+struct BinParam {
+    uint32_t key;               // string index
+    uint8_t  type;              // BinParamType
+    uint8_t  pad[3];
+    union {
+        int64_t  i;
+        double   d;
+        uint32_t s;             // string index
+        uint8_t  b;
+    } value;
+};
+
+static_assert(sizeof(BinHeader)    == 80, "BinHeader layout changed");
+static_assert(sizeof(BinComponent) == 24, "BinComponent layout changed");
+static_assert(sizeof(BinLink)      == 24, "BinLink layout changed");
+static_assert(sizeof(BinParam)     == 16, "BinParam layout changed");
+
+} // namespace irbin
@@ -0,0 +1,127 @@
+#include "ir_binary_writer.h"
+#include "ir_binary_format.h"
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+using namespace irbin;
+
+namespace {
+
+class StringTable {
+public:
+    uint32_t intern(string_view s) {
+        auto it = index.find(s);
+        if (it != index.end()) return it->second;
+
+        uint32_t id = static_cast<uint32_t>(offsets.size());
+        offsets.push_back(static_cast<uint32_t>(data.size()));
+        data.append(s.data(), s.size());
+        data.push_back('\0');
+        index.emplace(string_view(s), id);     // views the caller's storage, which outlives the table
+        return id;
+    }
+
+    vector<uint32_t> offsets;
+    string data;
+
+private:
+    unordered_map<string_view, uint32_t> index;
+};
+
+uint64_t align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+template <typename T>
+void put(string& out, uint64_t offset, const T* items, size_t count) {
+    if (count) memcpy(&out[offset], items, sizeof(T) * count);
+}
+
+void encodeParams(const IR& ir, ParamRange range, StringTable& strings,
+                  vector<uint32_t>& order, vector<BinParam>& out) {
+    const ParamSlot* slots = ir.slots(range);
+    orderByName(ir, slots, range.count, order);
+
+    for (uint32_t i : order) {
+        const ParamSlot& s = slots[i];
+        BinParam p{};
+        p.key = strings.intern(ir.paramName(s.key));
+        switch (s.type) {
+            case ParamType::INT:    p.type = PARAM_INT;    p.value.i = s.i; break;
+            case ParamType::DOUBLE: p.type = PARAM_DOUBLE; p.value.d = s.d; break;
+            case ParamType::BOOL:   p.type = PARAM_BOOL;   p.value.b = s.b; break;
+            case ParamType::STRING: p.type = PARAM_STRING; p.value.s = strings.intern(s.text()); break;
+        }
+        out.push_back(p);
+    }
+}
+
+}
+
+void serializeIRBinary(const IR& ir, string& out) {
+    StringTable strings;
+    vector<BinComponent> components;
+    vector<BinLink> links;
+    vector<BinParam> params;
+    vector<uint32_t> order;
+    vector<uint32_t> componentIds;      // string index of each component's id
+
+    components.reserve(ir.components.size());
+    componentIds.reserve(ir.components.size());
+    for (auto& c : ir.components) {
+        BinComponent bc{};
+        bc.id = strings.intern(c.id);
+        componentIds.push_back(bc.id);
+        bc.category = strings.intern(c.category);
+        bc.implementation = strings.intern(c.implementation);
+        bc.param_begin = static_cast<uint32_t>(params.size());
+        encodeParams(ir, c.resolved_params, strings, order, params);
+        bc.param_count = static_cast<uint32_t>(params.size()) - bc.param_begin;
+        components.push_back(bc);
+    }
+
+    links.reserve(ir.links.size());
+    for (auto& l : ir.links) {
+        BinLink bl{};
+        bl.id = strings.intern(l.id);
+        bl.from = l.from_index != NO_COMPONENT ? componentIds[l.from_index] : strings.intern(l.from);
+        bl.to = l.to_index != NO_COMPONENT ? componentIds[l.to_index] : strings.intern(l.to);
+        bl.type = strings.intern(l.type);
+        bl.param_begin = static_cast<uint32_t>(params.size());
+        encodeParams(ir, l.resolved_params, strings, order, params);
+        bl.param_count = static_cast<uint32_t>(params.size()) - bl.param_begin;
+        links.push_back(bl);
+    }
+
+    // Closing offset so string i spans [offsets[i], offsets[i + 1])
+    strings.offsets.push_back(static_cast<uint32_t>(strings.data.size()));
+
+    BinHeader h{};
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.byte_order = ENDIAN_TAG;
+    h.component_count = static_cast<uint32_t>(components.size());
+    h.link_count = static_cast<uint32_t>(links.size());
+    h.param_count = static_cast<uint32_t>(params.size());
+    h.string_count = static_cast<uint32_t>(strings.offsets.size() - 1);
+
+    h.components_offset     = align8(sizeof(BinHeader));
+    h.links_offset          = align8(h.components_offset + sizeof(BinComponent) * components.size());
+    h.params_offset         = align8(h.links_offset + sizeof(BinLink) * links.size());
+    h.string_offsets_offset = align8(h.params_offset + sizeof(BinParam) * params.size());
+    h.string_data_offset    = align8(h.string_offsets_offset + sizeof(uint32_t) * strings.offsets.size());
+    h.total_size            = align8(h.string_data_offset + strings.data.size());
+
+    out.assign(h.total_size, '\0');
+    put(out, 0, &h, 1);
+    put(out, h.components_offset, components.data(), components.size());
+    put(out, h.links_offset, links.data(), links.size());
+    put(out, h.params_offset, params.data(), params.size());
+    put(out, h.string_offsets_offset, strings.offsets.data(), strings.offsets.size());
+    put(out, h.string_data_offset, strings.data.data(), strings.data.size());
+}
+
+string serializeIRBinary(const IR& ir) {
+    string out;
+    serializeIRBinary(ir, out);
+    return out;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "ir.h"
+#include <string>
+
+using namespace std;
+
+// Encodes the resolved IR in the binary format of ir_binary_format.h.
+// The overload replaces the content of `out` and keeps its capacity.
+void serializeIRBinary(const IR& ir, string& out);
+
+string serializeIRBinary(const IR& ir);
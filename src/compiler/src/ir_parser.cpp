@@ -1,24 +1,176 @@
 #include "ir_parser.h"
+#include "json_reader.h"
+#include <cstdint>
+#include <vector>
 
 using namespace std;
 
-// TEMP: converts raw IR string into a fixed IR
-IR parseIR(const string& raw) {
-    IR ir;
+// Link profile used when the export does not name one
+static constexpr string_view DEFAULT_LINK_TYPE = "ethernet";
+
+static ParamSlot readParamValue(JsonReader& r, ParamKey key) {
+    if (r.peekString()) return ParamSlot::text(key, r.readString());
+    if (r.peekBool())   return ParamSlot::boolean(key, r.readBool());
+
+    bool integral = false;
+    double d = r.readNumber(&integral);
+    if (integral && d >= -0x1p63 && d < 0x1p63) return ParamSlot::integer(key, static_cast<int64_t>(d));
+    return ParamSlot::number(key, d);
+}
+
+// Names the schema or catalog define use their registry key; any other name
+// gets a key local to this IR, so request input never grows the registry
+static ParamRange readParams(JsonReader& r, IR& ir) {
+    vector<ParamSlot>& out = ir.params;
+    ParamRange range;
+    range.begin = static_cast<uint32_t>(out.size());
+
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if (r.peekNull()) { r.readNull(); continue; }   // e.g. bandwidth_limit: undefined -> null
+        out.push_back(readParamValue(r, ir.paramKey(key)));
+    }
+
+    range.count = static_cast<uint32_t>(normalizeParams(out.data() + range.begin, out.size() - range.begin));
+    out.resize(range.begin + range.count);
+    return range;
+}
+
+static optional<double> readOptionalNumber(JsonReader& r) {
+    if (r.peekNull()) { r.readNull(); return nullopt; }
+    return r.readNumber();
+}
 
-    ComponentIR redis;
-    redis.id = "cache1";
-    redis.category = "cache";
-    redis.implementation = "redis";
-    redis.user_params["memory_gb"] = 2;
+static void readComponent(JsonReader& r, IR& ir) {
+    ComponentIR c;
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if      (key == "id")         c.id = r.readString();
+        else if (key == "type")       c.category = r.readString();
+        else if (key == "profile")    c.implementation = r.readString();
+        else if (key == "parameters") c.user_params = readParams(r, ir);
+        else                          r.skipValue();   // position, label: UI-only
+    }
+    ir.components.push_back(move(c));
+}
+
+static void readLink(JsonReader& r, IR& ir) {
+    NetworkLinkIR l;
+    l.type = DEFAULT_LINK_TYPE;
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if      (key == "id")         l.id = r.readString();
+        else if (key == "source")     l.from = r.readString();
+        else if (key == "target")     l.to = r.readString();
+        else if (key == "profile")    l.type = r.readString();
+        else if (key == "parameters") l.user_params = readParams(r, ir);
+        else                          r.skipValue();
+    }
+    ir.links.push_back(move(l));
+}
 
-    NetworkLinkIR link;
-    link.from = "server1";
-    link.to = "cache1";
-    link.type = "ethernet";
+static void readRoute(JsonReader& r, IR& ir) {
+    RouteIR route;
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if      (key == "id")          route.id = r.readString();
+        else if (key == "name")        route.name = r.readString();
+        else if (key == "entryNodeId") route.entry = r.readString();
+        else if (key == "weight")      route.weight = r.readNumber();
+        else if (key == "path") {
+            r.beginArray();
+            while (r.nextElement()) route.path.push_back(r.readString());
+        }
+        else r.skipValue();
+    }
+    ir.routes.push_back(move(route));
+}
+
+static void readWorkload(JsonReader& r, WorkloadIR& w) {
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if      (key == "type")         w.type = r.readString();
+        else if (key == "base_rps")     w.base_rps = r.readNumber();
+        else if (key == "duration_ms")  w.duration_ms = r.readNumber();
+        else if (key == "distribution") w.distribution = r.readString();
+        else if (key == "distribution_params") {
+            r.beginObject();
+            string_view p;
+            while (r.nextMember(p)) {
+                if (r.peekNull()) { r.readNull(); continue; }
+                w.distribution_params[string(p)] = r.readNumber();
+            }
+        }
+        else if (key == "spikes") {
+            r.beginArray();
+            while (r.nextElement()) {
+                WorkloadSpikeIR s;
+                r.beginObject();
+                string_view sk;
+                while (r.nextMember(sk)) {
+                    if      (sk == "id")          s.id = r.readString();
+                    else if (sk == "time_ms")     s.time_ms = r.readNumber();
+                    else if (sk == "rps")         s.rps = r.readNumber();
+                    else if (sk == "duration_ms") s.duration_ms = r.readNumber();
+                    else                          r.skipValue();
+                }
+                w.spikes.push_back(s);
+            }
+        }
+        else r.skipValue();
+    }
+}
+
+static void readFault(JsonReader& r, IR& ir) {
+    FaultIR f;
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if      (key == "id")                f.id = r.readString();
+        else if (key == "targetId")          f.target = r.readString();
+        else if (key == "targetType")        f.target_type = r.readString();
+        else if (key == "faultType")         f.fault_type = r.readString();
+        else if (key == "mode")              f.mode = r.readString();
+        else if (key == "probability")       f.probability = readOptionalNumber(r);
+        else if (key == "scheduled_time_ms") f.scheduled_time_ms = readOptionalNumber(r);
+        else if (key == "duration_ms")       f.duration_ms = readOptionalNumber(r);
+        else                                 r.skipValue();
+    }
+    ir.faults.push_back(move(f));
+}
+
+IR parseIR(const string& raw) {
+    IR ir;
+    JsonReader r(raw, ir.strings);
 
-    ir.components.push_back(redis);
-    ir.links.push_back(link);
+    r.beginObject();
+    string_view key;
+    while (r.nextMember(key)) {
+        if (key == "components") {
+            r.beginArray();
+            while (r.nextElement()) readComponent(r, ir);
+        } else if (key == "links") {
+            r.beginArray();
+            while (r.nextElement()) readLink(r, ir);
+        } else if (key == "routes") {
+            r.beginArray();
+            while (r.nextElement()) readRoute(r, ir);
+        } else if (key == "workload") {
+            readWorkload(r, ir.workload);
+        } else if (key == "faults") {
+            r.beginArray();
+            while (r.nextElement()) readFault(r, ir);
+        } else {
+            r.skipValue();   // metadata and anything newer than this compiler
+        }
+    }
+    r.finish();
 
+    indexIR(ir);
     return ir;
 }
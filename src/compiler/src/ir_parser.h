@@ -4,4 +4,7 @@
 
 using namespace std;
 
+// Parses the UI's SimulationExport JSON into an indexed IR (indexIR). Throws
+// runtime_error on malformed input or repeated component ids. The returned
+// IR holds views into `raw`, which must outlive it.
 IR parseIR(const string& raw);
@@ -1,70 +1,135 @@
 #include "ir_serializer.h"
-#include <sstream>
+#include "json_writer.h"
 
 using namespace std;
 
-static string valueToString(const Value& v) {
-    if (holds_alternative<int>(v)) return to_string(get<int>(v));
-    if (holds_alternative<double>(v)) return to_string(get<double>(v));
-    if (holds_alternative<bool>(v)) return get<bool>(v) ? "true" : "false";
-    return "\"" + get<string>(v) + "\"";
+static void writeValue(JsonWriter& w, const ParamSlot& p) {
+    switch (p.type) {
+        case ParamType::INT:    w.integer(p.i); break;
+        case ParamType::DOUBLE: w.number(p.d); break;
+        case ParamType::BOOL:   w.boolean(p.b); break;
+        case ParamType::STRING: w.text(p.text()); break;
+    }
 }
 
-string serializeIR(const IR& ir) {
-    stringstream ss;
+// Keys are written in name order so the output is stable across processes
+static void writeParams(JsonWriter& w, const IR& ir, ParamRange range, vector<uint32_t>& order) {
+    const ParamSlot* slots = ir.slots(range);
+    orderByName(ir, slots, range.count, order);
 
-    ss << "{\n";
-    ss << "  \"components\": [\n";
+    w.key("resolved_params");
+    w.beginObject();
+    for (uint32_t i : order) {
+        w.key(ir.paramName(slots[i].key));
+        writeValue(w, slots[i]);
+    }
+    w.endObject();
+}
 
-    for (size_t i = 0; i < ir.components.size(); ++i) {
-        const auto& c = ir.components[i];
+static void writeOptional(JsonWriter& w, string_view key, const optional<double>& v) {
+    if (!v) return;
+    w.key(key);
+    w.number(*v);
+}
 
-        ss << "    {\n";
-        ss << "      \"id\": \"" << c.id << "\",\n";
-        ss << "      \"category\": \"" << c.category << "\",\n";
-        ss << "      \"implementation\": \"" << c.implementation << "\",\n";
-        ss << "      \"resolved_params\": {\n";
+void serializeIR(const IR& ir, string& out, bool compact) {
+    // Rough per-element size so large diagrams grow the buffer once or twice
+    out.reserve(out.size() + 256 * (ir.components.size() + ir.links.size()) + 512);
 
-        size_t cnt = 0;
-        for (auto& [k, v] : c.resolved_params) {
-            ss << "        \"" << k << "\": " << valueToString(v);
-            if (++cnt < c.resolved_params.size()) ss << ",";
-            ss << "\n";
-        }
+    JsonWriter w(out, compact);
+    vector<uint32_t> order;
+    w.beginObject();
 
-        ss << "      }\n";
-        ss << "    }";
-        if (i + 1 < ir.components.size()) ss << ",";
-        ss << "\n";
+    w.key("components");
+    w.beginArray();
+    for (auto& c : ir.components) {
+        w.beginObject();
+        w.key("id");             w.text(c.id);
+        w.key("category");       w.text(c.category);
+        w.key("implementation"); w.text(c.implementation);
+        writeParams(w, ir, c.resolved_params, order);
+        w.endObject();
     }
+    w.endArray();
 
-    ss << "  ],\n";
-    ss << "  \"links\": [\n";
-
-    for (size_t i = 0; i < ir.links.size(); ++i) {
-        const auto& l = ir.links[i];
+    w.key("links");
+    w.beginArray();
+    for (auto& l : ir.links) {
+        w.beginObject();
+        w.key("id");   w.text(l.id);
+        w.key("from"); w.text(l.from);
+        w.key("to");   w.text(l.to);
+        w.key("type"); w.text(l.type);
+        writeParams(w, ir, l.resolved_params, order);
+        w.endObject();
+    }
+    w.endArray();
 
-        ss << "    {\n";
-        ss << "      \"from\": \"" << l.from << "\",\n";
-        ss << "      \"to\": \"" << l.to << "\",\n";
-        ss << "      \"type\": \"" << l.type << "\",\n";
-        ss << "      \"resolved_params\": {\n";
+    w.key("routes");
+    w.beginArray();
+    for (auto& r : ir.routes) {
+        w.beginObject();
+        w.key("id");     w.text(r.id);
+        w.key("name");   w.text(r.name);
+        w.key("entry");  w.text(r.entry);
+        w.key("weight"); w.number(r.weight);
+        w.key("path");
+        w.beginArray();
+        for (auto& hop : r.path) w.text(hop);
+        w.endArray();
+        w.endObject();
+    }
+    w.endArray();
 
-        size_t cnt = 0;
-        for (auto& [k, v] : l.resolved_params) {
-            ss << "        \"" << k << "\": " << valueToString(v);
-            if (++cnt < l.resolved_params.size()) ss << ",";
-            ss << "\n";
-        }
+    const auto& wl = ir.workload;
+    w.key("workload");
+    w.beginObject();
+    w.key("type");         w.text(wl.type);
+    w.key("base_rps");     w.number(wl.base_rps);
+    w.key("duration_ms");  w.number(wl.duration_ms);
+    w.key("distribution"); w.text(wl.distribution);
+    w.key("distribution_params");
+    w.beginObject();
+    for (auto& [k, v] : wl.distribution_params) {
+        w.key(k);
+        w.number(v);
+    }
+    w.endObject();
+    w.key("spikes");
+    w.beginArray();
+    for (auto& s : wl.spikes) {
+        w.beginObject();
+        w.key("id");          w.text(s.id);
+        w.key("time_ms");     w.number(s.time_ms);
+        w.key("rps");         w.number(s.rps);
+        w.key("duration_ms"); w.number(s.duration_ms);
+        w.endObject();
+    }
+    w.endArray();
+    w.endObject();
 
-        ss << "      }\n";
-        ss << "    }";
-        if (i + 1 < ir.links.size()) ss << ",";
-        ss << "\n";
+    w.key("faults");
+    w.beginArray();
+    for (auto& f : ir.faults) {
+        w.beginObject();
+        w.key("id");          w.text(f.id);
+        w.key("target");      w.text(f.target);
+        w.key("target_type"); w.text(f.target_type);
+        w.key("fault_type");  w.text(f.fault_type);
+        w.key("mode");        w.text(f.mode);
+        writeOptional(w, "probability", f.probability);
+        writeOptional(w, "scheduled_time_ms", f.scheduled_time_ms);
+        writeOptional(w, "duration_ms", f.duration_ms);
+        w.endObject();
     }
+    w.endArray();
 
-    ss << "  ]\n";
-    ss << "}\n";
+    w.endObject();
+    if (!compact) out += '\n';
+}
 
-    return ss.str();
+string serializeIR(const IR& ir, bool compact) {
+    string out;
+    serializeIR(ir, out, compact);
+    return out;
 }
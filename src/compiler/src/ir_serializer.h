@@ -4,4 +4,8 @@
 
 using namespace std;
 
-string serializeIR(const IR& ir);
+// Appends the IR as JSON to `out`; pass the same buffer across calls to
+// reuse its capacity. `compact` drops all indentation and newlines.
+void serializeIR(const IR& ir, string& out, bool compact = false);
+
+string serializeIR(const IR& ir, bool compact = false);
@@ -0,0 +1,429 @@
+#include "job_manager.h"
+#include "json_writer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <random>
+
+using namespace std;
+
+const char* jobStateStr(JobState s) {
+    switch (s) {
+        case JobState::QUEUED:    return "queued";
+        case JobState::RUNNING:   return "running";
+        case JobState::SUCCEEDED: return "succeeded";
+        case JobState::FAILED:    return "failed";
+        case JobState::CANCELLED: return "cancelled";
+        case JobState::EXPIRED:   return "expired";
+    }
+    return "unknown";
+}
+
+void writeJobEvent(JsonWriter& w, const JobEvent& e) {
+    w.key("id");        w.text(e.jobId);
+    w.key("state");     w.text(jobStateStr(e.state));
+    w.key("stage");     w.text(e.stage);
+    w.key("progress");  w.number(e.progress);
+    if (!e.metrics.empty()) {
+        w.key("metrics");
+        w.beginObject();
+        for (const auto& [name, value] : e.metrics) {
+            w.key(name);
+            w.number(value);
+        }
+        w.endObject();
+    }
+    if (!e.error.empty()) {
+        w.key("error"); w.text(e.error);
+    }
+}
+
+// ---- JobContext ----
+
+static constexpr auto PROGRESS_INTERVAL = chrono::milliseconds(200);
+
+JobContext::JobContext(JobManager& manager, const string& jobId, const atomic<bool>& cancelFlag,
+                       chrono::steady_clock::time_point deadline)
+    : manager(manager), jobId(jobId), cancelFlag(cancelFlag), deadlineAt(deadline) {}
+
+bool JobContext::cancelled() const {
+    return cancelFlag.load(memory_order_relaxed) || chrono::steady_clock::now() >= deadlineAt;
+}
+
+void JobContext::progress(double fraction, vector<pair<string, double>> metrics) {
+    auto now = chrono::steady_clock::now();
+    if (fraction < 1.0 && now - lastEvent < PROGRESS_INTERVAL) return;
+    lastEvent = now;
+
+    JobEvent event;
+    event.state = JobState::RUNNING;
+    event.stage = "simulate";
+    event.progress = clamp(fraction, 0.0, 1.0);
+    event.metrics = move(metrics);
+    manager.publish(jobId, move(event));
+}
+
+// ---- JobManager ----
+
+JobManager::JobManager(ProfileRepository& profiles, CompileCache& cache, const Limits& limits)
+    : profiles(profiles), cache(cache), limits(limits) {
+    unsigned n = limits.workers ? limits.workers : max(1u, thread::hardware_concurrency());
+    counters.workers = n;
+    workers.reserve(n);
+    for (unsigned i = 0; i < n; ++i)
+        workers.emplace_back(&JobManager::workerLoop, this);
+}
+
+JobManager::~JobManager() {
+    deque<shared_ptr<Job>> unstarted;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        stopping = true;
+        for (auto& [id, job] : jobs) job->cancelRequested = true;
+        unstarted.swap(queue);
+    }
+    workAvailable.notify_all();
+
+    // No worker picks these up any more, so their final event comes from here;
+    // running jobs publish theirs at the next stage boundary
+    for (auto& job : unstarted) {
+        JobEvent event;
+        event.state = JobState::CANCELLED;
+        event.error = "cancelled at shutdown";
+        publish(*job, move(event), make_shared<JobResult>(JobResult{false, "cancelled", "text/plain"}));
+    }
+    for (thread& t : workers) t.join();
+}
+
+void JobManager::setSimulateStage(SimulateStage stage) {
+    simulate = move(stage);
+}
+
+JobManager::Limits JobManager::defaultLimits() {
+    Limits l;
+    if (const char* env = getenv("SIMRUN_JOB_WORKERS"))
+        l.workers = static_cast<unsigned>(strtoul(env, nullptr, 10));
+    if (const char* env = getenv("SIMRUN_JOB_QUEUE"))
+        l.maxQueued = static_cast<size_t>(strtoull(env, nullptr, 10));
+    return l;
+}
+
+// Ids are handed to any client that can reach the server, so they are not sequential
+string JobManager::newJobId() {
+    static mt19937_64 rng(random_device{}());
+    char buf[33];
+    snprintf(buf, sizeof buf, "%016llx%016llx",
+             static_cast<unsigned long long>(rng()), static_cast<unsigned long long>(rng()));
+    return buf;
+}
+
+JobManager::Admission JobManager::submit(Request request, string& jobId) {
+    if (request.input.size() > limits.maxInputBytes) {
+        lock_guard<mutex> lock(jobsMutex);
+        ++counters.rejected;
+        return Admission::TOO_LARGE;
+    }
+
+    auto job = make_shared<Job>();
+    job->input = move(request.input);
+    job->options = request.options;
+    job->submittedAt = chrono::steady_clock::now();
+    chrono::milliseconds deadline = request.deadline.count() > 0
+        ? min(request.deadline, limits.maxDeadline) : limits.defaultDeadline;
+    job->deadline = job->submittedAt + deadline;
+
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        if (stopping) return Admission::SHUTTING_DOWN;
+        if (queue.size() >= limits.maxQueued) {
+            ++counters.rejected;
+            return Admission::QUEUE_FULL;
+        }
+
+        do job->id = newJobId(); while (jobs.count(job->id));
+        job->last.jobId = job->id;
+        job->last.state = JobState::QUEUED;
+
+        jobs.emplace(job->id, job);
+        queue.push_back(job);
+        ++counters.submitted;
+        jobId = job->id;
+    }
+    workAvailable.notify_one();
+    return Admission::ACCEPTED;
+}
+
+bool JobManager::status(const string& jobId, JobStatus& out) const {
+    lock_guard<mutex> lock(jobsMutex);
+    auto it = jobs.find(jobId);
+    if (it == jobs.end()) return false;
+
+    const Job& job = *it->second;
+    auto now = chrono::steady_clock::now();
+    auto ms = [](chrono::steady_clock::duration d) { return chrono::duration_cast<chrono::milliseconds>(d); };
+    bool started = job.startedAt != chrono::steady_clock::time_point{};
+    bool finished = isFinal(job.last.state);
+
+    out.last = job.last;
+    out.queuedFor = ms((started ? job.startedAt : finished ? job.finishedAt : now) - job.submittedAt);
+    out.ranFor = started ? ms((finished ? job.finishedAt : now) - job.startedAt) : chrono::milliseconds(0);
+    out.deadlineIn = ms(job.deadline - now);
+    return true;
+}
+
+shared_ptr<const JobResult> JobManager::result(const string& jobId) const {
+    lock_guard<mutex> lock(jobsMutex);
+    auto it = jobs.find(jobId);
+    return it == jobs.end() ? nullptr : it->second->result;
+}
+
+bool JobManager::cancel(const string& jobId) {
+    shared_ptr<Job> job;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        auto it = jobs.find(jobId);
+        if (it == jobs.end() || isFinal(it->second->last.state)) return false;
+        job = it->second;
+        job->cancelRequested = true;
+
+        // A job a worker has picked up notices the flag itself; a queued one never starts
+        auto queued = find(queue.begin(), queue.end(), job);
+        if (queued == queue.end()) return true;
+        queue.erase(queued);
+    }
+
+    JobEvent event;
+    event.state = JobState::CANCELLED;
+    event.error = "cancelled before it started";
+    publish(*job, move(event), make_shared<JobResult>(JobResult{false, "cancelled", "text/plain"}));
+    return true;
+}
+
+uint64_t JobManager::subscribe(const string& jobId, function<void(const JobEvent&)> callback) {
+    auto sub = make_shared<Subscription>();
+    sub->callback = move(callback);
+
+    // Holding the delivery lock from before registration means an event
+    // published after the snapshot cannot overtake it. It is taken first, the
+    // same order as a callback that queries the manager.
+    unique_lock<mutex> delivery(sub->deliveryMutex);
+    uint64_t token;
+    JobEvent snapshot;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) return 0;
+
+        Job& job = *it->second;
+        token = nextToken++;
+        if (!isFinal(job.last.state)) {
+            job.subscribers.emplace_back(token, sub);
+            subscriptions.emplace(token, sub);
+        }
+        snapshot = job.last;
+    }
+
+    sub->callback(snapshot);
+    return token;
+}
+
+void JobManager::unsubscribe(uint64_t token) {
+    shared_ptr<Subscription> sub;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        auto it = subscriptions.find(token);
+        if (it == subscriptions.end()) return;
+        sub = move(it->second);
+        subscriptions.erase(it);
+    }
+    // The job's own list drops it on the next publish
+    lock_guard<mutex> delivery(sub->deliveryMutex);
+    sub->active = false;
+}
+
+JobManager::Stats JobManager::stats() const {
+    lock_guard<mutex> lock(jobsMutex);
+    Stats s = counters;
+    s.queued = queue.size();
+    s.running = running;
+    s.retained = jobs.size();
+    return s;
+}
+
+void JobManager::publish(const string& jobId, JobEvent event) {
+    shared_ptr<Job> job;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        auto it = jobs.find(jobId);
+        if (it == jobs.end()) return;
+        job = it->second;
+    }
+    publish(*job, move(event));
+}
+
+void JobManager::publish(Job& job, JobEvent event, shared_ptr<const JobResult> result) {
+    event.jobId = job.id;
+    bool final = isFinal(event.state);
+
+    vector<shared_ptr<Subscription>> targets;
+    vector<uint64_t> finishedTokens;
+    {
+        lock_guard<mutex> lock(jobsMutex);
+        job.last = event;
+
+        auto dropped = [&](const pair<uint64_t, shared_ptr<Subscription>>& s) {
+            return !subscriptions.count(s.first);
+        };
+        job.subscribers.erase(remove_if(job.subscribers.begin(), job.subscribers.end(), dropped),
+                              job.subscribers.end());
+        targets.reserve(job.subscribers.size());
+        for (auto& s : job.subscribers) targets.push_back(s.second);
+
+        if (final) {
+            job.finishedAt = chrono::steady_clock::now();
+            job.result = move(result);
+            job.input = string();
+
+            switch (event.state) {
+                case JobState::SUCCEEDED: ++counters.succeeded; break;
+                case JobState::FAILED:    ++counters.failed;    break;
+                case JobState::CANCELLED: ++counters.cancelled; break;
+                case JobState::EXPIRED:   ++counters.expired;   break;
+                default: break;
+            }
+
+            // Nothing follows a final event
+            for (auto& s : job.subscribers) finishedTokens.push_back(s.first);
+            job.subscribers.clear();
+
+            finishedOrder.push_back(job.id);
+            while (finishedOrder.size() > limits.maxRetained) {
+                jobs.erase(finishedOrder.front());
+                finishedOrder.pop_front();
+            }
+        }
+    }
+
+    for (auto& sub : targets) {
+        lock_guard<mutex> delivery(sub->deliveryMutex);
+        if (sub->active) sub->callback(event);
+    }
+
+    // Only after delivery, or an unsubscribe() racing it could return too early
+    if (!finishedTokens.empty()) {
+        lock_guard<mutex> lock(jobsMutex);
+        for (uint64_t token : finishedTokens) subscriptions.erase(token);
+    }
+}
+
+void JobManager::workerLoop() {
+    for (;;) {
+        shared_ptr<Job> job;
+        {
+            unique_lock<mutex> lock(jobsMutex);
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            job = move(queue.front());
+            queue.pop_front();
+            job->startedAt = chrono::steady_clock::now();
+            ++running;
+        }
+
+        run(*job);
+
+        lock_guard<mutex> lock(jobsMutex);
+        --running;
+    }
+}
+
+void JobManager::run(Job& job) {
+    auto stopped = [&job](JobEvent& event) {
+        if (job.cancelRequested) {
+            event.state = JobState::CANCELLED;
+            event.error = "cancelled";
+            return true;
+        }
+        if (chrono::steady_clock::now() >= job.deadline) {
+            event.state = JobState::EXPIRED;
+            event.error = "deadline exceeded";
+            return true;
+        }
+        return false;
+    };
+    auto fail = [](string message) {
+        return make_shared<JobResult>(JobResult{false, move(message), "text/plain"});
+    };
+
+    JobEvent done;
+    if (stopped(done)) {
+        publish(job, done, fail(done.error));
+        return;
+    }
+
+    JobEvent event;
+    event.state = JobState::RUNNING;
+    event.stage = "compile";
+    publish(job, event);
+
+    // The simulator only reads the binary image
+    CompileOptions options = job.options;
+    if (simulate) options.format = OutputFormat::BINARY;
+
+    bool ok = false;
+    string compiled;
+    try {
+        compiled = compileIR(job.input, *profiles.current(), ok, options, cache);
+    } catch (const exception& e) {
+        compiled = e.what();
+    }
+    job.input = string();
+
+    done.stage = "compile";
+    if (!ok) {
+        // Validation failures come back as a JSON report; the rest is plain text
+        bool report = !compiled.empty() && compiled[0] == '{';
+        done.state = JobState::FAILED;
+        done.error = report ? "validation failed" : compiled;
+        publish(job, done, make_shared<JobResult>(JobResult{
+            false, move(compiled), report ? "application/json" : "text/plain"}));
+        return;
+    }
+    if (stopped(done)) {
+        publish(job, done, fail(done.error));
+        return;
+    }
+
+    if (!simulate) {
+        bool binary = options.format == OutputFormat::BINARY;
+        done.state = JobState::SUCCEEDED;
+        done.progress = 1.0;
+        publish(job, done, make_shared<JobResult>(JobResult{
+            true, move(compiled), binary ? "application/octet-stream" : "application/json"}));
+        return;
+    }
+
+    event.stage = "simulate";
+    publish(job, event);
+
+    JobContext context(*this, job.id, job.cancelRequested, job.deadline);
+    string results;
+    done.stage = "simulate";
+    try {
+        results = simulate(compiled, context);
+    } catch (const exception& e) {
+        done.state = JobState::FAILED;
+        done.error = e.what();
+        publish(job, done, fail(done.error));
+        return;
+    }
+
+    // A stage that ran past its deadline or was cancelled is not trusted to be complete
+    if (stopped(done)) {
+        publish(job, done, fail(done.error));
+        return;
+    }
+    done.state = JobState::SUCCEEDED;
+    done.progress = 1.0;
+    publish(job, done, make_shared<JobResult>(JobResult{true, move(results), "application/json"}));
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include "compile_cache.h"
+#include "compiler_driver.h"
+#include "profile_repository.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Asynchronous compile (+ simulate) jobs.
+ *
+ * HTTP handlers only submit and query; the work runs on a fixed pool of
+ * worker threads, so a long job never occupies one of the server's I/O
+ * threads. Admission is bounded: once `maxQueued` jobs are waiting, submit()
+ * turns new ones away instead of letting latency grow without limit.
+ *
+ * Every job has a deadline. Cancellation and deadlines are cooperative: a
+ * queued job is dropped before it starts, a running one stops at the next
+ * stage boundary or the next time its stage checks JobContext::cancelled().
+ *
+ * State changes and progress reach subscribers as JobEvents, delivered on
+ * the worker thread. unsubscribe() waits out a delivery in flight, so a
+ * callback never runs after it returns.
+ */
+
+enum class JobState : uint8_t { QUEUED, RUNNING, SUCCEEDED, FAILED, CANCELLED, EXPIRED };
+
+const char* jobStateStr(JobState s);
+inline bool isFinal(JobState s) { return s != JobState::QUEUED && s != JobState::RUNNING; }
+
+class JsonWriter;
+
+struct JobEvent {
+    string   jobId;
+    JobState state = JobState::QUEUED;
+    string   stage;                             // "compile", "simulate", ...
+    double   progress = 0.0;                    // of the current stage, 0..1
+    vector<pair<string, double>> metrics;       // interim values reported by the stage
+    string   error;                             // set once FAILED, CANCELLED or EXPIRED
+};
+
+// The event's members, into an object the caller has opened
+void writeJobEvent(JsonWriter& w, const JobEvent& e);
+
+struct JobStatus {
+    JobEvent last;                              // the most recent event
+    chrono::milliseconds queuedFor{0};
+    chrono::milliseconds ranFor{0};
+    chrono::milliseconds deadlineIn{0};         // negative once passed
+};
+
+struct JobResult {
+    bool   ok = false;
+    string output;                              // compiled IR or simulation results; the error otherwise
+    string contentType;
+};
+
+class JobManager;
+
+// Handed to the simulate stage
+class JobContext {
+public:
+    // Cancel requested or deadline passed; long stages should poll this
+    bool cancelled() const;
+    chrono::steady_clock::time_point deadline() const { return deadlineAt; }
+
+    // Rate-limited to a few events per second per job, except the last one (fraction 1)
+    void progress(double fraction, vector<pair<string, double>> metrics = {});
+
+private:
+    friend class JobManager;
+    JobContext(JobManager& manager, const string& jobId, const atomic<bool>& cancelFlag,
+               chrono::steady_clock::time_point deadline);
+
+    JobManager& manager;
+    const string& jobId;
+    const atomic<bool>& cancelFlag;
+    chrono::steady_clock::time_point deadlineAt;
+    chrono::steady_clock::time_point lastEvent{};
+};
+
+// Runs a compiled binary IR image; returns the results as JSON, throws on failure
+using SimulateStage = function<string(const string& image, JobContext& context)>;
+
+class JobManager {
+public:
+    struct Limits {
+        unsigned workers = 0;                           // 0 = hardware concurrency
+        size_t   maxQueued = 64;                        // admission bound on waiting jobs
+        size_t   maxRetained = 256;                     // finished jobs kept for status / result
+        size_t   maxInputBytes = size_t(64) << 20;
+        chrono::milliseconds defaultDeadline{60000};
+        chrono::milliseconds maxDeadline{600000};
+    };
+
+    struct Request {
+        string input;                                   // the UI's export
+        CompileOptions options;                         // output of a compile-only job
+        chrono::milliseconds deadline{0};               // 0 = Limits::defaultDeadline
+    };
+
+    enum class Admission { ACCEPTED, QUEUE_FULL, TOO_LARGE, SHUTTING_DOWN };
+
+    struct Stats {
+        size_t   queued = 0;
+        size_t   running = 0;
+        size_t   retained = 0;
+        unsigned workers = 0;
+        uint64_t submitted = 0;
+        uint64_t rejected = 0;
+        uint64_t succeeded = 0;
+        uint64_t failed = 0;
+        uint64_t cancelled = 0;
+        uint64_t expired = 0;
+    };
+
+    JobManager(ProfileRepository& profiles, CompileCache& cache, const Limits& limits);
+    ~JobManager();                                      // cancels what is left, queued jobs with a final event, and joins
+
+    JobManager(const JobManager&) = delete;
+    JobManager& operator=(const JobManager&) = delete;
+
+    // Without a simulate stage a job is a compile in the requested format;
+    // with one, the compile is always binary and feeds the stage. Set before
+    // the first submit().
+    void setSimulateStage(SimulateStage stage);
+
+    Admission submit(Request request, string& jobId);
+
+    bool status(const string& jobId, JobStatus& out) const;
+
+    // Null until the job is final
+    shared_ptr<const JobResult> result(const string& jobId) const;
+
+    // False if the job is unknown or already final
+    bool cancel(const string& jobId);
+
+    // The callback gets the job's current state at once, then every later
+    // event up to and including the final one. Returns 0 for an unknown job.
+    // Callbacks run on a worker thread and must not unsubscribe themselves.
+    uint64_t subscribe(const string& jobId, function<void(const JobEvent&)> callback);
+    void unsubscribe(uint64_t token);
+
+    Stats stats() const;
+
+    size_t maxInputBytes() const { return limits.maxInputBytes; }
+
+    // $SIMRUN_JOB_WORKERS and $SIMRUN_JOB_QUEUE override the defaults
+    static Limits defaultLimits();
+
+private:
+    friend class JobContext;
+
+    struct Subscription {
+        mutex deliveryMutex;
+        bool  active = true;
+        function<void(const JobEvent&)> callback;
+    };
+
+    struct Job {
+        string id;
+        string input;
+        CompileOptions options;
+        chrono::steady_clock::time_point submittedAt, startedAt, finishedAt, deadline;
+        atomic<bool> cancelRequested{false};
+
+        JobEvent last;                                  // guarded by jobsMutex
+        shared_ptr<const JobResult> result;
+        vector<pair<uint64_t, shared_ptr<Subscription>>> subscribers;
+    };
+
+    ProfileRepository& profiles;
+    CompileCache& cache;
+    Limits limits;
+    SimulateStage simulate;
+
+    mutable mutex jobsMutex;
+    condition_variable workAvailable;
+    deque<shared_ptr<Job>> queue;
+    unordered_map<string, shared_ptr<Job>> jobs;
+    deque<string> finishedOrder;                        // oldest first, for retention
+    unordered_map<uint64_t, shared_ptr<Subscription>> subscriptions;
+    uint64_t nextToken = 1;
+    size_t running = 0;
+    bool stopping = false;
+    Stats counters;
+
+    vector<thread> workers;
+
+    void workerLoop();
+    void run(Job& job);
+    string newJobId();
+
+    // Records the event as the job's latest and delivers it; `result` is set
+    // together with a final state
+    void publish(Job& job, JobEvent event, shared_ptr<const JobResult> result = nullptr);
+    void publish(const string& jobId, JobEvent event);
+};
@@ -0,0 +1,286 @@
+#include "json_reader.h"
+#include <charconv>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+JsonReader::JsonReader(string_view input, deque<string>& escapeArena)
+    : begin(input.data()),
+      cur(input.data()),
+      end(input.data() + input.size()),
+      arena(escapeArena) {}
+
+void JsonReader::fail(const string& what) const {
+    throw runtime_error("JSON parse error at offset " + to_string(cur - begin) + ": " + what);
+}
+
+// ---------- Scanning ----------
+
+void JsonReader::skipWhitespace() {
+#if defined(__SSE2__)
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i tb = _mm_set1_epi8('\t');
+
+    while (end - cur >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur));
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, sp), _mm_cmpeq_epi8(v, nl)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, cr), _mm_cmpeq_epi8(v, tb)));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(ws)) & 0xFFFFu;
+        if (mask) {
+            cur += __builtin_ctz(mask);
+            return;
+        }
+        cur += 16;
+    }
+#endif
+    while (cur < end && (*cur == ' ' || *cur == '\n' || *cur == '\r' || *cur == '\t'))
+        ++cur;
+}
+
+// First '"', '\\' or control character at or after p
+const char* JsonReader::findStringEnd(const char* p) const {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i ctrl  = _mm_set1_epi8(0x1F);
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hit = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));   // v <= 0x1F
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20)
+        ++p;
+    return p;
+}
+
+char JsonReader::peek() {
+    skipWhitespace();
+    if (cur == end) fail("unexpected end of input");
+    return *cur;
+}
+
+void JsonReader::expect(char c) {
+    if (peek() != c) fail(string("expected '") + c + "'");
+    ++cur;
+}
+
+// ---------- Containers ----------
+
+void JsonReader::beginObject() {
+    expect('{');
+    firstInContainer = true;
+}
+
+bool JsonReader::nextMember(string_view& key) {
+    if (peek() == '}') {
+        ++cur;
+        firstInContainer = false;
+        return false;
+    }
+    if (!firstInContainer) expect(',');
+    firstInContainer = false;
+
+    key = readString();
+    expect(':');
+    return true;
+}
+
+void JsonReader::beginArray() {
+    expect('[');
+    firstInContainer = true;
+}
+
+bool JsonReader::nextElement() {
+    if (peek() == ']') {
+        ++cur;
+        firstInContainer = false;
+        return false;
+    }
+    if (!firstInContainer) expect(',');
+    firstInContainer = false;
+    return true;
+}
+
+// ---------- Scalars ----------
+
+bool JsonReader::peekString() {
+    return peek() == '"';
+}
+
+bool JsonReader::peekBool() {
+    char c = peek();
+    return c == 't' || c == 'f';
+}
+
+bool JsonReader::peekNull() {
+    return peek() == 'n';
+}
+
+string_view JsonReader::readString() {
+    expect('"');
+    const char* start = cur;
+    const char* p = findStringEnd(cur);
+
+    if (p < end && *p == '"') {        // common case: no escapes, zero-copy
+        cur = p + 1;
+        return string_view(start, p - start);
+    }
+
+    // Escapes present: find the real closing quote, then decode once
+    while (p < end && *p != '"') {
+        if (*p == '\\') {
+            if (++p == end) break;
+        } else if (static_cast<unsigned char>(*p) < 0x20) {
+            cur = p;
+            fail("control character in string");
+        }
+        p = findStringEnd(p + 1);
+    }
+    if (p >= end) fail("unterminated string");
+
+    cur = p + 1;
+    return decodeEscaped(start, p);
+}
+
+static void appendUtf8(string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+string_view JsonReader::decodeEscaped(const char* from, const char* to) {
+    string out;
+    out.reserve(to - from);
+
+    auto hex4 = [&](const char* p) -> unsigned {
+        if (to - p < 4) fail("truncated \\u escape");
+        unsigned v = 0;
+        auto [ptr, ec] = from_chars(p, p + 4, v, 16);
+        if (ec != errc() || ptr != p + 4) fail("invalid \\u escape");
+        return v;
+    };
+
+    for (const char* p = from; p < to; ++p) {
+        if (*p != '\\') { out += *p; continue; }
+        switch (*++p) {
+            case '"':  out += '"';  break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/';  break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned cp = hex4(p + 1);
+                p += 4;
+                if (cp >= 0xD800 && cp < 0xDC00 && to - p > 6 && p[1] == '\\' && p[2] == 'u') {
+                    unsigned lo = hex4(p + 3);
+                    if (lo >= 0xDC00 && lo < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                        p += 6;
+                    }
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                fail("invalid escape sequence");
+        }
+    }
+
+    arena.push_back(move(out));
+    return arena.back();
+}
+
+double JsonReader::readNumber(bool* integral) {
+    skipWhitespace();
+    const char* start = cur;
+    bool isInt = true;
+
+    if (cur < end && *cur == '-') ++cur;
+    while (cur < end) {
+        char c = *cur;
+        if (c >= '0' && c <= '9') { ++cur; continue; }
+        if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') { isInt = false; ++cur; continue; }
+        break;
+    }
+
+    double v = 0.0;
+    auto [ptr, ec] = from_chars(start, cur, v);
+    if (ec != errc() || ptr != cur) {
+        cur = start;
+        fail("invalid number");
+    }
+    if (integral) *integral = isInt;
+    return v;
+}
+
+bool JsonReader::readBool() {
+    skipWhitespace();
+    if (end - cur >= 4 && string_view(cur, 4) == "true")  { cur += 4; return true; }
+    if (end - cur >= 5 && string_view(cur, 5) == "false") { cur += 5; return false; }
+    fail("expected boolean");
+}
+
+void JsonReader::readNull() {
+    skipWhitespace();
+    if (end - cur >= 4 && string_view(cur, 4) == "null") { cur += 4; return; }
+    fail("expected null");
+}
+
+void JsonReader::skipValue() {
+    switch (peek()) {
+        case '{': {
+            beginObject();
+            string_view key;
+            while (nextMember(key)) skipValue();
+            break;
+        }
+        case '[':
+            beginArray();
+            while (nextElement()) skipValue();
+            break;
+        case '"': {
+            // No need to decode: only find the closing quote
+            const char* p = findStringEnd(cur + 1);
+            while (p < end && *p != '"') p = findStringEnd(p + (*p == '\\' ? 2 : 1));
+            if (p >= end) fail("unterminated string");
+            cur = p + 1;
+            break;
+        }
+        case 't': case 'f': readBool(); break;
+        case 'n': readNull(); break;
+        default:  readNumber(); break;
+    }
+}
+
+void JsonReader::finish() {
+    skipWhitespace();
+    if (cur != end) fail("trailing characters after document");
+}
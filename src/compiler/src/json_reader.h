@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/*
+ * Single-pass pull parser over a JSON buffer.
+ *
+ * Nothing is materialised unless the caller asks for it: strings come back
+ * as string_views into the input (only strings containing escapes are decoded,
+ * into a caller-provided arena), numbers are converted in place, and unwanted
+ * values are skipped without building anything. String and whitespace scans
+ * run 16 bytes at a time with SSE2 when available.
+ *
+ * The views stay valid as long as the input buffer (and the escape arena) do.
+ */
+class JsonReader {
+public:
+    JsonReader(string_view input, deque<string>& escapeArena);
+
+    // ---- objects / arrays ----
+    // beginObject();  while (nextMember(key)) { ... consume value ... }
+    void beginObject();
+    bool nextMember(string_view& key);
+
+    void beginArray();
+    bool nextElement();
+
+    // ---- scalars ----
+    bool peekString();
+    bool peekBool();
+    bool peekNull();
+    string_view readString();
+    double readNumber(bool* integral = nullptr);
+    bool readBool();
+    void readNull();
+
+    void skipValue();
+
+    // Throws unless only whitespace is left
+    void finish();
+
+    [[noreturn]] void fail(const string& what) const;
+
+private:
+    const char* begin;
+    const char* cur;
+    const char* end;
+    deque<string>& arena;
+
+    bool firstInContainer = false;
+
+    char peek();
+    void expect(char c);
+    void skipWhitespace();
+    const char* findStringEnd(const char* p) const;
+    string_view decodeEscaped(const char* from, const char* to);
+};
@@ -0,0 +1,124 @@
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+
+using namespace std;
+
+JsonWriter::JsonWriter(string& out, bool compact)
+    : out(out), compact(compact) {}
+
+void JsonWriter::newline() {
+    out += '\n';
+    out.append(static_cast<size_t>(depth) * 2, ' ');
+}
+
+void JsonWriter::separator() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!first) out += ',';
+    if (!compact && depth > 0) newline();
+    first = false;
+}
+
+// ---------- Containers ----------
+
+void JsonWriter::beginObject() {
+    separator();
+    out += '{';
+    ++depth;
+    first = true;
+}
+
+void JsonWriter::endObject() {
+    --depth;
+    if (!first && !compact) newline();
+    out += '}';
+    first = false;
+}
+
+void JsonWriter::beginArray() {
+    separator();
+    out += '[';
+    ++depth;
+    first = true;
+}
+
+void JsonWriter::endArray() {
+    --depth;
+    if (!first && !compact) newline();
+    out += ']';
+    first = false;
+}
+
+void JsonWriter::key(string_view k) {
+    separator();
+    writeEscaped(k);
+    out += compact ? ":" : ": ";
+    afterKey = true;
+}
+
+// ---------- Scalars ----------
+
+void JsonWriter::text(string_view s) {
+    separator();
+    writeEscaped(s);
+}
+
+void JsonWriter::number(double d) {
+    separator();
+    if (!isfinite(d)) {
+        out += "null";
+        return;
+    }
+    char buf[32];
+    auto res = to_chars(buf, buf + sizeof(buf), d);
+    out.append(buf, res.ptr);
+}
+
+void JsonWriter::integer(int64_t i) {
+    separator();
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), i);
+    out.append(buf, res.ptr);
+}
+
+void JsonWriter::boolean(bool b) {
+    separator();
+    out += b ? "true" : "false";
+}
+
+void JsonWriter::null() {
+    separator();
+    out += "null";
+}
+
+void JsonWriter::writeEscaped(string_view s) {
+    static const char hex[] = "0123456789abcdef";
+
+    out += '"';
+    size_t run = 0;     // start of the pending unescaped run
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            case '\b': out += "\\b";  break;
+            case '\f': out += "\\f";  break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.append(u, sizeof(u));
+            }
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+    out += '"';
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/*
+ * Streaming JSON writer that appends straight into a caller-owned buffer.
+ *
+ * Commas, indentation and key/value separators are tracked internally, so
+ * callers just emit tokens in document order. Numbers are formatted with
+ * to_chars (shortest round-trip for doubles), strings are escaped per
+ * RFC 8259, and nothing is allocated beyond the buffer's own growth; reuse
+ * the same buffer across documents to make even that disappear.
+ */
+class JsonWriter {
+public:
+    JsonWriter(string& out, bool compact = false);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(string_view k);
+
+    void text(string_view s);
+    void number(double d);      // non-finite values are written as null
+    void integer(int64_t i);
+    void boolean(bool b);
+    void null();
+
+private:
+    string& out;
+    bool compact;
+    int depth = 0;
+    bool first = true;          // no element written yet in the current container
+    bool afterKey = false;      // next token is a member value
+
+    void separator();
+    void newline();
+    void writeEscaped(string_view s);
+};
@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "compile_cache.h"
+#include "compiler_driver.h"
+#include "daemon.h"
+#include "job_manager.h"
+#include "profile_repository.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <csignal>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static int usage() {
+    cerr << "usage: compiler <input.json> [--binary] [--compact]\n"
+            "       compiler --daemon [--socket <path>]\n";
+    return 2;
+}
+
+// One compile, output on stdout
+static int runOnce(const string& inputPath, const CompileOptions& options) {
+    ifstream in(inputPath, ios::binary);
+    if (!in) {
+        cerr << "Cannot open " << inputPath << "\n";
+        return 1;
+    }
+    stringstream input;
+    input << in.rdbuf();
+
+    ProfileRepository profiles(ProfileRepository::defaultPath());
+    bool ok = false;
+    string output = compileIR(input.str(), *profiles.current(), ok, options);
+
+    (ok ? cout : cerr) << output;
+    return ok ? 0 : 1;
+}
+
+// Frames go to the original stdout; anything else printed lands on stderr
+static int runDaemon(const char* socketPath) {
+    ProfileRepository profiles(ProfileRepository::defaultPath());
+    string watchError;
+    if (!profiles.watch(&watchError))
+        cerr << "profile hot reload disabled: " << watchError << "\n";
+    CompileCache cache(CompileCache::defaultCapacity());
+    JobManager jobs(profiles, cache, JobManager::defaultLimits());
+    CompilerDaemon daemon(profiles, cache, jobs);
+
+#ifndef _WIN32
+    // A client that hangs up mid-reply must end its session, not the daemon
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    if (socketPath) {
+        daemon.listen(socketPath);
+        return 0;
+    }
+
+#ifdef _WIN32
+    _setmode(0, _O_BINARY);
+    int out = _dup(1);
+    _setmode(out, _O_BINARY);
+    _dup2(2, 1);
+#else
+    int out = dup(1);
+    dup2(2, 1);
+#endif
+
+    daemon.serve(0, out);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 2 && strcmp(argv[1], "--daemon") == 0) {
+            const char* socketPath = nullptr;
+            if (argc == 4 && strcmp(argv[2], "--socket") == 0) socketPath = argv[3];
+            else if (argc != 2) return usage();
+            return runDaemon(socketPath);
+        }
+
+        if (argc < 2 || argv[1][0] == '-') return usage();
+
+        CompileOptions options;
+        for (int i = 2; i < argc; ++i) {
+            if (strcmp(argv[i], "--binary") == 0)       options.format = OutputFormat::BINARY;
+            else if (strcmp(argv[i], "--compact") == 0) options.compact = true;
+            else return usage();
+        }
+        return runOnce(argv[1], options);
+    } catch (const exception& e) {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,91 @@
+#include "params.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+struct RegistryState {
+    shared_mutex mutex;
+    deque<string> storage;                          // element addresses never move
+    unordered_map<string_view, ParamKey> index;
+    unique_ptr<string_view[]> names{new string_view[ParamRegistry::MAX_KEYS]};
+    atomic<size_t> count{0};
+};
+
+RegistryState& registry() {
+    static RegistryState state;
+    return state;
+}
+
+}
+
+ParamKey ParamRegistry::intern(string_view name) {
+    RegistryState& r = registry();
+    {
+        shared_lock<shared_mutex> lock(r.mutex);
+        auto it = r.index.find(name);
+        if (it != r.index.end()) return it->second;
+    }
+
+    unique_lock<shared_mutex> lock(r.mutex);
+    auto it = r.index.find(name);
+    if (it != r.index.end()) return it->second;
+
+    size_t n = r.count.load(memory_order_relaxed);
+    if (n >= MAX_KEYS)
+        throw runtime_error("Too many distinct parameter names (limit " + to_string(MAX_KEYS) + ")");
+
+    string_view stored = r.storage.emplace_back(name);
+    ParamKey key = static_cast<ParamKey>(n);
+    r.names[key] = stored;
+    r.index.emplace(stored, key);
+    r.count.store(n + 1, memory_order_release);
+    return key;
+}
+
+bool ParamRegistry::find(string_view name, ParamKey& key) {
+    RegistryState& r = registry();
+    shared_lock<shared_mutex> lock(r.mutex);
+    auto it = r.index.find(name);
+    if (it == r.index.end()) return false;
+    key = it->second;
+    return true;
+}
+
+string_view ParamRegistry::name(ParamKey key) {
+    RegistryState& r = registry();
+    if (key >= r.count.load(memory_order_acquire)) return {};
+    return r.names[key];
+}
+
+size_t ParamRegistry::size() {
+    return registry().count.load(memory_order_acquire);
+}
+
+size_t normalizeParams(ParamSlot* slots, size_t count) {
+    stable_sort(slots, slots + count,
+                [](const ParamSlot& a, const ParamSlot& b) { return a.key < b.key; });
+
+    size_t out = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + 1 < count && slots[i + 1].key == slots[i].key) continue;   // a later duplicate wins
+        slots[out++] = slots[i];
+    }
+    return out;
+}
+
+const ParamSlot* findParam(const ParamSlot* slots, size_t count, ParamKey key) {
+    const ParamSlot* end = slots + count;
+    const ParamSlot* it = lower_bound(slots, end, key,
+                                      [](const ParamSlot& p, ParamKey k) { return p.key < k; });
+    return it != end && it->key == key ? it : nullptr;
+}
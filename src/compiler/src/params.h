@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Typed, slot-indexed parameter storage.
+ *
+ * Parameter names are interned once into small integer keys, and a value is a
+ * fixed 16-byte slot. Every parameter set in an IR is a run of slots in one
+ * shared array, sorted by key, so applying a profile's defaults is a single
+ * block copy and an override is a binary search instead of a string compare
+ * per map node.
+ */
+
+using ParamKey = uint16_t;
+
+enum class ParamType : uint8_t { INT, DOUBLE, STRING, BOOL };
+
+/*
+ * Trivially copyable so blocks of slots can be memcpy'd. STRING slots only
+ * view their characters: profile defaults point into the catalog, user values
+ * into the IR's input or string arena.
+ */
+struct ParamSlot {
+    ParamKey  key;
+    ParamType type;
+    uint32_t  length;           // STRING only
+    union {
+        int64_t     i;
+        double      d;
+        bool        b;
+        const char* s;
+    };
+
+    static ParamSlot integer(ParamKey k, int64_t v) { ParamSlot p{}; p.key = k; p.type = ParamType::INT;    p.i = v; return p; }
+    static ParamSlot number(ParamKey k, double v)   { ParamSlot p{}; p.key = k; p.type = ParamType::DOUBLE; p.d = v; return p; }
+    static ParamSlot boolean(ParamKey k, bool v)    { ParamSlot p{}; p.key = k; p.type = ParamType::BOOL;   p.b = v; return p; }
+    static ParamSlot text(ParamKey k, string_view v) {
+        ParamSlot p{};
+        p.key = k;
+        p.type = ParamType::STRING;
+        p.s = v.data();
+        p.length = static_cast<uint32_t>(v.size());
+        return p;
+    }
+
+    string_view text() const { return string_view(s, length); }
+};
+
+static_assert(is_trivially_copyable_v<ParamSlot>, "ParamSlot must stay memcpy-able");
+static_assert(sizeof(ParamSlot) == 16, "ParamSlot layout changed");
+
+// A run of slots in IR::params
+struct ParamRange {
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+/*
+ * Keys from here up belong to a single IR (IR::local_params): names a request
+ * uses that neither the schema nor the catalog knows. They are numbered per
+ * IR and freed with it, so client input never grows the process-wide table.
+ */
+constexpr ParamKey LOCAL_PARAM_KEY = 0x8000;
+
+/*
+ * Process-wide name <-> key table for the fixed names of the schema and the
+ * profile catalog. Keys are dense, start at 0 and are never reused, so they
+ * stay valid across catalog reloads. intern() and find() are thread-safe;
+ * name() takes no lock.
+ */
+class ParamRegistry {
+public:
+    static constexpr size_t MAX_KEYS = LOCAL_PARAM_KEY;
+
+    // Throws runtime_error once MAX_KEYS distinct names have been seen; only
+    // for trusted names, never for request input
+    static ParamKey intern(string_view name);
+    // Looks `name` up without adding it
+    static bool find(string_view name, ParamKey& key);
+    static string_view name(ParamKey key);
+    static size_t size();
+};
+
+// Sorts slots by key; for duplicate keys the last one wins. Returns the new count.
+size_t normalizeParams(ParamSlot* slots, size_t count);
+
+// Binary search in a run sorted by key
+const ParamSlot* findParam(const ParamSlot* slots, size_t count, ParamKey key);
+inline ParamSlot* findParam(ParamSlot* slots, size_t count, ParamKey key) {
+    return const_cast<ParamSlot*>(findParam(static_cast<const ParamSlot*>(slots), count, key));
+}
+
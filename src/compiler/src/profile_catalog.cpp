@@ -0,0 +1,120 @@
+#include "profile_catalog.h"
+#include <yaml-cpp/yaml.h>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <stdexcept>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+static bool parseBool(string_view s, bool& out) {
+    // YAML 1.1 spellings, as accepted by yaml-cpp's as<bool>()
+    static constexpr string_view TRUE_WORDS[]  = {"true", "True", "TRUE", "yes", "Yes", "YES", "on", "On", "ON", "y", "Y"};
+    static constexpr string_view FALSE_WORDS[] = {"false", "False", "FALSE", "no", "No", "NO", "off", "Off", "OFF", "n", "N"};
+    for (auto w : TRUE_WORDS)  if (s == w) { out = true;  return true; }
+    for (auto w : FALSE_WORDS) if (s == w) { out = false; return true; }
+    return false;
+}
+
+// The integer spellings yaml-cpp's as<int>() reads: an optional sign, then
+// decimal, 0x hexadecimal, or octal with a leading zero ("010" is 8)
+static bool parseInteger(const char* first, const char* last, int64_t& out) {
+    bool negative = first != last && *first == '-';
+    if (first != last && (*first == '-' || *first == '+')) ++first;
+
+    int base = 10;
+    if (last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X')) {
+        base = 16;
+        first += 2;
+    } else if (last - first > 1 && first[0] == '0') {
+        base = 8;
+        ++first;
+    }
+
+    uint64_t magnitude = 0;
+    auto r = from_chars(first, last, magnitude, base);
+    if (first == last || r.ec != errc() || r.ptr != last) return false;
+
+    const uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+    if (magnitude > limit) return false;
+    out = negative ? -static_cast<int64_t>(magnitude - 1) - 1 : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+/*
+ * Type a YAML scalar once, by inspecting its text: int -> double -> bool -> string.
+ * Quoted scalars are always strings.
+ */
+static ParamSlot typeScalar(ParamKey key, const YAML::Node& node, deque<string>& strings) {
+
+    if (!node.IsScalar()) {
+        throw runtime_error("Only scalar YAML values are supported");
+    }
+
+    const string& text = node.Scalar();
+    if (node.Tag() != "!" && !text.empty()) {
+        const char* last = text.data() + text.size();
+
+        int64_t i = 0;
+        if (parseInteger(text.data(), last, i)) return ParamSlot::integer(key, i);
+
+        // from_chars would also take "inf"/"nan"; only plain decimal forms count,
+        // so YAML's .inf and .nan stay strings
+        const char* first = text.data() + (text[0] == '+' ? 1 : 0);
+        bool numeric = all_of(first, last, [](char c) {
+            return (c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E';
+        });
+        double d = 0.0;
+        auto rd = from_chars(first, last, d);
+        if (numeric && rd.ec == errc() && rd.ptr == last) return ParamSlot::number(key, d);
+
+        bool b = false;
+        if (parseBool(text, b)) return ParamSlot::boolean(key, b);
+    }
+
+    return ParamSlot::text(key, strings.emplace_back(text));
+}
+
+static void loadDirectory(const fs::path& dir, map<string, Profile, less<>>& out, deque<string>& strings) {
+    if (!fs::is_directory(dir)) return;
+
+    for (auto& entry : fs::directory_iterator(dir)) {
+        auto ext = entry.path().extension();
+        if (!entry.is_regular_file() || (ext != ".yaml" && ext != ".yml")) continue;
+
+        Profile profile;
+        profile.name = entry.path().stem().string();
+
+        YAML::Node root = YAML::LoadFile(entry.path().string());
+        if (root["defaults"]) {
+            for (auto it : root["defaults"])
+                profile.defaults.push_back(
+                    typeScalar(ParamRegistry::intern(it.first.as<string>()), it.second, strings));
+        }
+        profile.defaults.resize(normalizeParams(profile.defaults.data(), profile.defaults.size()));
+
+        out.emplace(profile.name, move(profile));
+    }
+}
+
+unique_ptr<const ProfileCatalog> ProfileCatalog::load(const string& basePath) {
+    static atomic<uint64_t> nextVersion{1};
+
+    auto catalog = unique_ptr<ProfileCatalog>(new ProfileCatalog());
+    loadDirectory(fs::path(basePath) / "components", catalog->components, catalog->strings);
+    loadDirectory(fs::path(basePath) / "networks", catalog->networks, catalog->strings);
+    catalog->version_ = nextVersion++;
+    return catalog;
+}
+
+const Profile* ProfileCatalog::component(string_view name) const {
+    auto it = components.find(name);
+    return it == components.end() ? nullptr : &it->second;
+}
+
+const Profile* ProfileCatalog::network(string_view name) const {
+    auto it = networks.find(name);
+    return it == networks.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "params.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+struct Profile {
+    string name;
+    // Typed once at load time, sorted by key; copied as one block per component
+    vector<ParamSlot> defaults;
+};
+
+/*
+ * Immutable snapshot of every profile under <base>/components and
+ * <base>/networks. Built once, never modified afterwards, so any number of
+ * threads can read it without synchronisation.
+ */
+class ProfileCatalog {
+public:
+    // Throws runtime_error / YAML::Exception if a profile cannot be read
+    static unique_ptr<const ProfileCatalog> load(const string& basePath);
+
+    const Profile* component(string_view name) const;
+    const Profile* network(string_view name) const;
+
+    // Distinct for every successful load; lets caches tell catalogs apart
+    uint64_t version() const { return version_; }
+
+private:
+    map<string, Profile, less<>> components;
+    map<string, Profile, less<>> networks;
+    uint64_t version_ = 0;
+
+    deque<string> strings;      // backing storage for STRING defaults
+};
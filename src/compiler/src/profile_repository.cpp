@@ -1,22 +1,130 @@
 #include "profile_repository.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = std::filesystem;
 
 ProfileRepository::ProfileRepository(const string& basePath)
-    : basePath(basePath) {}
+    : basePath(basePath) {
+    publish(ProfileCatalog::load(basePath));
+}
+
+ProfileRepository::~ProfileRepository() {
+#ifdef __linux__
+    if (watcher.joinable()) {
+        uint64_t one = 1;
+        if (write(stopFd, &one, sizeof(one)) < 0) { /* watcher also exits on close */ }
+        watcher.join();
+    }
+    if (stopFd >= 0) close(stopFd);
+#endif
+}
+
+bool ProfileRepository::reload(string* error) {
+    unique_ptr<const ProfileCatalog> fresh;
+    try {
+        fresh = ProfileCatalog::load(basePath);
+    } catch (const exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+
+    publish(move(fresh));
+    return true;
+}
+
+void ProfileRepository::publish(shared_ptr<const ProfileCatalog> next) {
+#if __cpp_lib_atomic_shared_ptr >= 201711L
+    catalog.store(move(next), memory_order_release);
+#else
+    atomic_store_explicit(&catalog, move(next), memory_order_release);
+#endif
+}
 
-YAML::Node ProfileRepository::getComponentProfile(const string& name) {
-    if (compCache.count(name))
-        return compCache[name];
+string ProfileRepository::defaultPath() {
+    if (const char* env = getenv("SIMRUN_PROFILES"))
+        return env;
 
-    auto node = YAML::LoadFile(basePath + "/components/" + name + ".yaml");
-    compCache[name] = node;
-    return node;
+    error_code ec;
+    auto exe = fs::read_symlink("/proc/self/exe", ec);
+    if (!ec) {
+        auto candidate = exe.parent_path() / ".." / "profiles";
+        if (fs::is_directory(candidate, ec)) return candidate.lexically_normal().string();
+    }
+    return "../profiles";
 }
 
-YAML::Node ProfileRepository::getNetworkProfile(const string& name) {
-    if (netCache.count(name))
-        return netCache[name];
+// ---------- Hot reload ----------
+
+bool ProfileRepository::watch(string* error) {
+#ifdef __linux__
+    if (watcher.joinable()) return true;
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        if (error) *error = string("inotify_init1: ") + strerror(errno);
+        return false;
+    }
+
+    // A directory that cannot be watched is reported, but the others still reload
+    const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE;
+    int watched = 0;
+    for (const char* sub : {"components", "networks"}) {
+        fs::path dir = fs::path(basePath) / sub;
+        if (inotify_add_watch(fd, dir.c_str(), mask) >= 0) ++watched;
+        else cerr << "cannot watch " << dir.string() << " for profile changes: " << strerror(errno) << "\n";
+    }
+    if (watched == 0) {
+        close(fd);
+        if (error) *error = "no profile directory under " + basePath + " could be watched";
+        return false;
+    }
+
+    stopFd = eventfd(0, EFD_CLOEXEC);
+    if (stopFd < 0) {
+        close(fd);
+        if (error) *error = string("eventfd: ") + strerror(errno);
+        return false;
+    }
+    watcher = thread(&ProfileRepository::watchLoop, this, fd);
+    return true;
+#else
+    if (error) *error = "hot reload needs inotify (Linux)";
+    return false;
+#endif
+}
+
+void ProfileRepository::watchLoop(int inotifyFd) {
+#ifdef __linux__
+    alignas(inotify_event) char buf[4096];
+
+    while (true) {
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents) break;
+
+        // Editors write in several steps: drain, then wait for a quiet period
+        do {
+            while (read(inotifyFd, buf, sizeof(buf)) > 0) {}
+        } while (poll(fds, 1, 100) > 0);
 
-    auto node = YAML::LoadFile(basePath + "/networks/" + name + ".yaml");
-    netCache[name] = node;
-    return node;
+        string err;
+        if (!reload(&err))
+            cerr << "profile reload failed, keeping previous catalog: " << err << "\n";
+    }
+    close(inotifyFd);
+#else
+    (void)inotifyFd;
+#endif
 }
@@ -1,19 +1,63 @@
 #pragma once
-#include <yaml-cpp/yaml.h>
+#include "profile_catalog.h"
+#include <atomic>
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <thread>
 
 using namespace std;
 
+/*
+ * Owns the process-wide profile catalog.
+ *
+ * Profiles are loaded once at startup; readers take a shared reference to the
+ * current catalog with one atomic load. A reload (manual or triggered by the
+ * inotify watcher) builds a complete new catalog and publishes it with one
+ * atomic store. A superseded catalog is freed when the last request still
+ * reading it drops its reference, so hot reloads do not accumulate catalogs.
+ *
+ * The load and store are std::atomic<shared_ptr> where the library has it and
+ * the C++11 atomic_load/atomic_store overloads otherwise. Neither is lock-free
+ * in libstdc++ (a lock bit, or a mutex from a small pool); the critical section
+ * is one reference count update, and readers never wait for a reload to parse.
+ */
 class ProfileRepository {
 public:
-    ProfileRepository(const string& basePath);
+    explicit ProfileRepository(const string& basePath);
+    ~ProfileRepository();
 
-    YAML::Node getComponentProfile(const string& name);
-    YAML::Node getNetworkProfile(const string& name);
+    ProfileRepository(const ProfileRepository&) = delete;
+    ProfileRepository& operator=(const ProfileRepository&) = delete;
+
+    // Keep the returned pointer for as long as the catalog is used
+    shared_ptr<const ProfileCatalog> current() const {
+#if __cpp_lib_atomic_shared_ptr >= 201711L
+        return catalog.load(memory_order_acquire);
+#else
+        return atomic_load_explicit(&catalog, memory_order_acquire);
+#endif
+    }
+
+    // Re-reads every profile; on failure the current catalog stays in place
+    bool reload(string* error = nullptr);
+
+    // Reloads automatically when files under basePath change (Linux/inotify);
+    // false if no directory could be watched, and hot reload stays off
+    bool watch(string* error = nullptr);
+
+    // $SIMRUN_PROFILES, else <executable dir>/../profiles, else ../profiles
+    static string defaultPath();
 
 private:
     string basePath;
-    unordered_map<string, YAML::Node> compCache;
-    unordered_map<string, YAML::Node> netCache;
+#if __cpp_lib_atomic_shared_ptr >= 201711L
+    atomic<shared_ptr<const ProfileCatalog>> catalog;
+#else
+    shared_ptr<const ProfileCatalog> catalog;          // only accessed through atomic_load/store
+#endif
+    void publish(shared_ptr<const ProfileCatalog> next);
+
+    thread watcher;
+    int stopFd = -1;
+    void watchLoop(int inotifyFd);
 };
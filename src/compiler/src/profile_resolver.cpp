@@ -1,71 +1,79 @@
 #include "profile_resolver.h"
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 using namespace std;
 
-ProfileResolver::ProfileResolver(ProfileRepository& repo)
-    : repo(repo) {}
+ProfileResolver::ProfileResolver(const ProfileCatalog& catalog)
+    : catalog(catalog) {}
 
 /*
- * Safely convert YAML scalar → IR Value
- * Order matters: int → double → bool → string
+ * Resolved params = the profile's default block, copied as-is, with the user's
+ * overrides patched in. Both runs are sorted by key, so an override is a binary
+ * search; keys the profile does not define are appended and merged in once.
  */
-Value ProfileResolver::parseYamlValue(const YAML::Node& node) {
-
-    if (!node.IsScalar()) {
-        throw runtime_error("Only scalar YAML values are supported");
+static ParamRange applyProfile(vector<ParamSlot>& params, const Profile& profile, ParamRange user) {
+    ParamRange out;
+    out.begin = static_cast<uint32_t>(params.size());
+
+    // Capacity was reserved up front, so these pointers stay valid
+    params.insert(params.end(), profile.defaults.begin(), profile.defaults.end());
+    const ParamSlot* overrides = params.data() + user.begin;
+
+    size_t defaults = profile.defaults.size();
+    for (uint32_t i = 0; i < user.count; ++i) {
+        const ParamSlot& o = overrides[i];
+        ParamSlot* block = params.data() + out.begin;
+        if (ParamSlot* hit = findParam(block, defaults, o.key))
+            *hit = o;
+        else
+            params.push_back(o);
     }
 
-    // Try int
-    try {
-        return node.as<int>();
-    } catch (...) {}
-
-    // Try double
-    try {
-        return node.as<double>();
-    } catch (...) {}
-
-    // Try bool
-    try {
-        return node.as<bool>();
-    } catch (...) {}
-
-    // Fallback: string
-    return node.as<string>();
+    out.count = static_cast<uint32_t>(params.size()) - out.begin;
+    if (out.count > defaults) {
+        auto first = params.begin() + out.begin;
+        inplace_merge(first, first + defaults, params.end(),
+                      [](const ParamSlot& a, const ParamSlot& b) { return a.key < b.key; });
+    }
+    return out;
 }
 
 void ProfileResolver::resolve(IR& ir) {
 
+    // Look every profile up first so the slot array is grown exactly once
+    vector<const Profile*> componentProfiles, linkProfiles;
+    componentProfiles.reserve(ir.components.size());
+    linkProfiles.reserve(ir.links.size());
+    size_t slots = ir.params.size();
+
     // ---------- COMPONENT PROFILES ----------
     for (auto& comp : ir.components) {
-
-        YAML::Node profile = repo.getComponentProfile(comp.implementation);
-
-        // Apply defaults from YAML
-        if (profile["defaults"]) {
-            for (auto it : profile["defaults"]) {
-                string key = it.first.as<string>();
-                comp.resolved_params[key] = parseYamlValue(it.second);
-            }
-        }
-
-        // Override with user-provided parameters
-        for (auto& [key, value] : comp.user_params) {
-            comp.resolved_params[key] = value;
-        }
+        const Profile* profile = catalog.component(comp.implementation);
+        if (!profile)
+            throw runtime_error("Unknown component profile \"" + string(comp.implementation) + "\"");
+        componentProfiles.push_back(profile);
+        slots += profile->defaults.size() + comp.user_params.count;
     }
 
     // ---------- NETWORK PROFILES ----------
     for (auto& link : ir.links) {
+        const Profile* profile = catalog.network(link.type);
+        if (!profile)
+            throw runtime_error("Unknown network profile \"" + string(link.type) + "\"");
+        linkProfiles.push_back(profile);
+        slots += profile->defaults.size() + link.user_params.count;
+    }
 
-        YAML::Node profile = repo.getNetworkProfile(link.type);
+    ir.params.reserve(slots);
 
-        if (profile["defaults"]) {
-            for (auto it : profile["defaults"]) {
-                string key = it.first.as<string>();
-                link.resolved_params[key] = parseYamlValue(it.second);
-            }
-        }
+    for (size_t i = 0; i < ir.components.size(); ++i) {
+        auto& comp = ir.components[i];
+        comp.resolved_params = applyProfile(ir.params, *componentProfiles[i], comp.user_params);
+    }
+    for (size_t i = 0; i < ir.links.size(); ++i) {
+        auto& link = ir.links[i];
+        link.resolved_params = applyProfile(ir.params, *linkProfiles[i], link.user_params);
     }
 }
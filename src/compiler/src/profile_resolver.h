@@ -1,20 +1,17 @@
 #pragma once
 
 #include "ir.h"
-#include "profile_repository.h"
-#include <yaml-cpp/yaml.h>
+#include "profile_catalog.h"
 
 using namespace std;
 
 class ProfileResolver {
 public:
-    ProfileResolver(ProfileRepository& repo);
+    ProfileResolver(const ProfileCatalog& catalog);
 
+    // Throws runtime_error when a component or link names an unknown profile
     void resolve(IR& ir);
 
 private:
-    ProfileRepository& repo;
-
-    // Converts a YAML scalar into IR Value safely
-    Value parseYamlValue(const YAML::Node& node);
+    const ProfileCatalog& catalog;
 };
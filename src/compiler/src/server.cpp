@@ -1,17 +1,69 @@
 #include <crow.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
+#include "compile_cache.h"
 #include "compiler_driver.h"
+#include "job_manager.h"
+#include "json_writer.h"
+#include "profile_repository.h"
 
 using namespace std;
 
+// A bare ?flag or flag=1/true/yes/on; flag=0/false/no/off (or anything else) is off
+static bool flagParam(const crow::request& req, const char* name) {
+    const char* value = req.url_params.get(name);
+    if (!value) return false;
+    string v(value);
+    return v.empty() || v == "1" || v == "true" || v == "yes" || v == "on";
+}
+
+// ?format=binary returns the simulator's binary IR instead of JSON,
+// ?compact=1 drops the JSON indentation
+static CompileOptions compileOptions(const crow::request& req) {
+    const char* fmt = req.url_params.get("format");
+
+    CompileOptions options;
+    options.format = fmt && string(fmt) == "binary" ? OutputFormat::BINARY : OutputFormat::JSON;
+    options.compact = flagParam(req, "compact");
+    return options;
+}
+
+static crow::response jsonResponse(int code, const string& body) {
+    crow::response res(code, body);
+    res.set_header("Content-Type", "application/json");
+    return res;
+}
+
 int main() {
+    // Loaded once; every request takes the current catalog with one atomic load
+    ProfileRepository profiles(ProfileRepository::defaultPath());
+    string watchError;
+    if (!profiles.watch(&watchError))
+        cerr << "profile hot reload disabled: " << watchError << "\n";
+
+    // Diagrams are resubmitted on nearly every edit; identical ones skip the pipeline
+    CompileCache cache(CompileCache::defaultCapacity());
+
+    // Long compiles run here, never on Crow's I/O threads. The compiler does
+    // not link the simulator and installs no simulate stage, so every job is
+    // a compile in the requested format.
+    JobManager jobs(profiles, cache, JobManager::defaultLimits());
+
     crow::SimpleApp app;
 
     CROW_ROUTE(app, "/compile").methods("POST"_method)
-    ([](const crow::request& req) {
+    ([&profiles, &cache](const crow::request& req) {
+
+        CompileOptions options = compileOptions(req);
+        bool binary = options.format == OutputFormat::BINARY;
 
         bool ok = false;
-        string output = compileIR(req.body, ok);
+        string output = compileIR(req.body, *profiles.current(), ok, options, cache);
 
         if (!ok) {
             return crow::response(400, output);
@@ -19,10 +71,185 @@ int main() {
 
         crow::response res;
         res.code = 200;
-        res.set_header("Content-Type", "application/json");
-        res.body = output;
+        res.set_header("Content-Type", binary ? "application/octet-stream" : "application/json");
+        res.body = move(output);
+        return res;
+    });
+
+    CROW_ROUTE(app, "/compile/stats")
+    ([&cache, &jobs]() {
+        CompileCache::Stats s = cache.stats();
+        JobManager::Stats j = jobs.stats();
+
+        string body;
+        JsonWriter w(body, true);
+        w.beginObject();
+        w.key("raw_hits");       w.integer(s.rawHits);
+        w.key("ir_hits");        w.integer(s.irHits);
+        w.key("misses");         w.integer(s.misses);
+        w.key("evictions");      w.integer(s.evictions);
+        w.key("entries");        w.integer(s.entries);
+        w.key("bytes");          w.integer(s.bytes);
+        w.key("capacity_bytes"); w.integer(s.capacityBytes);
+        w.key("jobs");
+        w.beginObject();
+        w.key("workers");        w.integer(j.workers);
+        w.key("queued");         w.integer(j.queued);
+        w.key("running");        w.integer(j.running);
+        w.key("retained");       w.integer(j.retained);
+        w.key("submitted");      w.integer(j.submitted);
+        w.key("rejected");       w.integer(j.rejected);
+        w.key("succeeded");      w.integer(j.succeeded);
+        w.key("failed");         w.integer(j.failed);
+        w.key("cancelled");      w.integer(j.cancelled);
+        w.key("expired");        w.integer(j.expired);
+        w.endObject();
+        w.endObject();
+
+        return jsonResponse(200, body);
+    });
+
+    // Asynchronous jobs: submit, then poll or subscribe. ?deadline_ms= bounds
+    // the whole job, queueing included.
+    CROW_ROUTE(app, "/jobs").methods("POST"_method)
+    ([&jobs](const crow::request& req) {
+        JobManager::Request request;
+        request.input = req.body;
+        request.options = compileOptions(req);
+        if (const char* deadline = req.url_params.get("deadline_ms"))
+            request.deadline = chrono::milliseconds(strtoll(deadline, nullptr, 10));
+
+        string id;
+        switch (jobs.submit(move(request), id)) {
+            case JobManager::Admission::ACCEPTED: break;
+            case JobManager::Admission::TOO_LARGE:
+                return crow::response(413, "Request too large");
+            case JobManager::Admission::QUEUE_FULL:
+            case JobManager::Admission::SHUTTING_DOWN: {
+                crow::response res(503, "Job queue is full");
+                res.set_header("Retry-After", "1");
+                return res;
+            }
+        }
+
+        string body;
+        JsonWriter w(body, true);
+        w.beginObject();
+        w.key("id"); w.text(id);
+        w.endObject();
+        return jsonResponse(202, body);
+    });
+
+    CROW_ROUTE(app, "/jobs/<string>").methods("GET"_method, "DELETE"_method)
+    ([&jobs](const crow::request& req, const string& id) {
+        if (req.method == "DELETE"_method) {
+            return jobs.cancel(id) ? crow::response(202) : crow::response(404);
+        }
+
+        JobStatus s;
+        if (!jobs.status(id, s)) return crow::response(404);
+
+        string body;
+        JsonWriter w(body, true);
+        w.beginObject();
+        writeJobEvent(w, s.last);
+        w.key("queued_ms");   w.integer(s.queuedFor.count());
+        w.key("running_ms");  w.integer(s.ranFor.count());
+        w.key("deadline_ms"); w.integer(s.deadlineIn.count());
+        w.endObject();
+        return jsonResponse(200, body);
+    });
+
+    // Same status codes as /compile once the job is done; 409 before that
+    CROW_ROUTE(app, "/jobs/<string>/result")
+    ([&jobs](const string& id) {
+        JobStatus s;
+        if (!jobs.status(id, s)) return crow::response(404);
+
+        shared_ptr<const JobResult> result = jobs.result(id);
+        if (!result) return crow::response(409, "Job has not finished");
+
+        crow::response res(result->ok ? 200 : 400, result->output);
+        res.set_header("Content-Type", result->contentType);
         return res;
     });
 
+    // Progress stream: the client sends job ids, one per message, and gets
+    // every event of those jobs up to the final one as JSON text frames.
+    // Compile jobs report stage changes only; "metrics" appears once a
+    // simulate stage reports interim values through JobContext::progress.
+    // Each connection keeps the subscriptions of its unfinished jobs. A
+    // connection is only written to while it is registered here, under
+    // socketsMutex, so a late event cannot reach one that has closed.
+    mutex socketsMutex;
+    unordered_map<crow::websocket::connection*, vector<pair<string, uint64_t>>> sockets;
+
+    CROW_WEBSOCKET_ROUTE(app, "/events")
+    .onopen([&](crow::websocket::connection& conn) {
+        lock_guard<mutex> lock(socketsMutex);
+        sockets[&conn];
+    })
+    .onclose([&](crow::websocket::connection& conn, const string&) {
+        vector<pair<string, uint64_t>> subscribed;
+        {
+            lock_guard<mutex> lock(socketsMutex);
+            auto it = sockets.find(&conn);
+            if (it == sockets.end()) return;
+            subscribed = move(it->second);
+            sockets.erase(it);
+        }
+        for (const auto& [jobId, token] : subscribed) jobs.unsubscribe(token);
+    })
+    .onmessage([&](crow::websocket::connection& conn, const string& data, bool) {
+        // Runs with the subscription's delivery lock held, never with socketsMutex
+        uint64_t token = jobs.subscribe(data, [&](const JobEvent& e) {
+            string message;
+            JsonWriter w(message, true);
+            w.beginObject();
+            writeJobEvent(w, e);
+            w.endObject();
+
+            lock_guard<mutex> lock(socketsMutex);
+            auto it = sockets.find(&conn);
+            if (it == sockets.end()) return;
+            conn.send_text(message);
+
+            // Nothing follows a final event, so the job's subscriptions are done
+            if (isFinal(e.state)) {
+                auto& subscribed = it->second;
+                subscribed.erase(remove_if(subscribed.begin(), subscribed.end(),
+                                           [&](const pair<string, uint64_t>& s) { return s.first == e.jobId; }),
+                                 subscribed.end());
+            }
+        });
+
+        if (!token) {
+            string message;
+            JsonWriter w(message, true);
+            w.beginObject();
+            w.key("id");    w.text(data);
+            w.key("error"); w.text("unknown job");
+            w.endObject();
+            conn.send_text(message);
+            return;
+        }
+
+        // A job that is already final has delivered its last event; one that
+        // is not will remove the token again on its final event, which cannot
+        // be delivered while socketsMutex is held
+        {
+            lock_guard<mutex> lock(socketsMutex);
+            auto it = sockets.find(&conn);
+            if (it != sockets.end()) {
+                JobStatus status;
+                if (jobs.status(data, status) && !isFinal(status.last.state))
+                    it->second.emplace_back(data, token);
+                return;
+            }
+        }
+        // Closed while subscribing
+        jobs.unsubscribe(token);
+    });
+
     app.port(8080).multithreaded().run();
 }
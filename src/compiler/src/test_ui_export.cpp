@@ -0,0 +1,71 @@
+#include "compiler_driver.h"
+#include "ir_parser.h"
+#include "profile_repository.h"
+#include "validator.h"
+#include <iostream>
+
+using namespace std;
+
+// What the editor's CanvasHeader exports for api -> cache -> database with
+// every parameter left at its UI default (src/ui/src/types/simulation.ts)
+static const char* const UI_EXPORT = R"({
+  "components": [
+    {"id": "api-1", "type": "api", "profile": "rest", "position": {"x": 0, "y": 0}, "label": "REST API",
+     "parameters": {"max_concurrency": 200, "processing_latency_ms": 50, "timeout_ms": 5000, "retry_count": 3}},
+    {"id": "cache-1", "type": "cache", "profile": "redis", "position": {"x": 200, "y": 0}, "label": "Redis",
+     "parameters": {"max_concurrency": 1000, "hit_rate": 0.85, "eviction_policy": "lru"}},
+    {"id": "db-1", "type": "database", "profile": "postgresql", "position": {"x": 400, "y": 0}, "label": "PostgreSQL",
+     "parameters": {"max_concurrency": 100, "base_latency_ms": 10, "disk_fail_prob": 0.001, "read_write_ratio": 0.8}}
+  ],
+  "links": [
+    {"id": "e1", "source": "api-1", "target": "cache-1", "parameters": {"latency_ms": 5, "loss_prob": 0}},
+    {"id": "e2", "source": "cache-1", "target": "db-1", "parameters": {"latency_ms": 5, "loss_prob": 0}}
+  ],
+  "routes": [{"id": "r1", "name": "Main", "entryNodeId": "api-1", "path": ["api-1", "cache-1", "db-1"], "weight": 100}],
+  "workload": {"type": "steady", "base_rps": 100, "duration_ms": 60000, "spikes": [],
+               "distribution": "constant", "distribution_params": {}},
+  "faults": [],
+  "metadata": {"version": "1.0.0", "name": "Untitled Project", "createdAt": "2024-01-01T00:00:00.000Z"}
+})";
+
+int main() {
+    int failures = 0;
+    auto check = [&](bool condition, const string& what) {
+        if (!condition) {
+            cerr << "FAIL: " << what << "\n";
+            ++failures;
+        }
+    };
+
+    // The UI's own vocabulary and lower-case enums are accepted as they are
+    simrun::Validator validator = simrun::Validator::createDefault();
+    IR ir = parseIR(UI_EXPORT);
+    for (auto& issue : validator.validate(ir).issues) {
+        check(issue.code != simrun::IssueCode::UNKNOWN_NUMERIC_KEY &&
+              issue.code != simrun::IssueCode::UNKNOWN_STRING_KEY &&
+              issue.code != simrun::IssueCode::UNSUPPORTED_STRING_VALUE,
+              "unexpected issue: " + issue.message());
+    }
+
+    ProfileRepository profiles(ProfileRepository::defaultPath());
+    bool ok = false;
+    string output = compileIR(UI_EXPORT, *profiles.current(), ok);
+    check(ok, "UI export does not compile:\n" + output);
+
+    // A value outside the enum is still an error, and lists the options in order
+    string bad = UI_EXPORT;
+    bad.replace(bad.find("\"lru\""), 5, "\"mru\"");
+    IR badIR = parseIR(bad);
+    bool reported = false;
+    for (auto& issue : validator.validate(badIR).issues) {
+        if (issue.code != simrun::IssueCode::UNSUPPORTED_STRING_VALUE) continue;
+        reported = true;
+        check(issue.message().find("Allowed: \"FIFO\" \"LFU\" \"LRU\" \"RANDOM\"") != string::npos,
+              "options not sorted: " + issue.message());
+    }
+    check(reported, "eviction_policy \"mru\" was accepted");
+
+    if (failures) return 1;
+    cout << "ok\n";
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "validator.h"
+#include "graph_index.h"
 
 #include <unordered_map>
 #include <unordered_set>
@@ -6,27 +7,305 @@
 #include <algorithm>
 #include <sstream>
 #include <iostream>
+#include <cctype>
 #include <cmath>
 #include <limits>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace simrun {
 
 // ============================================================
-// Shared adjacency helpers used by multiple modules
+// Issue codes, rendering and result accumulation
 // ============================================================
 
-using AdjSet = std::unordered_map<std::string, std::unordered_set<std::string>>;
+const char* issueCodeStr(IssueCode c) {
+    static const char* const names[] = {
+        "EMPTY_COMPONENT_ID", "ISOLATED_COMPONENT", "EMPTY_CONNECTION_ID", "DUPLICATE_CONNECTION_ID",
+        "MISSING_SOURCE", "MISSING_TARGET", "SELF_LOOP",
+        "NO_CONFIG_SCHEMA", "MISSING_NUMERIC_PARAM", "NON_FINITE_PARAM", "PARAM_NOT_ABOVE_MIN",
+        "PARAM_OUT_OF_RANGE", "PARAM_CHECK_FAILED", "MISSING_STRING_PARAM", "EMPTY_STRING_PARAM",
+        "UNSUPPORTED_STRING_VALUE", "UNKNOWN_NUMERIC_KEY", "UNKNOWN_STRING_KEY",
+        "DATABASE_OUTBOUND", "CACHE_BACKEND_COUNT", "LB_NO_BACKENDS", "LB_TO_DATABASE",
+        "UNEXPECTED_INGRESS", "NO_ENTRY_POINT", "MULTIPLE_ENTRY_POINTS",
+        "CYCLE", "UNREACHABLE", "DEEP_CHAIN",
+        "ZERO_CAPACITY", "NEGATIVE_QUEUE_SIZE", "NEGATIVE_THROUGHPUT", "CACHE_NEVER_HITS",
+        "CACHE_ALWAYS_HITS", "ALWAYS_FAILS", "HIGH_LATENCY", "DATABASE_NO_REPLICAS",
+        "SERVICE_DATABASE_NO_CACHE", "SERVICE_SPOF", "LB_SINGLE_BACKEND", "SHARED_DATABASE",
+        "MUTUAL_DEPENDENCY", "NO_CACHE", "NO_LOAD_BALANCER",
+        "CUSTOM",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<std::size_t>(IssueCode::CUSTOM) + 1,
+                  "issueCodeStr out of sync with IssueCode");
+    return names[static_cast<std::size_t>(c)];
+}
 
-static void buildAdj(const DiagramIR& ir, AdjSet& out, AdjSet& in) {
-    for (auto& [id, _] : ir.components) { out[id]; in[id]; }
-    for (auto& c : ir.connections) {
-        if (ir.components.count(c.from_component_id) && ir.components.count(c.to_component_id)) {
-            out[c.from_component_id].insert(c.to_component_id);
-            in[c.to_component_id].insert(c.from_component_id);
+std::string ValidationIssue::message() const {
+    static const std::string none;
+    auto C = [&](std::size_t i) -> const std::string& {
+        return i < related_components.size() ? related_components[i] : none;
+    };
+    auto K = [&](std::size_t i) -> const std::string& {
+        return i < related_connections.size() ? related_connections[i] : none;
+    };
+    auto P = [&](std::size_t i) -> const std::string& { return i < params.size() ? params[i].text : none; };
+    auto N = [&](std::size_t i) { return i < params.size() ? params[i].number : 0.0; };
+    auto F = [&](std::size_t i) { return std::to_string(N(i)); };
+    auto I = [&](std::size_t i) { return std::to_string(static_cast<long long>(N(i))); };
+    auto Q = [&](const std::string& s) { return "\"" + s + "\""; };
+
+    // Quoted related_components[from..], noting any the caps cut off from `total`
+    auto list = [&](std::size_t from, std::size_t total) {
+        std::string out;
+        for (std::size_t i = from; i < related_components.size(); ++i) out += Q(related_components[i]) + " ";
+        std::size_t shown = related_components.size() > from ? related_components.size() - from : 0;
+        if (total > shown) out += "… and " + std::to_string(total - shown) + " more ";
+        return out;
+    };
+    auto count = [&](std::size_t i) { return static_cast<std::size_t>(N(i)); };
+
+    switch (code) {
+        case IssueCode::EMPTY_COMPONENT_ID:
+            return "A component has an empty ID.";
+        case IssueCode::ISOLATED_COMPONENT:
+            return "Component " + Q(C(0)) + " (" + P(0)
+                + ") is completely isolated — no connections. It has no effect on simulation.";
+        case IssueCode::EMPTY_CONNECTION_ID:
+            return "A connection has an empty ID.";
+        case IssueCode::DUPLICATE_CONNECTION_ID:
+            return "Duplicate connection ID " + Q(K(0)) + ".";
+        case IssueCode::MISSING_SOURCE:
+            return "Connection " + Q(K(0)) + " references non-existent source component " + Q(C(0)) + ".";
+        case IssueCode::MISSING_TARGET:
+            return "Connection " + Q(K(0)) + " references non-existent target component " + Q(C(0)) + ".";
+        case IssueCode::SELF_LOOP:
+            return "Connection " + Q(K(0)) + " is a self-loop on component " + Q(C(0))
+                + ". Self-loops are not permitted.";
+
+        case IssueCode::NO_CONFIG_SCHEMA:
+            return "No config schema for type " + Q(P(0)) + " on component " + Q(C(0))
+                + ". Skipping config validation.";
+        case IssueCode::MISSING_NUMERIC_PARAM:
+            return "Component " + Q(C(0)) + " missing required numeric param " + Q(P(0)) + ".";
+        case IssueCode::NON_FINITE_PARAM:
+            return "Component " + Q(C(0)) + ": param " + Q(P(0)) + " is non-finite.";
+        case IssueCode::PARAM_NOT_ABOVE_MIN:
+            return "Component " + Q(C(0)) + ": param " + Q(P(0)) + " must be > " + F(1) + " but is " + F(2) + ".";
+        case IssueCode::PARAM_OUT_OF_RANGE:
+            return "Component " + Q(C(0)) + ": param " + Q(P(0)) + " = " + F(1)
+                + " is outside [" + F(2) + ", " + F(3) + "].";
+        case IssueCode::PARAM_CHECK_FAILED:
+            return "Component " + Q(C(0)) + ": param " + Q(P(0)) + ": " + P(1);
+        case IssueCode::MISSING_STRING_PARAM:
+            return "Component " + Q(C(0)) + " missing required string param " + Q(P(0)) + ".";
+        case IssueCode::EMPTY_STRING_PARAM:
+            return "Component " + Q(C(0)) + ": string param " + Q(P(0)) + " must not be empty.";
+        case IssueCode::UNSUPPORTED_STRING_VALUE:
+            return "Component " + Q(C(0)) + ": param " + Q(P(0)) + " has unsupported value " + Q(P(1))
+                + ". Allowed: " + P(2);
+        case IssueCode::UNKNOWN_NUMERIC_KEY:
+            return "Component " + Q(C(0)) + " has unrecognised numeric key " + Q(P(0))
+                + ". It will be ignored. Check for typos.";
+        case IssueCode::UNKNOWN_STRING_KEY:
+            return "Component " + Q(C(0)) + " has unrecognised string key " + Q(P(0))
+                + ". It will be ignored. Check for typos.";
+
+        case IssueCode::DATABASE_OUTBOUND:
+            return "DATABASE " + Q(C(0)) + " has " + I(0) + " outgoing connection(s) to: " + list(1, count(0))
+                + "— databases must not initiate outbound requests.";
+        case IssueCode::CACHE_BACKEND_COUNT:
+            return "CACHE " + Q(C(0)) + " must have exactly one backend but has " + I(0)
+                + ". A cache must point to exactly one data source.";
+        case IssueCode::LB_NO_BACKENDS:
+            return "LOAD_BALANCER " + Q(C(0)) + " has no backend connections. "
+                   "It must route traffic to at least one backend.";
+        case IssueCode::LB_TO_DATABASE:
+            return "LOAD_BALANCER " + Q(C(0)) + " routes directly to DATABASE " + Q(C(1))
+                + ". LBs typically front services, not databases.";
+        case IssueCode::UNEXPECTED_INGRESS:
+            return P(0) + " component " + Q(C(0))
+                + " has outgoing connections but no incoming — unexpected ingress type.";
+        case IssueCode::NO_ENTRY_POINT:
+            return "The diagram has no entry point. At least one non-DATABASE component "
+                   "must have no incoming connections to serve as request ingress.";
+        case IssueCode::MULTIPLE_ENTRY_POINTS:
+            return "The diagram has " + I(0) + " entry points: " + list(0, count(0))
+                + "— multiple ingress points may indicate a missing top-level load balancer.";
+
+        case IssueCode::CYCLE:
+            return "Cycle detected among " + I(0) + " component(s): " + list(0, count(0))
+                + "— cycles cause infinite request loops during simulation.";
+        case IssueCode::UNREACHABLE:
+            return "Component " + Q(C(0)) + " (" + P(0)
+                + ") is unreachable from all entry points — it will never process requests.";
+        case IssueCode::DEEP_CHAIN:
+            return "Longest request chain from " + Q(C(0)) + " has depth " + I(0) + " (threshold: " + I(1)
+                + "). Deep chains increase tail latency. Consider adding caching or flattening.";
+
+        case IssueCode::ZERO_CAPACITY:
+            return "Component " + Q(C(0)) + " has capacity = 0. "
+                   "It will never process requests. Set a positive capacity or remove it.";
+        case IssueCode::NEGATIVE_QUEUE_SIZE:
+            return "Component " + Q(C(0)) + " has negative queue_size (" + F(0) + ").";
+        case IssueCode::NEGATIVE_THROUGHPUT:
+            return "Component " + Q(C(0)) + " has negative throughput (" + F(0) + ").";
+        case IssueCode::CACHE_NEVER_HITS:
+            return "CACHE " + Q(C(0)) + " has hit_rate = 0 — the cache never serves a hit. "
+                   "All requests fall through to the backend.";
+        case IssueCode::CACHE_ALWAYS_HITS:
+            return "CACHE " + Q(C(0)) + " has hit_rate = 1 — the backend will never receive "
+                   "requests and is effectively dead code.";
+        case IssueCode::ALWAYS_FAILS:
+            return "Component " + Q(C(0)) + " has error_rate = 1.0 (always fails). "
+                   "All downstream components will be starved of successful requests.";
+        case IssueCode::HIGH_LATENCY:
+            return "SERVICE " + Q(C(0)) + " has very high latency (" + std::to_string(static_cast<int>(N(0)))
+                + " ms). This will dominate tail latency in any chain through it.";
+        case IssueCode::DATABASE_NO_REPLICAS:
+            return "DATABASE " + Q(C(0)) + " has replication_factor = 1 (no replicas). "
+                   "This is a single point of failure. Consider replication_factor >= 2.";
+
+        case IssueCode::SERVICE_DATABASE_NO_CACHE:
+            return "SERVICE " + Q(C(0)) + " connects directly to DATABASE " + Q(C(1))
+                + " without a CACHE. Every read hits the database.";
+        case IssueCode::SERVICE_SPOF:
+            return "SERVICE " + Q(C(0)) + " has instances = 1 and no upstream LOAD_BALANCER. "
+                   "This is a single point of failure (SPOF).";
+        case IssueCode::LB_SINGLE_BACKEND:
+            return "LOAD_BALANCER " + Q(C(0)) + " has only one backend — "
+                   "no load distribution benefit. Add backends or remove the LB.";
+        case IssueCode::SHARED_DATABASE:
+            return "DATABASE " + Q(C(0)) + " is called directly by " + I(0) + " SERVICE(s): " + list(1, count(0))
+                + "— shared-database anti-pattern. Route via a single service or use separate DBs.";
+        case IssueCode::MUTUAL_DEPENDENCY:
+            return "SERVICE " + Q(C(0)) + " and SERVICE " + Q(C(1)) + " call each other "
+                   "(mutual dependency). This tight coupling risks cascading failures.";
+        case IssueCode::NO_CACHE:
+            return "The system has no CACHE components. All reads hit the database directly.";
+        case IssueCode::NO_LOAD_BALANCER:
+            return "The system has " + I(0) + " SERVICE components but no LOAD_BALANCER. "
+                   "Horizontal scaling will have no effect without one.";
+
+        case IssueCode::CUSTOM:
+            return P(0);
+    }
+    return P(0);
+}
+
+void ValidationResult::add(ValidationIssue issue, const ValidationLimits& limits) {
+    if (issue.severity == Severity::ERROR) canProceed = false;
+
+    RuleSummary* rule = nullptr;
+    for (auto& r : rules)
+        if (r.code == issue.code && r.severity == issue.severity && r.source_module == issue.source_module) {
+            rule = &r;
+            break;
         }
+    if (!rule) {
+        rules.push_back({issue.code, issue.severity, issue.source_module});
+        rule = &rules.back();
+    }
+
+    ++rule->total;
+    if (rule->reported >= limits.perRule) return;
+    ++rule->reported;
+
+    // Keep at least the subject and one listed entity
+    std::size_t keep = std::max<std::size_t>(limits.relatedPerIssue, 2);
+    if (issue.related_components.size() > keep) {
+        issue.omitted_components += issue.related_components.size() - keep;
+        issue.related_components.resize(keep);
+    }
+    issues.push_back(std::move(issue));
+}
+
+std::optional<double> ComponentView::num(ParamKey key) const {
+    const ParamSlot* p = ir.param(component.user_params, key);
+    if (!p) return std::nullopt;
+    switch (p->type) {
+        case ParamType::INT:    return static_cast<double>(p->i);
+        case ParamType::DOUBLE: return p->d;
+        case ParamType::BOOL:   return p->b ? 1.0 : 0.0;
+        default:                return std::nullopt;
     }
 }
 
+std::optional<std::string_view> ComponentView::str(ParamKey key) const {
+    const ParamSlot* p = ir.param(component.user_params, key);
+    if (!p || p->type != ParamType::STRING) return std::nullopt;
+    return p->text();
+}
+
+// related_components / related_connections from views of the IR
+static std::vector<std::string> idList(std::initializer_list<std::string_view> ids) {
+    return {ids.begin(), ids.end()};
+}
+
+// Parameter keys the built-in rules read, interned once
+namespace {
+struct RuleKeys {
+    ParamKey capacity           = ParamRegistry::intern("capacity");
+    ParamKey queueSize          = ParamRegistry::intern("queue_size");
+    ParamKey throughput         = ParamRegistry::intern("throughput");
+    ParamKey hitRate            = ParamRegistry::intern("hit_rate");
+    ParamKey errorRate          = ParamRegistry::intern("error_rate");
+    ParamKey latency            = ParamRegistry::intern("latency");
+    ParamKey replicationFactor  = ParamRegistry::intern("replication_factor");
+    ParamKey instances          = ParamRegistry::intern("instances");
+};
+}
+
+static const RuleKeys& keys() {
+    static const RuleKeys k;
+    return k;
+}
+
+// ============================================================
+// Batch driver for modules written against the incremental hooks
+// ============================================================
+
+// Builds every ComponentView / ConnectionView and the summary from the shared
+// graph index and feeds them to the module's hooks. Cycle, reachability and
+// depth facts are TopologyValidator's own business, so the views leave them
+// at defaults.
+static std::vector<ValidationIssue> validateWithHooks(const IValidatorModule& m, const DiagramIR& ir,
+                                                      const GraphIndex& g)
+{
+    std::vector<ValidationIssue> issues;
+
+    auto components = [&](GraphIndex::Range r) {
+        std::vector<const Component*> v;
+        v.reserve(r.size());
+        for (auto i : r) v.push_back(&g.component(i));
+        return v;
+    };
+
+    DiagramSummary summary;
+    summary.componentCount = g.size();
+    for (GraphIndex::NodeId i = 0; i < g.size(); ++i) {
+        const Component& comp = g.component(i);
+        ComponentView view{comp.id, comp, ir, components(g.successors(i)), components(g.predecessors(i))};
+        m.checkComponent(view, issues);
+
+        ++summary.typeCounts[static_cast<std::size_t>(comp.type)];
+        if (comp.type != ComponentType::DATABASE && view.predecessors.empty())
+            summary.ingress.emplace_back(comp.id);
+    }
+
+    for (std::size_t k = 0; k < ir.links.size(); ++k) {
+        ConnectionView view{ir.links[k],
+                            g.source(k) != GraphIndex::NONE,
+                            g.target(k) != GraphIndex::NONE,
+                            g.duplicateId(k)};
+        m.checkConnection(view, issues);
+    }
+
+    m.checkSummary(summary, issues);
+    return issues;
+}
+
 // ============================================================
 // StructuralValidator
 // ============================================================
@@ -34,62 +313,48 @@ static void buildAdj(const DiagramIR& ir, AdjSet& out, AdjSet& in) {
 class StructuralValidator : public IValidatorModule {
 public:
     std::string name() const override { return "StructuralValidator"; }
+    bool incremental() const override { return true; }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
+        return validate(ir, GraphIndex(ir));
+    }
+    std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex& g) const override {
+        return validateWithHooks(*this, ir, g);
+    }
 
-        for (auto& [id, comp] : ir.components) {
-            if (id.empty())
-                issues.push_back(ValidationIssue::error("A component has an empty ID.", name()));
-            if (comp.id != id)
-                issues.push_back(ValidationIssue::error(
-                    "Component map key \"" + id + "\" does not match stored id \"" + comp.id + "\".",
-                    name(), {id}));
-        }
+    void checkComponent(const ComponentView& v, std::vector<ValidationIssue>& issues) const override {
+        const Component& comp = v.component;
 
-        std::unordered_set<std::string> seenConn;
-        for (auto& conn : ir.connections) {
-            if (conn.id.empty()) {
-                issues.push_back(ValidationIssue::error("A connection has an empty ID.", name()));
-                continue;
-            }
-            if (!seenConn.insert(conn.id).second)
-                issues.push_back(ValidationIssue::error(
-                    "Duplicate connection ID \"" + conn.id + "\".", name(), {}, {conn.id}));
-
-            if (!ir.components.count(conn.from_component_id))
-                issues.push_back(ValidationIssue::error(
-                    "Connection \"" + conn.id + "\" references non-existent source component \""
-                    + conn.from_component_id + "\".", name(), {conn.from_component_id}, {conn.id}));
-
-            if (!ir.components.count(conn.to_component_id))
-                issues.push_back(ValidationIssue::error(
-                    "Connection \"" + conn.id + "\" references non-existent target component \""
-                    + conn.to_component_id + "\".", name(), {conn.to_component_id}, {conn.id}));
-
-            if (!conn.from_component_id.empty() && conn.from_component_id == conn.to_component_id)
-                issues.push_back(ValidationIssue::error(
-                    "Connection \"" + conn.id + "\" is a self-loop on component \""
-                    + conn.from_component_id + "\". Self-loops are not permitted.",
-                    name(), {conn.from_component_id}, {conn.id}));
-        }
+        if (v.id.empty())
+            issues.push_back(ValidationIssue::error(IssueCode::EMPTY_COMPONENT_ID, name()));
 
-        std::unordered_set<std::string> hasOut, hasIn;
-        for (auto& c : ir.connections) {
-            if (ir.components.count(c.from_component_id) && ir.components.count(c.to_component_id)) {
-                hasOut.insert(c.from_component_id);
-                hasIn.insert(c.to_component_id);
-            }
-        }
-        for (auto& [id, comp] : ir.components) {
-            if (!hasOut.count(id) && !hasIn.count(id))
-                issues.push_back(ValidationIssue::warning(
-                    "Component \"" + id + "\" (" + componentTypeStr(comp.type)
-                    + ") is completely isolated — no connections. It has no effect on simulation.",
-                    name(), {id}));
+        if (v.successors.empty() && v.predecessors.empty())
+            issues.push_back(ValidationIssue::warning(IssueCode::ISOLATED_COMPONENT, name(), idList({v.id}), {},
+                                                      {componentTypeStr(comp.type)}));
+    }
+
+    void checkConnection(const ConnectionView& v, std::vector<ValidationIssue>& issues) const override {
+        const Connection& conn = v.connection;
+
+        if (conn.id.empty()) {
+            issues.push_back(ValidationIssue::error(IssueCode::EMPTY_CONNECTION_ID, name()));
+            return;
         }
+        if (v.duplicate)
+            issues.push_back(ValidationIssue::error(IssueCode::DUPLICATE_CONNECTION_ID, name(),
+                                                    {}, idList({conn.id})));
 
-        return issues;
+        if (!v.sourceExists)
+            issues.push_back(ValidationIssue::error(IssueCode::MISSING_SOURCE, name(),
+                                                    idList({conn.from}), idList({conn.id})));
+
+        if (!v.targetExists)
+            issues.push_back(ValidationIssue::error(IssueCode::MISSING_TARGET, name(),
+                                                    idList({conn.to}), idList({conn.id})));
+
+        if (!conn.from.empty() && conn.from == conn.to)
+            issues.push_back(ValidationIssue::error(IssueCode::SELF_LOOP, name(),
+                                                    idList({conn.from}), idList({conn.id})));
     }
 };
 
@@ -104,14 +369,30 @@ struct NumericParam {
     double maxVal    = std::numeric_limits<double>::max();
     bool   allowZero = true;
     std::function<std::string(double)> customCheck = nullptr;
+    ParamKey param = 0;         // interned `key`, set by buildSchemas
 };
 
 struct StringParam {
     std::string key;
     bool required = false;
-    std::unordered_set<std::string> allowed;
+    std::vector<std::string> allowed;   // upper case, sorted by buildSchemas; matched ignoring case
+    ParamKey param = 0;
 };
 
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i])))
+            return false;
+    return true;
+}
+
+static std::function<std::string(double)> integerCheck(std::string key) {
+    return [key](double v) -> std::string {
+        return v != std::floor(v) ? key + " must be an integer, got " + std::to_string(v) : "";
+    };
+}
+
 struct ComponentSchema {
     std::vector<NumericParam> numeric;
     std::vector<StringParam>  strings;
@@ -120,30 +401,33 @@ struct ComponentSchema {
 static std::unordered_map<ComponentType, ComponentSchema> buildSchemas() {
     std::unordered_map<ComponentType, ComponentSchema> s;
 
+    // Each type also takes the names the UI editor exports (SimulationExport
+    // parameters) and the simulator reads: max_concurrency / max_connections
+    // for capacity, processing_latency_ms / base_latency_ms for latency,
+    // disk_fail_prob for error_rate
     s[ComponentType::SERVICE] = {
         {
-            {"latency",    false, 0.0, 1e9,  true},
-            {"error_rate", false, 0.0, 1.0,  true},
-            {"capacity",   false, 0.0, 1e9,  false,
-                [](double v) -> std::string {
-                    return v != std::floor(v) ? "capacity must be an integer, got " + std::to_string(v) : "";
-                }},
-            {"timeout_ms", false, 0.0, 1e6,  true},
-            {"instances",  false, 1.0, 1e4,  false,
-                [](double v) -> std::string {
-                    return v != std::floor(v) ? "instances must be an integer, got " + std::to_string(v) : "";
-                }},
+            {"latency",               false, 0.0, 1e9,  true},
+            {"processing_latency_ms", false, 0.0, 1e9,  true},
+            {"error_rate",            false, 0.0, 1.0,  true},
+            {"capacity",              false, 0.0, 1e9,  false, integerCheck("capacity")},
+            {"max_concurrency",       false, 0.0, 1e9,  false, integerCheck("max_concurrency")},
+            {"timeout_ms",            false, 0.0, 1e6,  true},
+            {"retry_count",           false, 0.0, 100.0,true,  integerCheck("retry_count")},
+            {"instances",             false, 1.0, 1e4,  false, integerCheck("instances")},
         },
         { {"protocol", false, {"HTTP","GRPC","TCP","UDP"}} }
     };
 
     s[ComponentType::CACHE] = {
         {
-            {"latency",    false, 0.0, 1e9, true},
-            {"error_rate", false, 0.0, 1.0, true},
-            {"capacity",   false, 0.0, 1e9, false},
-            {"ttl_ms",     false, 0.0, std::numeric_limits<double>::max(), true},
-            {"hit_rate",   false, 0.0, 1.0, true},
+            {"latency",         false, 0.0, 1e9, true},
+            {"error_rate",      false, 0.0, 1.0, true},
+            {"capacity",        false, 0.0, 1e9, false},
+            {"max_concurrency", false, 0.0, 1e9, false, integerCheck("max_concurrency")},
+            {"max_connections", false, 0.0, 1e9, false, integerCheck("max_connections")},
+            {"ttl_ms",          false, 0.0, std::numeric_limits<double>::max(), true},
+            {"hit_rate",        false, 0.0, 1.0, true},
         },
         { {"eviction_policy", false, {"LRU","LFU","FIFO","RANDOM"}} }
     };
@@ -151,12 +435,14 @@ static std::unordered_map<ComponentType, ComponentSchema> buildSchemas() {
     s[ComponentType::DATABASE] = {
         {
             {"latency",           false, 0.0, 1e9,  true},
+            {"base_latency_ms",   false, 0.0, 1e9,  true},
             {"error_rate",        false, 0.0, 1.0,  true},
+            {"disk_fail_prob",    false, 0.0, 1.0,  true},
             {"capacity",          false, 0.0, 1e9,  false},
-            {"replication_factor",false, 1.0, 100.0,false,
-                [](double v) -> std::string {
-                    return v != std::floor(v) ? "replication_factor must be an integer, got " + std::to_string(v) : "";
-                }},
+            {"max_concurrency",   false, 0.0, 1e9,  false, integerCheck("max_concurrency")},
+            {"max_connections",   false, 0.0, 1e9,  false, integerCheck("max_connections")},
+            {"read_write_ratio",  false, 0.0, 1.0,  true},
+            {"replication_factor",false, 1.0, 100.0,false, integerCheck("replication_factor")},
             {"query_timeout_ms",  false, 0.0, 1e6,  true},
         },
         {
@@ -172,114 +458,128 @@ static std::unordered_map<ComponentType, ComponentSchema> buildSchemas() {
             {"capacity",   false, 0.0, 1e9, false},
         },
         {
-            {"algorithm",     false, {"ROUND_ROBIN","LEAST_CONNECTIONS","IP_HASH","RANDOM","WEIGHTED_ROUND_ROBIN"}},
+            {"algorithm",     false, {"ROUND_ROBIN","LEAST_CONNECTIONS","IP_HASH","RANDOM","WEIGHTED_ROUND_ROBIN","POWER_OF_TWO_CHOICES"}},
             {"health_check",  false, {"ENABLED","DISABLED"}}
         }
     };
 
+    for (auto& [_, schema] : s) {
+        for (auto& p : schema.numeric) p.param = ParamRegistry::intern(p.key);
+        for (auto& p : schema.strings) {
+            p.param = ParamRegistry::intern(p.key);
+            std::sort(p.allowed.begin(), p.allowed.end());
+        }
+    }
     return s;
 }
 
+static const std::unordered_map<ComponentType, ComponentSchema>& schemas() {
+    static const auto s = buildSchemas();
+    return s;
+}
+
+// Request parameters only get registry keys for names already interned, so
+// the rules' and schemas' names go in during static initialisation, before
+// any request is parsed
+static const bool paramNamesInterned = (keys(), schemas(), true);
+
 class ConfigValidator : public IValidatorModule {
 public:
     std::string name() const override { return "ConfigValidator"; }
+    bool incremental() const override { return true; }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
-        static const auto schemas = buildSchemas();
-
-        for (auto& [id, comp] : ir.components) {
-            auto sit = schemas.find(comp.type);
-            if (sit == schemas.end()) {
-                if (comp.type != ComponentType::UNKNOWN)
-                    issues.push_back(ValidationIssue::warning(
-                        "No config schema for type \"" + componentTypeStr(comp.type)
-                        + "\" on component \"" + id + "\". Skipping config validation.",
-                        name(), {id}));
+        return validate(ir, GraphIndex(ir));
+    }
+    std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex& g) const override {
+        return validateWithHooks(*this, ir, g);
+    }
+
+    void checkComponent(const ComponentView& view, std::vector<ValidationIssue>& issues) const override {
+        std::string_view id = view.id;
+        const Component& comp = view.component;
+
+        auto sit = schemas().find(comp.type);
+        if (sit == schemas().end()) {
+            if (comp.type != ComponentType::UNKNOWN)
+                issues.push_back(ValidationIssue::warning(IssueCode::NO_CONFIG_SCHEMA, name(), idList({id}), {},
+                                                          {componentTypeStr(comp.type)}));
+            return;
+        }
+        const auto& schema = sit->second;
+
+        // numeric
+        for (auto& p : schema.numeric) {
+            auto value = view.num(p.param);
+            if (!value) {
+                if (p.required)
+                    issues.push_back(ValidationIssue::error(IssueCode::MISSING_NUMERIC_PARAM, name(), idList({id}), {}, {p.key}));
                 continue;
             }
-            const auto& schema = sit->second;
-
-            // numeric
-            std::unordered_set<std::string> knownNum;
-            for (auto& p : schema.numeric) {
-                knownNum.insert(p.key);
-                auto it = comp.numericConfig.find(p.key);
-                if (it == comp.numericConfig.end()) {
-                    if (p.required)
-                        issues.push_back(ValidationIssue::error(
-                            "Component \"" + id + "\" missing required numeric param \"" + p.key + "\".",
-                            name(), {id}));
-                    continue;
-                }
-                double v = it->second;
-                if (std::isnan(v) || std::isinf(v)) {
-                    issues.push_back(ValidationIssue::error(
-                        "Component \"" + id + "\": param \"" + p.key + "\" is non-finite.",
-                        name(), {id}));
-                    continue;
-                }
-                if (!p.allowZero && v <= p.minVal)
-                    issues.push_back(ValidationIssue::error(
-                        "Component \"" + id + "\": param \"" + p.key + "\" must be > "
-                        + std::to_string(p.minVal) + " but is " + std::to_string(v) + ".",
-                        name(), {id}));
-                else if (v < p.minVal || v > p.maxVal)
-                    issues.push_back(ValidationIssue::error(
-                        "Component \"" + id + "\": param \"" + p.key + "\" = " + std::to_string(v)
-                        + " is outside [" + std::to_string(p.minVal) + ", " + std::to_string(p.maxVal) + "].",
-                        name(), {id}));
-                if (p.customCheck) {
-                    std::string msg = p.customCheck(v);
-                    if (!msg.empty())
-                        issues.push_back(ValidationIssue::error(
-                            "Component \"" + id + "\": param \"" + p.key + "\": " + msg,
-                            name(), {id}));
-                }
+            double v = *value;
+            if (std::isnan(v) || std::isinf(v)) {
+                issues.push_back(ValidationIssue::error(IssueCode::NON_FINITE_PARAM, name(), idList({id}), {}, {p.key}));
+                continue;
             }
-
-            // string / enum
-            std::unordered_set<std::string> knownStr;
-            for (auto& p : schema.strings) {
-                knownStr.insert(p.key);
-                auto it = comp.stringConfig.find(p.key);
-                if (it == comp.stringConfig.end()) {
-                    if (p.required)
-                        issues.push_back(ValidationIssue::error(
-                            "Component \"" + id + "\" missing required string param \"" + p.key + "\".",
-                            name(), {id}));
-                    continue;
-                }
-                const std::string& val = it->second;
-                if (val.empty()) {
-                    issues.push_back(ValidationIssue::error(
-                        "Component \"" + id + "\": string param \"" + p.key + "\" must not be empty.",
-                        name(), {id}));
-                    continue;
-                }
-                if (!p.allowed.empty() && !p.allowed.count(val)) {
-                    std::string opts;
-                    for (auto& o : p.allowed) opts += "\"" + o + "\" ";
-                    issues.push_back(ValidationIssue::error(
-                        "Component \"" + id + "\": param \"" + p.key + "\" has unsupported value \""
-                        + val + "\". Allowed: " + opts, name(), {id}));
-                }
+            if (!p.allowZero && v <= p.minVal)
+                issues.push_back(ValidationIssue::error(IssueCode::PARAM_NOT_ABOVE_MIN, name(), idList({id}), {},
+                                                        {p.key, p.minVal, v}));
+            else if (v < p.minVal || v > p.maxVal)
+                issues.push_back(ValidationIssue::error(IssueCode::PARAM_OUT_OF_RANGE, name(), idList({id}), {},
+                                                        {p.key, v, p.minVal, p.maxVal}));
+            if (p.customCheck) {
+                std::string msg = p.customCheck(v);
+                if (!msg.empty())
+                    issues.push_back(ValidationIssue::error(IssueCode::PARAM_CHECK_FAILED, name(), idList({id}), {},
+                                                            {p.key, std::move(msg)}));
             }
+        }
 
-            // unknown keys
-            for (auto& [k, _] : comp.numericConfig)
-                if (!knownNum.count(k))
-                    issues.push_back(ValidationIssue::warning(
-                        "Component \"" + id + "\" has unrecognised numeric key \"" + k
-                        + "\". It will be ignored. Check for typos.", name(), {id}));
-            for (auto& [k, _] : comp.stringConfig)
-                if (!knownStr.count(k))
-                    issues.push_back(ValidationIssue::warning(
-                        "Component \"" + id + "\" has unrecognised string key \"" + k
-                        + "\". It will be ignored. Check for typos.", name(), {id}));
+        // string / enum
+        for (auto& p : schema.strings) {
+            auto value = view.str(p.param);
+            if (!value) {
+                if (p.required)
+                    issues.push_back(ValidationIssue::error(IssueCode::MISSING_STRING_PARAM, name(), idList({id}), {}, {p.key}));
+                continue;
+            }
+            std::string_view val = *value;
+            if (val.empty()) {
+                issues.push_back(ValidationIssue::error(IssueCode::EMPTY_STRING_PARAM, name(), idList({id}), {}, {p.key}));
+                continue;
+            }
+            auto matches = [&](const std::string& o) { return equalsIgnoreCase(o, val); };
+            if (!p.allowed.empty() && std::none_of(p.allowed.begin(), p.allowed.end(), matches)) {
+                std::string opts;
+                for (auto& o : p.allowed) opts += "\"" + o + "\" ";
+                issues.push_back(ValidationIssue::error(IssueCode::UNSUPPORTED_STRING_VALUE, name(), idList({id}), {},
+                                                        {p.key, std::string(val), std::move(opts)}));
+            }
         }
 
-        return issues;
+        // unknown keys, numeric ones first, each in name order; schemas hold
+        // a handful of params, so a scan beats building sets
+        const ParamRange params = comp.user_params;
+        if (params.count == 0) return;
+        const ParamSlot* slots = view.ir.slots(params);
+        auto knownNum = [&](ParamKey k) {
+            for (auto& p : schema.numeric) if (p.param == k) return true;
+            return false;
+        };
+        auto knownStr = [&](ParamKey k) {
+            for (auto& p : schema.strings) if (p.param == k) return true;
+            return false;
+        };
+        std::vector<std::uint32_t> order;
+        orderByName(view.ir, slots, params.count, order);
+        for (std::uint32_t i : order)
+            if (slots[i].type != ParamType::STRING && !knownNum(slots[i].key))
+                issues.push_back(ValidationIssue::warning(IssueCode::UNKNOWN_NUMERIC_KEY, name(), idList({id}), {},
+                                                          {std::string(view.ir.paramName(slots[i].key))}));
+        for (std::uint32_t i : order)
+            if (slots[i].type == ParamType::STRING && !knownStr(slots[i].key))
+                issues.push_back(ValidationIssue::warning(IssueCode::UNKNOWN_STRING_KEY, name(), idList({id}), {},
+                                                          {std::string(view.ir.paramName(slots[i].key))}));
     }
 };
 
@@ -290,84 +590,61 @@ public:
 class SemanticValidator : public IValidatorModule {
 public:
     std::string name() const override { return "SemanticValidator"; }
+    bool incremental() const override { return true; }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
-        if (ir.components.empty()) return issues;
-
-        AdjSet out, in;
-        buildAdj(ir, out, in);
-
-        for (auto& [id, comp] : ir.components) {
-            if (comp.type == ComponentType::DATABASE && !out.at(id).empty()) {
-                std::string targets;
-                for (auto& t : out.at(id)) targets += "\"" + t + "\" ";
-                issues.push_back(ValidationIssue::error(
-                    "DATABASE \"" + id + "\" has " + std::to_string(out.at(id).size())
-                    + " outgoing connection(s) to: " + targets
-                    + "— databases must not initiate outbound requests.",
-                    name(), {id}));
-            }
+        return validate(ir, GraphIndex(ir));
+    }
+    std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex& g) const override {
+        return validateWithHooks(*this, ir, g);
+    }
 
-            if (comp.type == ComponentType::CACHE) {
-                std::size_t n = out.at(id).size();
-                if (n != 1)
-                    issues.push_back(ValidationIssue::error(
-                        "CACHE \"" + id + "\" must have exactly one backend but has "
-                        + std::to_string(n) + ". A cache must point to exactly one data source.",
-                        name(), {id}));
-            }
+    void checkComponent(const ComponentView& v, std::vector<ValidationIssue>& issues) const override {
+        std::string_view id = v.id;
+        const Component& comp = v.component;
+        const auto& out = v.successors;
 
-            if (comp.type == ComponentType::LOAD_BALANCER && out.at(id).empty())
-                issues.push_back(ValidationIssue::error(
-                    "LOAD_BALANCER \"" + id + "\" has no backend connections. "
-                    "It must route traffic to at least one backend.",
-                    name(), {id}));
-
-            if (comp.type == ComponentType::LOAD_BALANCER) {
-                for (auto& tgt : out.at(id)) {
-                    if (ir.components.count(tgt) && ir.components.at(tgt).type == ComponentType::DATABASE)
-                        issues.push_back(ValidationIssue::warning(
-                            "LOAD_BALANCER \"" + id + "\" routes directly to DATABASE \""
-                            + tgt + "\". LBs typically front services, not databases.",
-                            name(), {id, tgt}));
-                }
-            }
+        if (comp.type == ComponentType::DATABASE && !out.empty()) {
+            std::vector<std::string> related{std::string(id)};
+            for (auto* t : out) related.emplace_back(t->id);
+            issues.push_back(ValidationIssue::error(IssueCode::DATABASE_OUTBOUND, name(), std::move(related), {},
+                                                    {static_cast<double>(out.size())}));
         }
 
-        std::vector<std::string> entries;
-        for (auto& [id, comp] : ir.components)
-            if (comp.type != ComponentType::DATABASE && in.at(id).empty())
-                entries.push_back(id);
+        if (comp.type == ComponentType::CACHE && out.size() != 1)
+            issues.push_back(ValidationIssue::error(IssueCode::CACHE_BACKEND_COUNT, name(), idList({id}), {},
+                                                    {static_cast<double>(out.size())}));
 
-        if (entries.empty())
-            issues.push_back(ValidationIssue::error(
-                "The diagram has no entry point. At least one non-DATABASE component "
-                "must have no incoming connections to serve as request ingress.",
-                name()));
-        else if (entries.size() > 1) {
-            std::string list;
-            for (auto& ep : entries) list += "\"" + ep + "\" ";
-            issues.push_back(ValidationIssue::warning(
-                "The diagram has " + std::to_string(entries.size()) + " entry points: "
-                + list + "— multiple ingress points may indicate a missing top-level load balancer.",
-                name(), entries));
-        }
+        if (comp.type == ComponentType::LOAD_BALANCER && out.empty())
+            issues.push_back(ValidationIssue::error(IssueCode::LB_NO_BACKENDS, name(), idList({id})));
 
-        for (auto& [id, comp] : ir.components) {
-            bool hasIn = !in.at(id).empty(), hasOut = !out.at(id).empty();
-            if (!hasIn && hasOut
-                && comp.type != ComponentType::LOAD_BALANCER
-                && comp.type != ComponentType::SERVICE)
-            {
-                issues.push_back(ValidationIssue::warning(
-                    componentTypeStr(comp.type) + " component \"" + id
-                    + "\" has outgoing connections but no incoming — unexpected ingress type.",
-                    name(), {id}));
+        if (comp.type == ComponentType::LOAD_BALANCER) {
+            for (auto* tgt : out) {
+                if (tgt->type == ComponentType::DATABASE)
+                    issues.push_back(ValidationIssue::warning(IssueCode::LB_TO_DATABASE, name(),
+                                                              idList({id, tgt->id})));
             }
         }
 
-        return issues;
+        bool hasIn = !v.predecessors.empty(), hasOut = !out.empty();
+        if (!hasIn && hasOut
+            && comp.type != ComponentType::LOAD_BALANCER
+            && comp.type != ComponentType::SERVICE)
+        {
+            issues.push_back(ValidationIssue::warning(IssueCode::UNEXPECTED_INGRESS, name(), idList({id}), {},
+                                                      {componentTypeStr(comp.type)}));
+        }
+    }
+
+    void checkSummary(const DiagramSummary& s, std::vector<ValidationIssue>& issues) const override {
+        if (s.componentCount == 0) return;
+
+        const auto& entries = s.ingress;
+        if (entries.empty())
+            issues.push_back(ValidationIssue::error(IssueCode::NO_ENTRY_POINT, name()));
+        else if (entries.size() > 1)
+            issues.push_back(ValidationIssue::warning(IssueCode::MULTIPLE_ENTRY_POINTS, name(), entries, {},
+                                                      {static_cast<double>(entries.size())}));
     }
 };
 
@@ -380,130 +657,181 @@ public:
     static constexpr int DEFAULT_DEPTH_THRESHOLD = 8;
     explicit TopologyValidator(int dt = DEFAULT_DEPTH_THRESHOLD) : depthThreshold_(dt) {}
     std::string name() const override { return "TopologyValidator"; }
+    bool incremental() const override { return true; }
+
+    // ---- incremental hooks (validate() below runs its own whole-graph passes) ----
+
+    void checkComponent(const ComponentView& v, std::vector<ValidationIssue>& issues) const override {
+        if (!v.reachable) issues.push_back(unreachableIssue(v.id, v.component));
+    }
+
+    void checkCycle(const std::vector<const Component*>& members,
+                    std::vector<ValidationIssue>& issues) const override
+    {
+        std::vector<std::string> ids;
+        ids.reserve(members.size());
+        for (auto* c : members) ids.emplace_back(c->id);
+        issues.push_back(ValidationIssue::error(IssueCode::CYCLE, name(), std::move(ids), {},
+                                                {static_cast<double>(members.size())}));
+    }
+
+    void checkSummary(const DiagramSummary& s, std::vector<ValidationIssue>& issues) const override {
+        if (s.componentCount > 0 && s.maxDepth >= depthThreshold_)
+            issues.push_back(depthIssue(s.deepestEntry, s.maxDepth));
+    }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
-        if (ir.components.empty()) return issues;
+        return validate(ir, GraphIndex(ir));
+    }
 
-        std::unordered_map<std::string, std::vector<std::string>> adj;
-        for (auto& [id, _] : ir.components) adj[id];
-        for (auto& c : ir.connections)
-            if (ir.components.count(c.from_component_id) && ir.components.count(c.to_component_id))
-                adj[c.from_component_id].push_back(c.to_component_id);
+    // One iterative Tarjan pass yields the SCCs and, since they come out sinks
+    // first, each SCC's longest chain below it; one pass over the SCCs in
+    // topological order then yields reachability. O(V + E), no recursion.
+    std::vector<ValidationIssue> validate(const DiagramIR&, const GraphIndex& g) const override {
+        std::vector<ValidationIssue> issues;
+        if (g.size() == 0) return issues;
+
+        Condensation c = condense(g);
+        const std::uint32_t sccs = static_cast<std::uint32_t>(c.height.size());
+
+        // Cycles: one error per cyclic SCC, members in id order
+        for (std::uint32_t s = 0; s < sccs; ++s) {
+            const NodeId* first = c.members.data() + c.memberStart[s];
+            const NodeId* last  = c.members.data() + c.memberStart[s + 1];
+            if (last - first == 1 && !selfLoop(g, *first)) continue;
+            std::vector<NodeId> ids(first, last);
+            std::sort(ids.begin(), ids.end());
+            std::vector<const Component*> members;
+            members.reserve(ids.size());
+            for (NodeId v : ids) members.push_back(&g.component(v));
+            checkCycle(members, issues);
+        }
+        std::sort(issues.begin(), issues.end(), [](const ValidationIssue& a, const ValidationIssue& b) {
+            return a.related_components.front() < b.related_components.front();
+        });
+
+        // Reachability from components with no incoming connection
+        std::vector<char> reachable(sccs, 0);
+        for (NodeId v = 0; v < g.size(); ++v)
+            if (g.predecessors(v).empty()) reachable[c.comp[v]] = 1;
+        for (std::uint32_t s = sccs; s-- > 0;) {
+            if (!reachable[s]) continue;
+            for (std::uint32_t k = c.memberStart[s]; k < c.memberStart[s + 1]; ++k)
+                for (NodeId w : g.successors(c.members[k])) reachable[c.comp[w]] = 1;
+        }
+        for (NodeId v = 0; v < g.size(); ++v)
+            if (!reachable[c.comp[v]])
+                issues.push_back(unreachableIssue(g.id(v), g.component(v)));
+
+        // Depth: deepest entry, lowest id on ties
+        NodeId deepest = GraphIndex::NONE;
+        for (NodeId v = 0; v < g.size(); ++v)
+            if (g.predecessors(v).empty()
+                && (deepest == GraphIndex::NONE || c.height[c.comp[v]] > c.height[c.comp[deepest]]))
+                deepest = v;
+        int maxDepth = deepest == GraphIndex::NONE ? 0 : static_cast<int>(c.height[c.comp[deepest]]);
+        if (maxDepth >= depthThreshold_)
+            issues.push_back(depthIssue(deepest == GraphIndex::NONE ? std::string_view() : g.id(deepest), maxDepth));
 
-        detectCycles(ir, adj, issues);
-        checkReachability(ir, adj, issues);
-        checkDepth(ir, adj, issues);
         return issues;
     }
 
 private:
     int depthThreshold_;
 
-    using Adj = std::unordered_map<std::string, std::vector<std::string>>;
+    using NodeId = GraphIndex::NodeId;
 
-    void detectCycles(const DiagramIR& ir, const Adj& adj,
-                      std::vector<ValidationIssue>& issues) const
-    {
-        enum Color { WHITE, GRAY, BLACK };
-        std::unordered_map<std::string, Color> color;
-        for (auto& [id, _] : ir.components) color[id] = WHITE;
-
-        for (auto& [startId, _] : ir.components) {
-            if (color[startId] != WHITE) continue;
-            std::vector<std::pair<std::string, std::size_t>> stack;
-            stack.push_back({startId, 0});
-            color[startId] = GRAY;
-
-            while (!stack.empty()) {
-                auto& [node, idx] = stack.back();
-                const auto& nbrs = adj.at(node);
-                if (idx < nbrs.size()) {
-                    const std::string& next = nbrs[idx++];
-                    if (color[next] == GRAY) {
-                        std::string path;
-                        bool found = false;
-                        for (auto& [n, _] : stack) {
-                            if (n == next) found = true;
-                            if (found) path += "\"" + n + "\" -> ";
-                        }
-                        path += "\"" + next + "\" (cycle)";
-                        issues.push_back(ValidationIssue::error(
-                            "Cycle detected: " + path
-                            + ". Cycles cause infinite request loops during simulation.",
-                            name(), {node, next}));
-                    } else if (color[next] == WHITE) {
-                        color[next] = GRAY;
-                        stack.push_back({next, 0});
-                    }
-                } else {
-                    color[node] = BLACK;
-                    stack.pop_back();
-                }
-            }
-        }
+    // SCC ids follow Tarjan's emission order, which is reverse topological
+    struct Condensation {
+        std::vector<std::uint32_t> comp;            // SCC of each component
+        std::vector<std::uint32_t> height;          // longest chain of SCC edges below each SCC
+        std::vector<std::uint32_t> memberStart;     // CSR of SCC members
+        std::vector<NodeId>        members;
+    };
+
+    static bool selfLoop(const GraphIndex& g, NodeId v) {
+        auto succ = g.successors(v);
+        return std::binary_search(succ.begin(), succ.end(), v);
     }
 
-    void checkReachability(const DiagramIR& ir, const Adj& adj,
-                           std::vector<ValidationIssue>& issues) const
-    {
-        std::unordered_set<std::string> hasIn;
-        for (auto& [id, nbrs] : adj) for (auto& n : nbrs) hasIn.insert(n);
-
-        std::unordered_set<std::string> visited;
-        std::vector<std::string> queue;
-        for (auto& [id, _] : ir.components)
-            if (!hasIn.count(id)) { queue.push_back(id); visited.insert(id); }
-
-        while (!queue.empty()) {
-            std::string cur = queue.back(); queue.pop_back();
-            for (auto& next : adj.at(cur))
-                if (!visited.count(next)) { visited.insert(next); queue.push_back(next); }
-        }
+    static Condensation condense(const GraphIndex& g) {
+        const std::size_t n = g.size();
+        Condensation c;
+        c.comp.assign(n, GraphIndex::NONE);
+        c.memberStart.push_back(0);
+        c.members.reserve(n);
 
-        for (auto& [id, comp] : ir.components)
-            if (!visited.count(id))
-                issues.push_back(ValidationIssue::warning(
-                    "Component \"" + id + "\" (" + componentTypeStr(comp.type)
-                    + ") is unreachable from all entry points — it will never process requests.",
-                    name(), {id}));
-    }
+        std::vector<std::uint32_t> index(n, 0), low(n, 0);
+        std::vector<char> onStack(n, 0);
+        std::vector<NodeId> stack;
 
-    void checkDepth(const DiagramIR& ir, const Adj& adj,
-                    std::vector<ValidationIssue>& issues) const
-    {
-        std::unordered_map<std::string, int> memo;
-        std::unordered_map<std::string, bool> inStack;
-
-        std::function<int(const std::string&)> dfs = [&](const std::string& id) -> int {
-            auto it = memo.find(id);
-            if (it != memo.end()) return it->second;
-            if (inStack[id]) return 0;
-            inStack[id] = true;
-            int d = 0;
-            for (auto& next : adj.at(id)) d = std::max(d, 1 + dfs(next));
-            inStack[id] = false;
-            return memo[id] = d;
+        struct Frame {
+            NodeId        v;
+            const NodeId* next;
+        };
+        std::vector<Frame> frames;
+        std::uint32_t counter = 0;
+
+        auto enter = [&](NodeId v) {
+            index[v] = low[v] = ++counter;
+            onStack[v] = 1;
+            stack.push_back(v);
+            frames.push_back({v, g.successors(v).begin()});
         };
 
-        std::unordered_set<std::string> hasIn;
-        for (auto& [id, nbrs] : adj) for (auto& n : nbrs) hasIn.insert(n);
+        for (NodeId root = 0; root < n; ++root) {
+            if (index[root]) continue;
+            enter(root);
+
+            while (!frames.empty()) {
+                NodeId v = frames.back().v;
+                const NodeId*& next = frames.back().next;
+                if (next != g.successors(v).end()) {
+                    NodeId w = *next++;
+                    if (!index[w])        enter(w);
+                    else if (onStack[w])  low[v] = std::min(low[v], index[w]);
+                    continue;
+                }
 
-        int globalMax = 0;
-        std::string deepestEntry;
-        for (auto& [id, _] : ir.components) {
-            if (!hasIn.count(id)) {
-                int d = dfs(id);
-                if (d > globalMax) { globalMax = d; deepestEntry = id; }
+                frames.pop_back();
+                if (!frames.empty()) {
+                    NodeId parent = frames.back().v;
+                    low[parent] = std::min(low[parent], low[v]);
+                }
+                if (low[v] != index[v]) continue;
+
+                // Pop the SCC; everything it points to outside itself was
+                // emitted earlier, so its height is final already
+                const std::uint32_t s = static_cast<std::uint32_t>(c.height.size());
+                const std::size_t first = c.members.size();
+                NodeId w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = 0;
+                    c.comp[w] = s;
+                    c.members.push_back(w);
+                } while (w != v);
+
+                std::uint32_t h = 0;
+                for (std::size_t k = first; k < c.members.size(); ++k)
+                    for (NodeId x : g.successors(c.members[k]))
+                        if (c.comp[x] != s) h = std::max(h, c.height[c.comp[x]] + 1);
+                c.height.push_back(h);
+                c.memberStart.push_back(static_cast<std::uint32_t>(c.members.size()));
             }
         }
+        return c;
+    }
+
+    ValidationIssue unreachableIssue(std::string_view id, const Component& comp) const {
+        return ValidationIssue::warning(IssueCode::UNREACHABLE, name(), idList({id}), {},
+                                        {componentTypeStr(comp.type)});
+    }
 
-        if (globalMax >= depthThreshold_)
-            issues.push_back(ValidationIssue::warning(
-                "Longest request chain from \"" + deepestEntry + "\" has depth "
-                + std::to_string(globalMax) + " (threshold: " + std::to_string(depthThreshold_)
-                + "). Deep chains increase tail latency. Consider adding caching or flattening.",
-                name(), {deepestEntry}));
+    ValidationIssue depthIssue(std::string_view entry, int depth) const {
+        return ValidationIssue::warning(IssueCode::DEEP_CHAIN, name(), idList({entry}), {},
+                                        {static_cast<double>(depth), static_cast<double>(depthThreshold_)});
     }
 };
 
@@ -514,72 +842,56 @@ private:
 class CapacityValidator : public IValidatorModule {
 public:
     std::string name() const override { return "CapacityValidator"; }
+    bool incremental() const override { return true; }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
+        return validate(ir, GraphIndex(ir));
+    }
+    std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex& g) const override {
+        return validateWithHooks(*this, ir, g);
+    }
 
-        for (auto& [id, comp] : ir.components) {
-            auto cap = comp.getNum("capacity");
-            if (cap && *cap == 0.0)
-                issues.push_back(ValidationIssue::error(
-                    "Component \"" + id + "\" has capacity = 0. "
-                    "It will never process requests. Set a positive capacity or remove it.",
-                    name(), {id}));
-
-            auto qs = comp.getNum("queue_size");
-            if (qs && *qs < 0.0)
-                issues.push_back(ValidationIssue::error(
-                    "Component \"" + id + "\" has negative queue_size (" + std::to_string(*qs) + ").",
-                    name(), {id}));
-
-            auto tp = comp.getNum("throughput");
-            if (tp && *tp < 0.0)
-                issues.push_back(ValidationIssue::error(
-                    "Component \"" + id + "\" has negative throughput (" + std::to_string(*tp) + ").",
-                    name(), {id}));
-
-            if (comp.type == ComponentType::CACHE) {
-                auto hr = comp.getNum("hit_rate");
-                if (hr) {
-                    if (*hr == 0.0)
-                        issues.push_back(ValidationIssue::warning(
-                            "CACHE \"" + id + "\" has hit_rate = 0 — the cache never serves a hit. "
-                            "All requests fall through to the backend.", name(), {id}));
-                    else if (*hr == 1.0)
-                        issues.push_back(ValidationIssue::warning(
-                            "CACHE \"" + id + "\" has hit_rate = 1 — the backend will never receive "
-                            "requests and is effectively dead code.", name(), {id}));
-                }
+    void checkComponent(const ComponentView& v, std::vector<ValidationIssue>& issues) const override {
+        std::string_view id = v.id;
+        const Component& comp = v.component;
+
+        auto cap = v.num(keys().capacity);
+        if (cap && *cap == 0.0)
+            issues.push_back(ValidationIssue::error(IssueCode::ZERO_CAPACITY, name(), idList({id})));
+
+        auto qs = v.num(keys().queueSize);
+        if (qs && *qs < 0.0)
+            issues.push_back(ValidationIssue::error(IssueCode::NEGATIVE_QUEUE_SIZE, name(), idList({id}), {}, {*qs}));
+
+        auto tp = v.num(keys().throughput);
+        if (tp && *tp < 0.0)
+            issues.push_back(ValidationIssue::error(IssueCode::NEGATIVE_THROUGHPUT, name(), idList({id}), {}, {*tp}));
+
+        if (comp.type == ComponentType::CACHE) {
+            auto hr = v.num(keys().hitRate);
+            if (hr) {
+                if (*hr == 0.0)
+                    issues.push_back(ValidationIssue::warning(IssueCode::CACHE_NEVER_HITS, name(), idList({id})));
+                else if (*hr == 1.0)
+                    issues.push_back(ValidationIssue::warning(IssueCode::CACHE_ALWAYS_HITS, name(), idList({id})));
             }
+        }
 
-            auto er = comp.getNum("error_rate");
-            if (er && *er == 1.0)
-                issues.push_back(ValidationIssue::warning(
-                    "Component \"" + id + "\" has error_rate = 1.0 (always fails). "
-                    "All downstream components will be starved of successful requests.",
-                    name(), {id}));
-
-            if (comp.type == ComponentType::SERVICE) {
-                auto lat = comp.getNum("latency");
-                if (lat && *lat > 10000.0)
-                    issues.push_back(ValidationIssue::warning(
-                        "SERVICE \"" + id + "\" has very high latency ("
-                        + std::to_string(static_cast<int>(*lat)) + " ms). "
-                        "This will dominate tail latency in any chain through it.",
-                        name(), {id}));
-            }
+        auto er = v.num(keys().errorRate);
+        if (er && *er == 1.0)
+            issues.push_back(ValidationIssue::warning(IssueCode::ALWAYS_FAILS, name(), idList({id})));
 
-            if (comp.type == ComponentType::DATABASE) {
-                auto rf = comp.getNum("replication_factor");
-                if (rf && *rf == 1.0)
-                    issues.push_back(ValidationIssue::warning(
-                        "DATABASE \"" + id + "\" has replication_factor = 1 (no replicas). "
-                        "This is a single point of failure. Consider replication_factor >= 2.",
-                        name(), {id}));
-            }
+        if (comp.type == ComponentType::SERVICE) {
+            auto lat = v.num(keys().latency);
+            if (lat && *lat > 10000.0)
+                issues.push_back(ValidationIssue::warning(IssueCode::HIGH_LATENCY, name(), idList({id}), {}, {*lat}));
         }
 
-        return issues;
+        if (comp.type == ComponentType::DATABASE) {
+            auto rf = v.num(keys().replicationFactor);
+            if (rf && *rf == 1.0)
+                issues.push_back(ValidationIssue::warning(IssueCode::DATABASE_NO_REPLICAS, name(), idList({id})));
+        }
     }
 };
 
@@ -590,111 +902,78 @@ public:
 class DesignAdvisor : public IValidatorModule {
 public:
     std::string name() const override { return "DesignAdvisor"; }
+    bool incremental() const override { return true; }
 
     std::vector<ValidationIssue> validate(const DiagramIR& ir) const override {
-        std::vector<ValidationIssue> issues;
-        if (ir.components.empty()) return issues;
+        return validate(ir, GraphIndex(ir));
+    }
+    std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex& g) const override {
+        return validateWithHooks(*this, ir, g);
+    }
 
-        AdjSet out, in;
-        buildAdj(ir, out, in);
+    void checkComponent(const ComponentView& v, std::vector<ValidationIssue>& issues) const override {
+        std::string_view id = v.id;
+        const Component& comp = v.component;
 
         // Service -> Database with no cache
-        for (auto& [id, comp] : ir.components) {
-            if (comp.type != ComponentType::SERVICE) continue;
-            for (auto& tgt : out.at(id))
-                if (ir.components.count(tgt) && ir.components.at(tgt).type == ComponentType::DATABASE)
-                    issues.push_back(ValidationIssue::warning(
-                        "SERVICE \"" + id + "\" connects directly to DATABASE \"" + tgt
-                        + "\" without a CACHE. Every read hits the database.",
-                        name(), {id, tgt}));
+        if (comp.type == ComponentType::SERVICE) {
+            for (auto* tgt : v.successors)
+                if (tgt->type == ComponentType::DATABASE)
+                    issues.push_back(ValidationIssue::warning(IssueCode::SERVICE_DATABASE_NO_CACHE, name(),
+                                                              idList({id, tgt->id})));
         }
 
         // Single-instance service with no fronting LB
-        for (auto& [id, comp] : ir.components) {
-            if (comp.type != ComponentType::SERVICE) continue;
-            auto inst = comp.getNum("instances");
-            if (!inst || *inst > 1) continue;
-            bool hasFrontingLB = false;
-            for (auto& caller : in.at(id))
-                if (ir.components.count(caller) && ir.components.at(caller).type == ComponentType::LOAD_BALANCER)
-                    { hasFrontingLB = true; break; }
-            if (!hasFrontingLB)
-                issues.push_back(ValidationIssue::warning(
-                    "SERVICE \"" + id + "\" has instances = 1 and no upstream LOAD_BALANCER. "
-                    "This is a single point of failure (SPOF).",
-                    name(), {id}));
+        if (comp.type == ComponentType::SERVICE) {
+            auto inst = v.num(keys().instances);
+            if (inst && *inst <= 1) {
+                bool hasFrontingLB = false;
+                for (auto* caller : v.predecessors)
+                    if (caller->type == ComponentType::LOAD_BALANCER) { hasFrontingLB = true; break; }
+                if (!hasFrontingLB)
+                    issues.push_back(ValidationIssue::warning(IssueCode::SERVICE_SPOF, name(), idList({id})));
+            }
         }
 
         // LB with only one backend
-        for (auto& [id, comp] : ir.components)
-            if (comp.type == ComponentType::LOAD_BALANCER && out.at(id).size() == 1)
-                issues.push_back(ValidationIssue::warning(
-                    "LOAD_BALANCER \"" + id + "\" has only one backend — "
-                    "no load distribution benefit. Add backends or remove the LB.",
-                    name(), {id}));
-
-        // No cache in system
-        bool hasDB = false, hasCache = false;
-        for (auto& [_, comp] : ir.components) {
-            if (comp.type == ComponentType::DATABASE) hasDB = true;
-            if (comp.type == ComponentType::CACHE)    hasCache = true;
-        }
-        if (hasDB && !hasCache)
-            issues.push_back(ValidationIssue::warning(
-                "The system has no CACHE components. All reads hit the database directly.",
-                name()));
-
-        // No LB with multiple services
-        int svcCount = 0;
-        bool hasLB = false;
-        for (auto& [_, comp] : ir.components) {
-            if (comp.type == ComponentType::SERVICE)       ++svcCount;
-            if (comp.type == ComponentType::LOAD_BALANCER) hasLB = true;
-        }
-        if (svcCount >= 2 && !hasLB)
-            issues.push_back(ValidationIssue::warning(
-                "The system has " + std::to_string(svcCount)
-                + " SERVICE components but no LOAD_BALANCER. "
-                "Horizontal scaling will have no effect without one.",
-                name()));
+        if (comp.type == ComponentType::LOAD_BALANCER && v.successors.size() == 1)
+            issues.push_back(ValidationIssue::warning(IssueCode::LB_SINGLE_BACKEND, name(), idList({id})));
 
         // Shared-database anti-pattern
-        for (auto& [id, comp] : ir.components) {
-            if (comp.type != ComponentType::DATABASE) continue;
-            std::vector<std::string> directCallers;
-            for (auto& caller : in.at(id))
-                if (ir.components.count(caller) && ir.components.at(caller).type == ComponentType::SERVICE)
-                    directCallers.push_back(caller);
-            if (directCallers.size() >= 2) {
-                std::string list;
-                for (auto& c : directCallers) list += "\"" + c + "\" ";
-                issues.push_back(ValidationIssue::warning(
-                    "DATABASE \"" + id + "\" is called directly by "
-                    + std::to_string(directCallers.size()) + " SERVICE(s): " + list
-                    + "— shared-database anti-pattern. Route via a single service or use separate DBs.",
-                    name(), directCallers));
+        if (comp.type == ComponentType::DATABASE) {
+            std::size_t callers = 0;
+            for (auto* caller : v.predecessors)
+                callers += caller->type == ComponentType::SERVICE;
+            if (callers >= 2) {
+                std::vector<std::string> related{std::string(id)};
+                for (auto* caller : v.predecessors)
+                    if (caller->type == ComponentType::SERVICE) related.emplace_back(caller->id);
+                issues.push_back(ValidationIssue::warning(IssueCode::SHARED_DATABASE, name(), std::move(related), {},
+                                                          {static_cast<double>(callers)}));
             }
         }
 
-        // Mutual service dependency
-        std::unordered_set<std::string> reported;
-        for (auto& [id, comp] : ir.components) {
-            if (comp.type != ComponentType::SERVICE) continue;
-            for (auto& tgt : out.at(id)) {
-                if (!ir.components.count(tgt)) continue;
-                if (ir.components.at(tgt).type != ComponentType::SERVICE) continue;
-                if (out.count(tgt) && out.at(tgt).count(id)) {
-                    std::string key = id < tgt ? id + ":" + tgt : tgt + ":" + id;
-                    if (!reported.insert(key).second) continue;
-                    issues.push_back(ValidationIssue::warning(
-                        "SERVICE \"" + id + "\" and SERVICE \"" + tgt + "\" call each other "
-                        "(mutual dependency). This tight coupling risks cascading failures.",
-                        name(), {id, tgt}));
-                }
+        // Mutual service dependency, reported once by the smaller id of the pair
+        if (comp.type == ComponentType::SERVICE) {
+            for (auto* tgt : v.successors) {
+                if (tgt->type != ComponentType::SERVICE || !(id < tgt->id)) continue;
+                if (std::find(v.predecessors.begin(), v.predecessors.end(), tgt) != v.predecessors.end())
+                    issues.push_back(ValidationIssue::warning(IssueCode::MUTUAL_DEPENDENCY, name(),
+                                                              idList({id, tgt->id})));
             }
         }
+    }
 
-        return issues;
+    void checkSummary(const DiagramSummary& s, std::vector<ValidationIssue>& issues) const override {
+        // No cache in system
+        if (s.count(ComponentType::DATABASE) > 0 && s.count(ComponentType::CACHE) == 0)
+            issues.push_back(ValidationIssue::warning(IssueCode::NO_CACHE, name()));
+
+        // No LB with multiple services
+        std::size_t svcCount = s.count(ComponentType::SERVICE);
+        if (svcCount >= 2 && s.count(ComponentType::LOAD_BALANCER) == 0)
+            issues.push_back(ValidationIssue::warning(IssueCode::NO_LOAD_BALANCER, name(), {}, {},
+                                                      {static_cast<double>(svcCount)}));
     }
 };
 
@@ -714,14 +993,41 @@ Validator Validator::createDefault(int depthThreshold) {
 }
 
 ValidationResult Validator::validate(const DiagramIR& ir) const {
+    const GraphIndex graph(ir);
+    std::vector<std::vector<ValidationIssue>> perModule(modules_.size());
+
+    unsigned threads = threads_ ? threads_ : std::max(1u, std::thread::hardware_concurrency());
+    if (ir.components.size() + ir.links.size() < PARALLEL_MIN_ELEMENTS) threads = 1;
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, modules_.size()));
+
+    // Modules are independent; each writes only its own slot, and the slots are
+    // merged in registration order so the report does not depend on timing
+    std::atomic<std::size_t> cursor{0};
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto worker = [&]() {
+        while (true) {
+            std::size_t i = cursor.fetch_add(1);
+            if (i >= modules_.size()) break;
+            try { perModule[i] = modules_[i]->validate(ir, graph); }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) failure = std::current_exception();
+                cursor = modules_.size();
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    if (failure) std::rethrow_exception(failure);
+
     ValidationResult result;
     result.canProceed = true;
-    for (auto& module : modules_) {
-        for (auto& issue : module->validate(ir)) {
-            if (issue.severity == Severity::ERROR) result.canProceed = false;
-            result.issues.push_back(std::move(issue));
-        }
-    }
+    for (auto& issues : perModule)
+        for (auto& issue : issues)
+            result.add(std::move(issue), limits_);
     return result;
 }
 
@@ -731,10 +1037,11 @@ void Validator::printResult(const ValidationResult& r, std::ostream& os) {
         os << "  No issues found. IR is valid.\n";
     } else {
         for (auto& issue : r.issues) {
-            os << "  [" << severityStr(issue.severity) << "] " << issue.message << "\n";
+            os << "  [" << severityStr(issue.severity) << "] " << issue.message() << "\n";
             if (!issue.related_components.empty()) {
                 os << "    Components : ";
                 for (auto& c : issue.related_components) os << "\"" << c << "\" ";
+                if (issue.omitted_components) os << "(+" << issue.omitted_components << " more)";
                 os << "\n";
             }
             if (!issue.related_connections.empty()) {
@@ -745,6 +1052,10 @@ void Validator::printResult(const ValidationResult& r, std::ostream& os) {
             os << "    Module     : " << issue.source_module << "\n\n";
         }
     }
+    for (auto& rule : r.rules)
+        if (rule.total > rule.reported)
+            os << "  ... " << (rule.total - rule.reported) << " more " << issueCodeStr(rule.code)
+               << " " << severityStr(rule.severity) << "(s) from " << rule.source_module << " not shown\n";
     os << "------------------------------\n";
     os << "  Errors  : " << r.errorCount()   << "\n";
     os << "  Warnings: " << r.warningCount() << "\n";
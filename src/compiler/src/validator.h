@@ -1,8 +1,13 @@
 #pragma once
 
+#include "ir.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <memory>
 #include <optional>
 #include <iostream>
@@ -10,47 +15,24 @@
 namespace simrun {
 
 // ---- IR ----
-
-enum class ComponentType { SERVICE, CACHE, DATABASE, LOAD_BALANCER, UNKNOWN };
-
-inline std::string componentTypeStr(ComponentType t) {
-    switch (t) {
-        case ComponentType::SERVICE:       return "SERVICE";
-        case ComponentType::CACHE:         return "CACHE";
-        case ComponentType::DATABASE:      return "DATABASE";
-        case ComponentType::LOAD_BALANCER: return "LOAD_BALANCER";
-        default:                           return "UNKNOWN";
-    }
-}
-
-struct Component {
-    std::string id;
-    ComponentType type = ComponentType::UNKNOWN;
-    std::map<std::string, double>      numericConfig;
-    std::map<std::string, std::string> stringConfig;
-
-    std::optional<double>      getNum(const std::string& k) const {
-        auto it = numericConfig.find(k);
-        return it != numericConfig.end() ? std::optional<double>(it->second) : std::nullopt;
-    }
-    std::optional<std::string> getStr(const std::string& k) const {
-        auto it = stringConfig.find(k);
-        return it != stringConfig.end() ? std::optional<std::string>(it->second) : std::nullopt;
-    }
-};
-
-struct Connection {
-    std::string id;
-    std::string from_component_id;
-    std::string to_component_id;
-};
-
-struct DiagramIR {
-    std::map<std::string, Component> components;
-    std::vector<Connection>          connections;
-};
+//
+// Modules read the compiler's IR (ir.h) in place: components and connections
+// are its flat tables, a component's config is its run of user parameters,
+// and the graph comes from the endpoint indices indexIR() resolved. Nothing
+// is copied into a validator-side model.
+
+using DiagramIR  = ::IR;
+using Component  = ::ComponentIR;
+using Connection = ::NetworkLinkIR;
+using ::ComponentType;
+using ::componentTypeStr;
 
 // ---- Validation output ----
+//
+// Issues are structured: a rule code, the entities involved and a few
+// parameters. Text is only rendered by message(), i.e. when a result is
+// printed or serialized, so a broken diagram with a million findings costs a
+// million small records rather than a million concatenated strings.
 
 enum class Severity { ERROR, WARNING, INFO };
 
@@ -62,39 +44,182 @@ inline std::string severityStr(Severity s) {
     }
 }
 
+enum class IssueCode : std::uint16_t {
+    // StructuralValidator
+    EMPTY_COMPONENT_ID, ISOLATED_COMPONENT, EMPTY_CONNECTION_ID,
+    DUPLICATE_CONNECTION_ID, MISSING_SOURCE, MISSING_TARGET, SELF_LOOP,
+    // ConfigValidator
+    NO_CONFIG_SCHEMA, MISSING_NUMERIC_PARAM, NON_FINITE_PARAM, PARAM_NOT_ABOVE_MIN,
+    PARAM_OUT_OF_RANGE, PARAM_CHECK_FAILED, MISSING_STRING_PARAM, EMPTY_STRING_PARAM,
+    UNSUPPORTED_STRING_VALUE, UNKNOWN_NUMERIC_KEY, UNKNOWN_STRING_KEY,
+    // SemanticValidator
+    DATABASE_OUTBOUND, CACHE_BACKEND_COUNT, LB_NO_BACKENDS, LB_TO_DATABASE,
+    UNEXPECTED_INGRESS, NO_ENTRY_POINT, MULTIPLE_ENTRY_POINTS,
+    // TopologyValidator
+    CYCLE, UNREACHABLE, DEEP_CHAIN,
+    // CapacityValidator
+    ZERO_CAPACITY, NEGATIVE_QUEUE_SIZE, NEGATIVE_THROUGHPUT, CACHE_NEVER_HITS,
+    CACHE_ALWAYS_HITS, ALWAYS_FAILS, HIGH_LATENCY, DATABASE_NO_REPLICAS,
+    // DesignAdvisor
+    SERVICE_DATABASE_NO_CACHE, SERVICE_SPOF, LB_SINGLE_BACKEND, SHARED_DATABASE,
+    MUTUAL_DEPENDENCY, NO_CACHE, NO_LOAD_BALANCER,
+    // Free text from modules outside the built-in rule set; params[0] is the message
+    CUSTOM,
+};
+
+const char* issueCodeStr(IssueCode c);
+
+struct IssueParam {
+    std::string text;
+    double      number = 0;
+    bool        isNumber = false;
+
+    IssueParam(std::string s) : text(std::move(s)) {}
+    IssueParam(const char* s) : text(s) {}
+    IssueParam(double v) : number(v), isNumber(true) {}
+
+    bool operator==(const IssueParam& o) const {
+        return isNumber == o.isNumber && (isNumber ? number == o.number : text == o.text);
+    }
+};
+
 struct ValidationIssue {
     Severity                 severity;
-    std::string              message;
-    std::vector<std::string> related_components;
+    IssueCode                code = IssueCode::CUSTOM;
+    std::vector<std::string> related_components;    // subject first, for rules that list entities
     std::vector<std::string> related_connections;
     std::string              source_module;
+    std::vector<IssueParam>  params;
+    std::size_t              omitted_components = 0;    // cut from related_components by a cap
+
+    std::string message() const;
+
+    static ValidationIssue error(IssueCode code, const std::string& mod,
+        std::vector<std::string> comps = {}, std::vector<std::string> conns = {},
+        std::vector<IssueParam> params = {})
+    { return { Severity::ERROR, code, std::move(comps), std::move(conns), mod, std::move(params) }; }
+
+    static ValidationIssue warning(IssueCode code, const std::string& mod,
+        std::vector<std::string> comps = {}, std::vector<std::string> conns = {},
+        std::vector<IssueParam> params = {})
+    { return { Severity::WARNING, code, std::move(comps), std::move(conns), mod, std::move(params) }; }
 
     static ValidationIssue error(const std::string& msg, const std::string& mod,
         std::vector<std::string> comps = {}, std::vector<std::string> conns = {})
-    { return { Severity::ERROR, msg, std::move(comps), std::move(conns), mod }; }
+    { return error(IssueCode::CUSTOM, mod, std::move(comps), std::move(conns), {msg}); }
 
     static ValidationIssue warning(const std::string& msg, const std::string& mod,
         std::vector<std::string> comps = {}, std::vector<std::string> conns = {})
-    { return { Severity::WARNING, msg, std::move(comps), std::move(conns), mod }; }
+    { return warning(IssueCode::CUSTOM, mod, std::move(comps), std::move(conns), {msg}); }
+};
+
+// Bounds on what a ValidationResult keeps; totals are always counted in full
+struct ValidationLimits {
+    std::size_t perRule         = 100;  // issues kept per rule (code, severity, module)
+    std::size_t relatedPerIssue = 50;   // entities kept per issue, at least 2
+
+    static ValidationLimits unlimited() { return {SIZE_MAX, SIZE_MAX}; }
+};
+
+struct RuleSummary {
+    IssueCode   code;
+    Severity    severity;
+    std::string source_module;
+    std::size_t total    = 0;       // every finding, suppressed ones included
+    std::size_t reported = 0;       // findings kept in ValidationResult::issues
 };
 
 struct ValidationResult {
     std::vector<ValidationIssue> issues;
+    std::vector<RuleSummary>     rules;     // in order of first finding
     bool canProceed = true;
 
-    bool hasErrors()   const { for (auto& i:issues) if (i.severity==Severity::ERROR)   return true; return false; }
-    bool hasWarnings() const { for (auto& i:issues) if (i.severity==Severity::WARNING) return true; return false; }
-    std::size_t errorCount()   const { std::size_t n=0; for (auto& i:issues) if (i.severity==Severity::ERROR)   ++n; return n; }
-    std::size_t warningCount() const { std::size_t n=0; for (auto& i:issues) if (i.severity==Severity::WARNING) ++n; return n; }
+    // Counts the finding and keeps it unless its rule is already at the cap
+    void add(ValidationIssue issue, const ValidationLimits& limits);
+
+    bool hasErrors()   const { return errorCount() > 0; }
+    bool hasWarnings() const { return warningCount() > 0; }
+    std::size_t errorCount()   const { return total(Severity::ERROR); }
+    std::size_t warningCount() const { return total(Severity::WARNING); }
+    std::size_t suppressedCount() const {
+        std::size_t n = 0;
+        for (auto& r : rules) n += r.total - r.reported;
+        return n;
+    }
+
+private:
+    std::size_t total(Severity s) const {
+        std::size_t n = 0;
+        for (auto& r : rules) if (r.severity == s) n += r.total;
+        return n;
+    }
+};
+
+// ---- Incremental views ----
+//
+// What a module sees when it is asked about one entity rather than the whole
+// diagram. IncrementalValidator keeps these up to date across edits; the batch
+// path builds them once per validate().
+
+struct ComponentView {
+    std::string_view               id;
+    const Component&               component;
+    const DiagramIR&               ir;              // holds the component's parameters
+    std::vector<const Component*>  successors;      // distinct, sorted by id
+    std::vector<const Component*>  predecessors;    // distinct, sorted by id
+    bool                           reachable = true; // from a component with no incoming connection
+
+    // User parameter `key`: INT, DOUBLE and BOOL slots read as numbers, STRING
+    // slots as text; nullopt when missing or of the other kind
+    std::optional<double>           num(ParamKey key) const;
+    std::optional<std::string_view> str(ParamKey key) const;
+};
+
+struct ConnectionView {
+    const Connection& connection;
+    bool sourceExists = false;
+    bool targetExists = false;
+    bool duplicate    = false;      // an earlier connection has the same ID
+};
+
+struct DiagramSummary {
+    std::size_t componentCount = 0;
+    std::array<std::size_t, 5> typeCounts{};        // indexed by ComponentType
+    std::vector<std::string> ingress;               // non-DATABASE components with no incoming connection, sorted
+    int         maxDepth = 0;                       // longest chain of SCCs from a component with no incoming connection
+    std::string deepestEntry;
+
+    std::size_t count(ComponentType t) const { return typeCounts[static_cast<std::size_t>(t)]; }
 };
 
 // ---- Module interface ----
 
+class GraphIndex;
+
 class IValidatorModule {
 public:
     virtual ~IValidatorModule() = default;
     virtual std::vector<ValidationIssue> validate(const DiagramIR&) const = 0;
     virtual std::string name() const = 0;
+
+    // Entry point used by Validator, which builds the GraphIndex once and
+    // shares it between modules. Modules may run concurrently with each other,
+    // so this must not touch mutable shared state. The default ignores the
+    // index and runs the plain overload.
+    virtual std::vector<ValidationIssue> validate(const DiagramIR& ir, const GraphIndex&) const {
+        return validate(ir);
+    }
+
+    // ---- incremental hooks ----
+    // A module returning true from incremental() reports every finding through
+    // exactly one of the hooks below, so IncrementalValidator can re-run just
+    // the hooks whose inputs an edit touched. Other modules are re-run in full.
+    virtual bool incremental() const { return false; }
+    virtual void checkComponent(const ComponentView&, std::vector<ValidationIssue>&) const {}
+    virtual void checkConnection(const ConnectionView&, std::vector<ValidationIssue>&) const {}
+    virtual void checkCycle(const std::vector<const Component*>& /*members, sorted by id*/,
+                            std::vector<ValidationIssue>&) const {}
+    virtual void checkSummary(const DiagramSummary&, std::vector<ValidationIssue>&) const {}
 };
 
 // ---- Top-level Validator ----
@@ -104,11 +229,25 @@ public:
     void addModule(std::unique_ptr<IValidatorModule> m) { modules_.push_back(std::move(m)); }
 
     static Validator createDefault(int depthThreshold = 8);
+
+    // `ir` must be indexed (indexIR), as parseIR leaves it
     ValidationResult validate(const DiagramIR& ir) const;
     static void printResult(const ValidationResult& r, std::ostream& os = std::cout);
 
+    const std::vector<std::unique_ptr<IValidatorModule>>& modules() const { return modules_; }
+
+    // Worker threads for running modules side by side; 0 = hardware
+    // concurrency, 1 = sequential. Small diagrams always run sequentially.
+    void setThreads(unsigned n) { threads_ = n; }
+
+    void setLimits(const ValidationLimits& limits) { limits_ = limits; }
+
+    static constexpr std::size_t PARALLEL_MIN_ELEMENTS = 4096;  // components + connections
+
 private:
     std::vector<std::unique_ptr<IValidatorModule>> modules_;
+    unsigned threads_ = 0;
+    ValidationLimits limits_;
 };
 
 } // namespace simrun
@@ -0,0 +1,168 @@
+const { spawn } = require('child_process');
+
+// Frame layout and codes: src/compiler/src/daemon.h
+const HEADER_BYTES = 10;
+
+const COMPILE = 0x01;
+const CANCEL = 0x02;
+const RELOAD = 0x03;
+const STATS = 0x04;
+
+const RESULT = 0x81;
+const PROGRESS = 0x82;
+const REJECTED = 0x83;
+
+const FLAG_BINARY = 0x01;
+const FLAG_COMPACT = 0x02;
+const FLAG_OK = 0x01;
+const FLAG_MORE = 0x02;
+
+// One long-lived `compiler --daemon`, started on first use and again after
+// it exits. Requests are multiplexed over its stdin/stdout by id.
+class CompilerDaemon {
+  constructor(executable, { env } = {}) {
+    this.executable = executable;
+    this.env = env;
+    this.child = null;
+    this.nextId = 1;
+    this.pending = new Map();
+
+    this.chunks = [];
+    this.buffered = 0;
+    this.awaiting = HEADER_BYTES;
+  }
+
+  // Resolves with the compiled IR (a Buffer when `binary`), rejects with the
+  // compiler's error output. Aborting `signal` cancels the run.
+  compile(json, { binary = false, compact = false, onProgress, signal } = {}) {
+    const flags = (binary ? FLAG_BINARY : 0) | (compact ? FLAG_COMPACT : 0);
+    return this.request(COMPILE, Buffer.from(json, 'utf-8'), flags, { binary, onProgress, signal });
+  }
+
+  reload() {
+    return this.request(RELOAD);
+  }
+
+  async stats() {
+    return JSON.parse(await this.request(STATS));
+  }
+
+  stop() {
+    if (this.child) this.child.stdin.end();
+  }
+
+  request(type, payload = Buffer.alloc(0), flags = 0, { binary = false, onProgress, signal } = {}) {
+    this.start();
+
+    const id = this.nextId;
+    this.nextId = this.nextId >= 0xffffffff ? 1 : this.nextId + 1;
+
+    return new Promise((resolve, reject) => {
+      const entry = { resolve, reject, binary, onProgress, parts: [] };
+      this.pending.set(id, entry);
+
+      if (signal) {
+        const onAbort = () => this.send(id, CANCEL, 0, Buffer.alloc(0));
+        signal.addEventListener('abort', onAbort, { once: true });
+        entry.cleanup = () => signal.removeEventListener('abort', onAbort);
+      }
+
+      this.send(id, type, flags, payload);
+    });
+  }
+
+  start() {
+    if (this.child) return;
+
+    const child = spawn(this.executable, ['--daemon'], {
+      env: this.env,
+      stdio: ['pipe', 'pipe', 'inherit']
+    });
+
+    const onGone = (reason) => {
+      if (this.child !== child) return;
+      this.child = null;
+      this.chunks = [];
+      this.buffered = 0;
+      this.awaiting = HEADER_BYTES;
+      this.failAll(reason);
+    };
+
+    child.stdout.on('data', (chunk) => this.onData(chunk));
+    child.stdin.on('error', () => {});     // reported by 'exit'
+    child.on('error', (err) => onGone(err.message));
+    child.on('exit', (code, signal) => onGone(`compiler exited (${signal || code})`));
+
+    this.child = child;
+  }
+
+  send(id, type, flags, payload) {
+    if (!this.child) return;
+    const header = Buffer.alloc(HEADER_BYTES);
+    header.writeUInt32LE(payload.length + HEADER_BYTES - 4, 0);
+    header.writeUInt32LE(id, 4);
+    header.writeUInt8(type, 8);
+    header.writeUInt8(flags, 9);
+    this.child.stdin.write(header);
+    this.child.stdin.write(payload);
+  }
+
+  onData(chunk) {
+    this.chunks.push(chunk);
+    this.buffered += chunk.length;
+
+    // Concatenate only once a whole frame has arrived
+    while (this.buffered >= this.awaiting) {
+      const buf = this.chunks.length === 1 ? this.chunks[0] : Buffer.concat(this.chunks, this.buffered);
+      const size = 4 + buf.readUInt32LE(0);
+      if (buf.length < size) {
+        this.chunks = [buf];
+        this.awaiting = size;
+        break;
+      }
+
+      const rest = buf.subarray(size);
+      this.chunks = rest.length ? [rest] : [];
+      this.buffered = rest.length;
+      this.awaiting = HEADER_BYTES;
+
+      this.onFrame(buf.readUInt32LE(4), buf[8], buf[9], buf.subarray(HEADER_BYTES, size));
+    }
+  }
+
+  onFrame(id, type, flags, payload) {
+    const entry = this.pending.get(id);
+    if (!entry) return;
+
+    if (type === PROGRESS) {
+      if (entry.onProgress) entry.onProgress(JSON.parse(payload.toString('utf-8')));
+      return;
+    }
+
+    if (type === RESULT) {
+      entry.parts.push(Buffer.from(payload));
+      if (flags & FLAG_MORE) return;
+    }
+
+    this.pending.delete(id);
+    if (entry.cleanup) entry.cleanup();
+
+    const data = Buffer.concat(entry.parts);
+    if (type === RESULT && (flags & FLAG_OK)) {
+      entry.resolve(entry.binary ? data : data.toString('utf-8'));
+    } else {
+      entry.reject(new Error(type === REJECTED ? payload.toString('utf-8') : data.toString('utf-8')));
+    }
+  }
+
+  failAll(reason) {
+    const pending = this.pending;
+    this.pending = new Map();
+    for (const entry of pending.values()) {
+      if (entry.cleanup) entry.cleanup();
+      entry.reject(new Error(reason));
+    }
+  }
+}
+
+module.exports = { CompilerDaemon };
@@ -1,7 +1,6 @@
 const { app, BrowserWindow, ipcMain } = require('electron');
 const path = require('path');
-const fs = require('fs');
-const { execFile } = require('child_process');
+const { CompilerDaemon } = require('./compiler-daemon');
 
 const isDev = !app.isPackaged;
 
@@ -23,36 +22,28 @@ function createWindow() {
   }
 }
 
-ipcMain.handle('run-compiler', async (_, jsonString) => {
-  return new Promise((resolve, reject) => {
-    try {
-      const inputPath = path.resolve(
-        __dirname,
-        '..',
-        'compiler',
-        'input.json'
-      );
-
-      fs.writeFileSync(inputPath, jsonString, 'utf-8');
-
-      const compilerPath = path.resolve(
-        __dirname,
-        '..',
-        'compiler',
-        'compiler.exe'
-      );
+// Started on the first run and kept alive: profiles, caches and workers stay
+// warm, and input and output travel over its stdin/stdout instead of files
+const compilerDir = path.resolve(__dirname, '..', 'compiler');
+const compiler = new CompilerDaemon(path.join(compilerDir, 'compiler.exe'), {
+  env: {
+    SIMRUN_PROFILES: path.join(compilerDir, 'profiles'),
+    ...process.env
+  }
+});
 
-      execFile(compilerPath, [inputPath], (err, stdout, stderr) => {
-        if (err) {
-          reject(stderr || err.message);
-        } else {
-          resolve(stdout);
-        }
-      });
-    } catch (e) {
-      reject(e.message);
-    }
-  });
+ipcMain.handle('run-compiler', async (event, jsonString) => {
+  try {
+    return await compiler.compile(jsonString, {
+      onProgress: (progress) => {
+        if (!event.sender.isDestroyed()) event.sender.send('compiler-progress', progress);
+      }
+    });
+  } catch (e) {
+    throw e.message;
+  }
 });
 
 app.whenReady().then(createWindow);
+
+app.on('will-quit', () => compiler.stop());
@@ -1,5 +1,10 @@
 const { contextBridge, ipcRenderer } = require('electron');
 
 contextBridge.exposeInMainWorld('compilerAPI', {
-  run: (json) => ipcRenderer.invoke('run-compiler', json)
+  run: (json) => ipcRenderer.invoke('run-compiler', json),
+  onProgress: (callback) => {
+    const listener = (_, progress) => callback(progress);
+    ipcRenderer.on('compiler-progress', listener);
+    return () => ipcRenderer.removeListener('compiler-progress', listener);
+  }
 });
@@ -0,0 +1,132 @@
+//process_hops.cpp measures what one hop of a request costs written as plain events and as a
+//Process (process.h): N concurrent requests of H hops each, every hop a short delay. both run on
+//the same binary-heap queue as event_queue.cpp, so the difference is the hop itself; the heap
+//allocations per hop are counted with a replaced global operator new.
+//
+//  g++ -std=c++20 -O2 -DNDEBUG -I.. process_hops.cpp ../core/process.cpp ../core/flow_network.cpp
+//  ./a.out [requests=20000] [hops=100]
+#include "core/process.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <queue>
+#include <vector>
+
+using std::size_t;
+using std::uint64_t;
+using std::unique_ptr;
+using std::vector;
+
+struct SimulationContext {};
+struct SimulationState {};
+
+namespace {
+
+size_t allocations = 0;
+
+struct EventCompare {
+    bool operator()(const unique_ptr<Event>& a, const unique_ptr<Event>& b) const {
+        return a->time > b->time;
+    }
+};
+
+class HeapQueue : public EventQueue {
+private:
+    std::priority_queue<unique_ptr<Event>, vector<unique_ptr<Event>>, EventCompare> pq;
+
+public:
+    void push(unique_ptr<Event> e) override { pq.push(std::move(e)); }
+    unique_ptr<Event> pop() override {
+        auto e = std::move(const_cast<unique_ptr<Event>&>(pq.top()));
+        pq.pop();
+        return e;
+    }
+    bool empty() const override { return pq.empty(); }
+};
+
+void run(HeapQueue& queue, EventScheduler& scheduler) {
+    SimulationContext context;
+    SimulationState state;
+    while (!queue.empty()) queue.pop()->execute(context, state, scheduler);
+}
+
+//plain events: every hop is a new event carrying a pointer to the request's heap state
+struct RequestState {
+    int hops_left;
+    SimTime started;
+    uint64_t* sink;
+};
+
+class HopEvent final : public Event {
+private:
+    RequestState* request;
+
+public:
+    HopEvent(SimTime time, RequestState* request) : Event(time), request(request) {}
+
+    void execute(const SimulationContext&, SimulationState&, EventScheduler& scheduler) override {
+        if (--request->hops_left == 0) {
+            *request->sink += time - request->started;
+            delete request;
+            return;
+        }
+        scheduler.schedule(std::make_unique<HopEvent>(time + 1 + (request->hops_left & 3), request));
+    }
+};
+
+//the same request as a coroutine; the delays match HopEvent's, so both sums of latencies agree
+Process request(ProcessEnv& env, int hops, uint64_t* sink) {
+    SimTime started = env.now();
+    for (int h = hops; --h > 0;) co_await env.delay(1 + (h & 3));
+    *sink += env.now() - started;
+}
+
+}
+
+void* operator new(size_t bytes) {
+    ++allocations;
+    if (void* p = std::malloc(bytes)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char** argv) {
+    const int requests = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const int hops = argc > 2 ? std::atoi(argv[2]) : 100;
+    const double total = double(requests) * hops;
+    using clock = std::chrono::steady_clock;
+
+    for (int round = 0; round < 3; ++round) {
+        uint64_t events_sum = 0, process_sum = 0;
+
+        size_t a0 = allocations;
+        auto t0 = clock::now();
+        {
+            HeapQueue queue;
+            EventScheduler scheduler(queue);
+            for (int i = 0; i < requests; ++i)
+                scheduler.schedule(std::make_unique<HopEvent>(i, new RequestState{hops, SimTime(i), &events_sum}));
+            run(queue, scheduler);
+        }
+        auto t1 = clock::now();
+        size_t a1 = allocations;
+        {
+            HeapQueue queue;
+            EventScheduler scheduler(queue);
+            ProcessEnv env(scheduler);
+            for (int i = 0; i < requests; ++i) env.spawn(request(env, hops, &process_sum), i);
+            run(queue, scheduler);
+        }
+        auto t2 = clock::now();
+        size_t a2 = allocations;
+
+        std::printf("events %6.1f ns/hop %5.2f allocs/hop   processes %6.1f ns/hop %5.2f allocs/hop%s\n",
+                    std::chrono::duration<double, std::nano>(t1 - t0).count() / total, double(a1 - a0) / total,
+                    std::chrono::duration<double, std::nano>(t2 - t1).count() / total, double(a2 - a1) / total,
+                    events_sum == process_sum ? "" : "   (latency sums differ)");
+    }
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstdint>
+#include <memory>
 #include <string>
 
 class BaseEntity {
@@ -8,6 +10,13 @@ public:
 
     const std::string& id() const { return entity_id; }
 
+    //deep copy including mutable state, used to fork a warmed-up simulation
+    virtual std::unique_ptr<BaseEntity> clone() const = 0;
+
+    //restarts the entity's own random engine, if it has one; a fork that becomes an independent
+    //run must not repeat the draws of the state it was copied from
+    virtual void reseed(uint64_t) {}
+
 private:
     std::string entity_id;
 };
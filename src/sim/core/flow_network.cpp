@@ -0,0 +1,202 @@
+#include "flow_network.h"
+#include "event_queue.h"
+#include "scheduler.h"
+#include "../events/flow_completion_event.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using std::size_t;
+using std::vector;
+
+int FlowNetwork::add_link(double bandwidth_mbps) {
+    if (bandwidth_mbps < 0) throw std::invalid_argument("Link bandwidth must not be negative");
+    links.push_back({bandwidth_mbps * 1e6 / 8.0 / ticks_per_second, {}, {}});
+    link_mark.push_back(0);
+    link_left.push_back(0.0);
+    link_unfrozen.push_back(0);
+    share_heap = IndexedMinHeap<double>(links.size());  //only ever empty between reallocations
+    return static_cast<int>(links.size()) - 1;
+}
+
+int FlowNetwork::start(const vector<int>& path, double bytes, SimTime now, EventScheduler& scheduler,
+                       OnComplete on_complete) {
+    int f;
+    if (!free_flows.empty()) {
+        f = free_flows.back();
+        free_flows.pop_back();
+    } else {
+        f = static_cast<int>(flows.size());
+        flows.emplace_back();
+        flow_mark.push_back(0);
+    }
+
+    Flow& flow = flows[f];
+    flow.path.clear();
+    for (int l : path) {
+        if (l < 0 || static_cast<size_t>(l) >= links.size()) throw std::out_of_range("Unknown link in flow path");
+        if (links[l].capacity > 0 && std::find(flow.path.begin(), flow.path.end(), l) == flow.path.end())
+            flow.path.push_back(l);
+    }
+    flow.slot.assign(flow.path.size(), 0);
+    flow.remaining = std::max(bytes, 0.0);
+    flow.rate = 0.0;
+    flow.updated = now;
+    flow.active = true;
+    flow.on_complete = std::move(on_complete);
+    ++active_count;
+
+    if (flow.path.empty() || flow.remaining == 0.0) {
+        flow.path.clear();
+        schedule_completion(f, now, scheduler);
+        return f;
+    }
+    attach(f);
+    reallocate(flows[f].path, now, scheduler);
+    return f;
+}
+
+void FlowNetwork::cancel(int f, SimTime now, EventScheduler& scheduler) {
+    Flow& flow = flows[f];
+    if (!flow.active) return;
+    detach(f);
+    flow.active = false;
+    ++flow.generation;
+    flow.on_complete = nullptr;
+    --active_count;
+    free_flows.push_back(f);
+    reallocate(flow.path, now, scheduler);
+}
+
+void FlowNetwork::complete(int f, std::uint64_t generation, SimTime now, EventScheduler& scheduler) {
+    Flow& flow = flows[f];
+    if (!flow.active || flow.generation != generation) return;
+    detach(f);
+    flow.active = false;
+    --active_count;
+    OnComplete done = std::move(flow.on_complete);
+    flow.on_complete = nullptr;
+    free_flows.push_back(f);
+
+    //the freed bandwidth goes to the remaining flows before anyone reacts to the completion
+    reallocate(flow.path, now, scheduler);
+    if (done) done(now, scheduler);
+}
+
+double FlowNetwork::rate_mbps(int f) const {
+    return flows[f].active ? flows[f].rate * ticks_per_second * 8.0 / 1e6 : 0.0;
+}
+
+double FlowNetwork::remaining_bytes(int f, SimTime now) const {
+    const Flow& flow = flows[f];
+    if (!flow.active) return 0.0;
+    return std::max(flow.remaining - flow.rate * static_cast<double>(now - flow.updated), 0.0);
+}
+
+// ---------------- Private ----------------
+
+void FlowNetwork::attach(int f) {
+    Flow& flow = flows[f];
+    for (size_t i = 0; i < flow.path.size(); ++i) {
+        Link& link = links[flow.path[i]];
+        flow.slot[i] = link.flows.size();
+        link.flows.push_back(f);
+        link.flow_slot.push_back(i);
+    }
+}
+
+void FlowNetwork::detach(int f) {
+    Flow& flow = flows[f];
+    for (size_t i = 0; i < flow.path.size(); ++i) {
+        //swap-remove, fixing the slot of the flow that moves
+        Link& link = links[flow.path[i]];
+        size_t s = flow.slot[i];
+        int moved = link.flows.back();
+        size_t moved_index = link.flow_slot.back();
+        link.flows[s] = moved;
+        link.flow_slot[s] = moved_index;
+        flows[moved].slot[moved_index] = s;
+        link.flows.pop_back();
+        link.flow_slot.pop_back();
+    }
+}
+
+//the links and flows connected to `seeds` through shared flows
+void FlowNetwork::collect(const vector<int>& seeds) {
+    ++epoch;
+    component_links.clear();
+    component_flows.clear();
+    for (int l : seeds) {
+        if (link_mark[l] == epoch) continue;
+        link_mark[l] = epoch;
+        component_links.push_back(l);
+    }
+
+    //component_links doubles as the BFS queue
+    for (size_t next = 0; next < component_links.size(); ++next) {
+        for (int f : links[component_links[next]].flows) {
+            if (flow_mark[f] == epoch) continue;
+            flow_mark[f] = epoch;
+            component_flows.push_back(f);
+            for (int l : flows[f].path) {
+                if (link_mark[l] == epoch) continue;
+                link_mark[l] = epoch;
+                component_links.push_back(l);
+            }
+        }
+    }
+}
+
+//progressive filling: the link with the smallest fair share fixes the rate of all its unfrozen
+//flows, which then use up that share on every other link of their path
+void FlowNetwork::reallocate(const vector<int>& seeds, SimTime now, EventScheduler& scheduler) {
+    collect(seeds);
+    if (component_flows.empty()) return;
+
+    for (int f : component_flows) {
+        Flow& flow = flows[f];
+        flow.remaining = std::max(flow.remaining - flow.rate * static_cast<double>(now - flow.updated), 0.0);
+        flow.updated = now;
+    }
+
+    for (int l : component_links) {
+        link_left[l] = links[l].capacity;
+        link_unfrozen[l] = static_cast<int>(links[l].flows.size());
+        if (link_unfrozen[l] > 0) share_heap.push(l, link_left[l] / link_unfrozen[l]);
+    }
+
+    //a flow is frozen once flow_mark moves past the component's epoch
+    const std::uint64_t frozen = ++epoch;
+    while (!share_heap.empty()) {
+        int l = share_heap.top();
+        double share = share_heap.key(l);
+        share_heap.erase(l);
+
+        for (int f : links[l].flows) {
+            if (flow_mark[f] == frozen) continue;
+            flow_mark[f] = frozen;
+
+            Flow& flow = flows[f];
+            for (int other : flow.path) {
+                link_left[other] = std::max(link_left[other] - share, 0.0);
+                --link_unfrozen[other];
+                if (other == l || !share_heap.contains(other)) continue;
+                if (link_unfrozen[other] == 0) share_heap.erase(other);
+                else share_heap.update(other, link_left[other] / link_unfrozen[other]);
+            }
+
+            //flows whose rate did not move keep the completion event they already have
+            bool changed = std::abs(share - flow.rate) > 1e-12 * share || flow.rate == 0.0;
+            flow.rate = share;
+            if (changed) schedule_completion(f, now, scheduler);
+        }
+    }
+}
+
+void FlowNetwork::schedule_completion(int f, SimTime now, EventScheduler& scheduler) {
+    Flow& flow = flows[f];
+    SimTime after = 0;
+    if (flow.remaining > 0.0 && flow.rate > 0.0)
+        after = static_cast<SimTime>(std::ceil(flow.remaining / flow.rate));
+    scheduler.schedule(std::make_unique<FlowCompletionEvent>(now + after, *this, f, ++flow.generation));
+}
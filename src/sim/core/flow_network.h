@@ -0,0 +1,85 @@
+//flow_network.h models transfers as flows instead of packets: every active flow gets a rate, and
+//the flows crossing a link share its bandwidth by max-min fairness (no flow can get more without
+//taking it from one that has less). a flow's completion is scheduled from its rate and rescheduled
+//whenever the rate changes.
+//
+//starting or finishing a flow only changes the rates of flows it is connected to through shared
+//links, so each change re-runs progressive filling on that connected component alone; flows whose
+//rate comes out the same keep their completion event. superseded events stay in the queue and are
+//recognised by a generation counter when they fire.
+#pragma once
+#include "indexed_heap.h"
+#include "sim_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class EventScheduler;
+
+class FlowNetwork {
+public:
+    //called once the last byte has arrived
+    using OnComplete = std::function<void(SimTime now, EventScheduler& scheduler)>;
+
+private:
+    struct Link {
+        double capacity;                //bytes per tick; 0 is unlimited
+        std::vector<int> flows;
+        std::vector<std::size_t> flow_slot;     //parallel to flows: the link's index in that flow's path
+    };
+
+    struct Flow {
+        std::vector<int> path;          //limited links only
+        std::vector<std::size_t> slot;  //position of the flow in each path link's `flows`
+        double remaining = 0.0;         //bytes, as of `updated`
+        double rate = 0.0;              //bytes per tick
+        SimTime updated = 0;
+        std::uint64_t generation = 0;   //of the completion event that is current
+        bool active = false;
+        OnComplete on_complete;
+    };
+
+    double ticks_per_second;
+    std::vector<Link> links;
+    std::vector<Flow> flows;
+    std::vector<int> free_flows;
+    std::size_t active_count = 0;
+
+    //scratch reused by every reallocation; marks are epochs so they never need clearing
+    std::vector<std::uint64_t> link_mark, flow_mark;
+    std::uint64_t epoch = 0;
+    std::vector<int> component_links, component_flows;
+    std::vector<double> link_left;
+    std::vector<int> link_unfrozen;
+    IndexedMinHeap<double> share_heap;
+
+    void attach(int flow);
+    void detach(int flow);
+    void collect(const std::vector<int>& seeds);
+    void reallocate(const std::vector<int>& seeds, SimTime now, EventScheduler& scheduler);
+    void schedule_completion(int flow, SimTime now, EventScheduler& scheduler);
+
+public:
+    //SimTime ticks per second of simulated time; the default matches the millisecond latencies
+    explicit FlowNetwork(double ticks_per_second = 1000.0) : ticks_per_second(ticks_per_second) {}
+
+    //returns the link's id; 0 Mbps is unlimited
+    int add_link(double bandwidth_mbps);
+
+    //starts a transfer of `bytes` over the links of `path`; a path without a limited link (or an
+    //empty transfer) completes at `now`
+    int start(const std::vector<int>& path, double bytes, SimTime now, EventScheduler& scheduler,
+              OnComplete on_complete);
+
+    //stops a transfer early (e.g. the request timed out); on_complete is not called
+    void cancel(int flow, SimTime now, EventScheduler& scheduler);
+
+    //called by FlowCompletionEvent; stale generations are ignored
+    void complete(int flow, std::uint64_t generation, SimTime now, EventScheduler& scheduler);
+
+    double rate_mbps(int flow) const;
+    double remaining_bytes(int flow, SimTime now) const;
+    std::size_t active_flows() const { return active_count; }
+    std::size_t link_flows(int link) const { return links[link].flows.size(); }
+};
@@ -0,0 +1,85 @@
+//frame_pool.h is the allocator behind coroutine frames (process.h): size classes of 64 bytes up
+//to 2 KiB, each with a free list, carved from 64 KiB chunks. a request's frame is released when
+//the request ends and handed straight to the next one, so a steady workload stops allocating
+//after warm-up. every block starts with a pointer to its pool, so frames free themselves without
+//knowing which simulator they belong to; larger frames (or frames made without a pool) go to
+//the global heap
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+class FramePool {
+private:
+    static constexpr std::size_t GRANULE = 64;
+    static constexpr std::size_t CLASSES = 32;
+    static constexpr std::size_t CHUNK_BYTES = 64 * 1024;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    FreeBlock* free_lists[CLASSES] = {};
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* bump = nullptr;
+    std::size_t bump_left = 0;
+    std::size_t live = 0;
+
+    static std::size_t class_of(std::size_t bytes) { return (bytes + GRANULE - 1) / GRANULE - 1; }
+
+    void* take(std::size_t bytes) {
+        std::size_t c = class_of(bytes);
+        if (FreeBlock* b = free_lists[c]) {
+            free_lists[c] = b->next;
+            return b;
+        }
+        std::size_t size = (c + 1) * GRANULE;
+        if (bump_left < size) {
+            chunks.emplace_back(new std::byte[CHUNK_BYTES]);
+            bump = chunks.back().get();
+            bump_left = CHUNK_BYTES;
+        }
+        void* p = bump;
+        bump += size;
+        bump_left -= size;
+        return p;
+    }
+
+    void give_back(void* p, std::size_t bytes) {
+        std::size_t c = class_of(bytes);
+        free_lists[c] = new (p) FreeBlock{free_lists[c]};
+    }
+
+public:
+    //the pool pointer in front of each frame; keeps the frame itself 16-byte aligned
+    static constexpr std::size_t HEADER = 16;
+    static constexpr std::size_t MAX_POOLED = GRANULE * CLASSES;
+
+    FramePool() = default;
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    std::size_t live_frames() const { return live; }
+    std::size_t reserved_bytes() const { return chunks.size() * CHUNK_BYTES; }
+
+    static void* allocate(FramePool* pool, std::size_t frame_bytes) {
+        std::size_t bytes = frame_bytes + HEADER;
+        void* block = pool && bytes <= MAX_POOLED ? pool->take(bytes) : ::operator new(bytes);
+        if (bytes > MAX_POOLED) pool = nullptr;
+        if (pool) ++pool->live;
+        *static_cast<FramePool**>(block) = pool;
+        return static_cast<std::byte*>(block) + HEADER;
+    }
+
+    static void deallocate(void* frame, std::size_t frame_bytes) {
+        void* block = static_cast<std::byte*>(frame) - HEADER;
+        FramePool* pool = *static_cast<FramePool**>(block);
+        if (!pool) {
+            ::operator delete(block);
+            return;
+        }
+        --pool->live;
+        pool->give_back(block, frame_bytes + HEADER);
+    }
+};
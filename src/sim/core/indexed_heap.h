@@ -0,0 +1,92 @@
+//indexed_heap.h defines a binary min-heap over dense integer ids (0..n-1)
+//every id remembers its slot, so update/erase of an arbitrary id is O(log n)
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <typename Key>
+class IndexedMinHeap {
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    std::vector<int> heap;          //heap slot -> id
+    std::vector<std::size_t> pos;   //id -> heap slot (npos when absent)
+    std::vector<Key> keys;          //id -> key
+
+    //ties are broken on id so selection is deterministic across runs
+    bool less(int a, int b) const {
+        if (keys[a] < keys[b]) return true;
+        if (keys[b] < keys[a]) return false;
+        return a < b;
+    }
+
+    void place(std::size_t slot, int id) {
+        heap[slot] = id;
+        pos[id] = slot;
+    }
+
+    void sift_up(std::size_t slot) {
+        int id = heap[slot];
+        while (slot > 0) {
+            std::size_t parent = (slot - 1) / 2;
+            if (!less(id, heap[parent])) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, id);
+    }
+
+    void sift_down(std::size_t slot) {
+        int id = heap[slot];
+        const std::size_t n = heap.size();
+        while (true) {
+            std::size_t child = 2 * slot + 1;
+            if (child >= n) break;
+            if (child + 1 < n && less(heap[child + 1], heap[child])) ++child;
+            if (!less(heap[child], id)) break;
+            place(slot, heap[child]);
+            slot = child;
+        }
+        place(slot, id);
+    }
+
+public:
+    explicit IndexedMinHeap(std::size_t capacity = 0)
+        : pos(capacity, npos), keys(capacity) {
+        heap.reserve(capacity);
+    }
+
+    std::size_t size() const { return heap.size(); }
+    bool empty() const { return heap.empty(); }
+    bool contains(int id) const { return pos[id] != npos; }
+
+    int top() const { return heap.front(); }
+    const Key& key(int id) const { return keys[id]; }
+
+    void push(int id, Key k) {
+        keys[id] = std::move(k);
+        heap.push_back(id);
+        pos[id] = heap.size() - 1;
+        sift_up(pos[id]);
+    }
+
+    void update(int id, Key k) {
+        bool decreased = k < keys[id];
+        keys[id] = std::move(k);
+        if (decreased) sift_up(pos[id]);
+        else sift_down(pos[id]);
+    }
+
+    void erase(int id) {
+        std::size_t slot = pos[id];
+        int last = heap.back();
+        heap.pop_back();
+        pos[id] = npos;
+        if (slot == heap.size()) return;
+
+        place(slot, last);
+        sift_up(slot);
+        sift_down(pos[last]);
+    }
+};
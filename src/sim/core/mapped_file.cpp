@@ -0,0 +1,71 @@
+#include "mapped_file.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::size_t;
+using std::string;
+
+MappedFile::MappedFile(string path, size_t readahead)
+    : file_path(std::move(path)),
+      page(static_cast<size_t>(sysconf(_SC_PAGESIZE))) {
+    window = std::max(readahead, page);
+
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Cannot open " + file_path + ": " + std::strerror(errno));
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + file_path + ": " + std::strerror(err));
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        int err = errno;
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("Cannot map " + file_path + ": " + std::strerror(err));
+        base = static_cast<const char*>(p);
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        prefetch(0);
+    } else {
+        ::close(fd);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (base) ::munmap(const_cast<char*>(base), length);
+}
+
+void MappedFile::prefetch(size_t offset) {
+    char* start = const_cast<char*>(base);
+    size_t from = std::max(advised, offset / page * page);
+    size_t to = std::min(length, from + window);
+    if (to > from) ::madvise(start + from, to - from, MADV_WILLNEED);
+    advised = to;
+
+    //keep one window behind the reader and drop the rest; files of up to two windows stay resident
+    if (length > 2 * window && offset > window) {
+        size_t drop = (offset - window) / page * page;
+        if (drop > released) {
+            ::madvise(start + released, drop - released, MADV_DONTNEED);
+            released = drop;
+        }
+    }
+}
+
+void MappedFile::rewind() {
+    if (!base) return;
+    if (length > 2 * window) {
+        size_t from = released / page * page;
+        ::madvise(const_cast<char*>(base) + from, length - from, MADV_DONTNEED);
+    }
+    advised = 0;
+    released = 0;
+    prefetch(0);
+}
@@ -0,0 +1,41 @@
+//mapped_file.h maps a read-only file for one forward pass, e.g. a multi-GB request log replayed by
+//TraceSource. the reader reports its position with advance(); the next `readahead` bytes are
+//requested from the kernel ahead of it and the pages it has left behind are released, so the
+//resident part of the file stays around two windows however large the file is.
+//
+//POSIX mmap/madvise only
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+private:
+    std::string file_path;
+    const char* base = nullptr;
+    std::size_t length = 0;
+    std::size_t window;
+    std::size_t page;
+    std::size_t advised = 0;    //readahead requested up to here
+    std::size_t released = 0;   //pages before this have been dropped
+
+    void prefetch(std::size_t offset);
+
+public:
+    explicit MappedFile(std::string path, std::size_t readahead = 8 << 20);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::string& path() const { return file_path; }
+    std::size_t size() const { return length; }
+    std::string_view bytes() const { return {base, length}; }
+
+    //the reader is at `offset`; called often, does nothing until a window has been crossed
+    void advance(std::size_t offset) {
+        if (advised < length && offset + window / 2 >= advised) prefetch(offset);
+    }
+
+    //a new pass from the start (looping replay)
+    void rewind();
+};
@@ -0,0 +1,108 @@
+#include "process.h"
+#include <memory>
+
+using std::size_t;
+
+namespace {
+
+//ResumeEvents are all the same size and short-lived: recycle them instead of hitting the heap.
+//the list belongs to the thread and is returned to the heap when the thread exits
+struct FreeEvent {
+    FreeEvent* next;
+};
+
+struct FreeEvents {
+    FreeEvent* head = nullptr;
+
+    ~FreeEvents() {
+        while (FreeEvent* e = head) {
+            head = e->next;
+            ::operator delete(e);
+        }
+    }
+};
+
+thread_local FreeEvents free_events;
+
+}
+
+void* ResumeEvent::operator new(size_t bytes) {
+    if (bytes == sizeof(ResumeEvent) && free_events.head) {
+        FreeEvent* e = free_events.head;
+        free_events.head = e->next;
+        return e;
+    }
+    return ::operator new(bytes);
+}
+
+void ResumeEvent::operator delete(void* p, size_t bytes) {
+    if (bytes != sizeof(ResumeEvent)) {
+        ::operator delete(p);
+        return;
+    }
+    free_events.head = new (p) FreeEvent{free_events.head};
+}
+
+void ResumeEvent::execute(const SimulationContext&, SimulationState&, EventScheduler&) {
+    env.current = time;
+    try {
+        handle.resume();
+    } catch (...) {
+        //only a detached process rethrows; it is left suspended at its end with nobody to free it
+        if (handle.done()) handle.destroy();
+        throw;
+    }
+}
+
+void ProcessEnv::resume_at(SimTime time, std::coroutine_handle<> handle) {
+    scheduler.schedule(std::make_unique<ResumeEvent>(time, *this, handle));
+}
+
+void ProcessEnv::spawn(Process process, SimTime at) {
+    Process::Handle h = std::exchange(process.handle, {});
+    h.promise().env = this;
+    h.promise().detached = true;
+    resume_at(at, h);
+}
+
+//a finished child hands control back to its caller through the queue, with the event made when
+//the caller started waiting; a detached process is done
+std::coroutine_handle<> Process::FinalAwaiter::await_suspend(Handle h) noexcept {
+    promise_type& p = h.promise();
+    if (p.detached) {
+        h.destroy();
+        return std::noop_coroutine();
+    }
+    if (!p.resume) return std::noop_coroutine();
+    p.resume->time = p.env->now();
+    try {
+        p.env->events().schedule(std::move(p.resume));
+    } catch (...) {
+        //the queue could not grow; the caller goes on at once, still in this instant
+        return p.continuation;
+    }
+    return std::noop_coroutine();
+}
+
+//a detached process has nobody to report to, so its exception ends the run
+void Process::promise_type::unhandled_exception() {
+    if (detached) throw;
+    error = std::current_exception();
+}
+
+void Slots::release() {
+    if (waiting.empty()) {
+        ++free;
+        return;
+    }
+    std::coroutine_handle<> next = waiting.front();
+    waiting.pop_front();
+    env.resume_at(env.now(), next);
+}
+
+void Transfer::await_suspend(std::coroutine_handle<> h) {
+    ProcessEnv* e = &env;
+    network.start(path, bytes, env.now(), env.events(), [e, h](SimTime now, EventScheduler&) {
+        e->resume_at(now, h);
+    });
+}
@@ -0,0 +1,231 @@
+//process.h lets a request's lifecycle be written as one coroutine instead of a chain of events:
+//
+//  Process request(ProcessEnv& env, Slots& api, FlowNetwork& net, std::vector<int> path) {
+//      auto slot = co_await api.acquire();
+//      co_await env.delay(5);
+//      co_await transfer(env, net, path, 64 * 1024);
+//      co_await query_db(env);                     //another Process
+//  }
+//  env.spawn(request(env, api, net, path), arrival_time);
+//
+//every resumption (a delay ending, a slot freeing up, a child finishing, a transfer completing)
+//is a ResumeEvent on the simulator's queue, so coroutines interleave with plain events in the
+//queue's order and a run stays deterministic. frames come from the ProcessEnv's FramePool when
+//the coroutine's first parameter is the ProcessEnv&; ResumeEvents come from a free list, so a hop
+//allocates nothing once the run is warm (bench/process_hops.cpp measures a hop against plain events).
+//
+//needs C++20 coroutines; the rest of the simulator builds as C++17 without this header
+#pragma once
+#if !defined(__cpp_impl_coroutine)
+#error "process.h needs C++20 coroutines"
+#endif
+#include "flow_network.h"
+#include "frame_pool.h"
+#include "scheduler.h"
+#include "sim_types.h"
+#include "../events/event.h"
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class ProcessEnv;
+class Process;
+
+//resumes one suspended coroutine; instances are recycled through a free list
+class ResumeEvent final : public Event {
+private:
+    ProcessEnv& env;
+    std::coroutine_handle<> handle;
+
+public:
+    ResumeEvent(SimTime time, ProcessEnv& env, std::coroutine_handle<> handle)
+        : Event(time), env(env), handle(handle) {}
+
+    void execute(const SimulationContext& context, SimulationState& state, EventScheduler& scheduler) override;
+
+    static void* operator new(std::size_t bytes);
+    static void operator delete(void* p, std::size_t bytes);
+};
+
+//one per simulator run: owns the frame pool and knows the current time inside coroutines
+class ProcessEnv {
+private:
+    EventScheduler& scheduler;
+    FramePool pool;
+    SimTime current = 0;
+
+    friend class ResumeEvent;
+
+public:
+    explicit ProcessEnv(EventScheduler& scheduler) : scheduler(scheduler) {}
+    ProcessEnv(const ProcessEnv&) = delete;
+    ProcessEnv& operator=(const ProcessEnv&) = delete;
+
+    SimTime now() const { return current; }
+    EventScheduler& events() { return scheduler; }
+    FramePool& frames() { return pool; }
+
+    void resume_at(SimTime time, std::coroutine_handle<> handle);
+
+    struct Delay {
+        ProcessEnv& env;
+        SimTime ticks;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { env.resume_at(env.now() + ticks, h); }
+        void await_resume() const noexcept {}
+    };
+
+    //a zero delay still yields: everything already queued for this instant runs first
+    Delay delay(SimTime ticks) { return {*this, ticks}; }
+
+    //runs `process` detached from `at` on; its frame is freed when it finishes
+    void spawn(Process process, SimTime at);
+};
+
+//a coroutine that can be spawned (runs detached, frees itself when done) or co_awaited by another
+//Process (the caller resumes once it has finished, and sees its exception if it threw)
+class Process {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+private:
+    Handle handle;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle h) noexcept;
+        void await_resume() const noexcept {}
+    };
+
+    friend class ProcessEnv;
+
+public:
+    struct promise_type {
+        ProcessEnv* env = nullptr;
+        std::coroutine_handle<> continuation;
+        std::unique_ptr<ResumeEvent> resume;    //wakes the continuation; final_suspend must not allocate
+        std::exception_ptr error;
+        bool detached = false;
+
+        promise_type() = default;
+        template <typename... Args>
+        explicit promise_type(ProcessEnv& env, Args&...) : env(&env) {}
+
+        static void* operator new(std::size_t bytes) { return FramePool::allocate(nullptr, bytes); }
+        template <typename... Args>
+        static void* operator new(std::size_t bytes, ProcessEnv& env, Args&...) {
+            return FramePool::allocate(&env.frames(), bytes);
+        }
+        static void operator delete(void* frame, std::size_t bytes) { FramePool::deallocate(frame, bytes); }
+
+        Process get_return_object() { return Process(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception();
+    };
+
+    explicit Process(Handle h) : handle(h) {}
+    Process(Process&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Process& operator=(Process&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~Process() {
+        if (handle) handle.destroy();
+    }
+
+    struct Awaiter {
+        Handle child;
+
+        bool await_ready() const noexcept { return false; }
+
+        //the child starts straight away, inside the caller's instant
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> caller) {
+            promise_type& p = child.promise();
+            if (!p.env) p.env = caller.promise().env;
+            p.continuation = caller;
+            p.resume = std::make_unique<ResumeEvent>(0, *p.env, caller);
+            return child;
+        }
+
+        void await_resume() const {
+            if (child.promise().error) std::rethrow_exception(child.promise().error);
+        }
+    };
+
+    Awaiter operator co_await() & { return {handle}; }
+    Awaiter operator co_await() && { return {handle}; }
+};
+
+//a pool of n service slots (threads, connections); waiters are served first come, first served
+class Slots {
+private:
+    ProcessEnv& env;
+    std::size_t free;
+    std::deque<std::coroutine_handle<>> waiting;
+
+public:
+    //holds a slot until destroyed or released
+    class Hold {
+    private:
+        Slots* slots;
+
+    public:
+        explicit Hold(Slots* slots) : slots(slots) {}
+        Hold(Hold&& other) noexcept : slots(std::exchange(other.slots, nullptr)) {}
+        Hold& operator=(Hold&&) = delete;
+        ~Hold() { release(); }
+
+        void release() {
+            if (slots) std::exchange(slots, nullptr)->release();
+        }
+    };
+
+    //a waiter is resumed with the slot already handed over by release()
+    struct Acquire {
+        Slots& slots;
+
+        bool await_ready() noexcept {
+            if (slots.free == 0 || !slots.waiting.empty()) return false;
+            --slots.free;
+            return true;
+        }
+        void await_suspend(std::coroutine_handle<> h) { slots.waiting.push_back(h); }
+        Hold await_resume() noexcept { return Hold(&slots); }
+    };
+
+    Slots(ProcessEnv& env, std::size_t n) : env(env), free(n) {}
+
+    Acquire acquire() { return {*this}; }
+    void release();
+
+    std::size_t available() const { return free; }
+    std::size_t queued() const { return waiting.size(); }
+};
+
+//moves `bytes` over `path` as a FlowNetwork flow and resumes when the last byte has arrived
+struct Transfer {
+    ProcessEnv& env;
+    FlowNetwork& network;
+    const std::vector<int>& path;
+    double bytes;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+};
+
+inline Transfer transfer(ProcessEnv& env, FlowNetwork& network, const std::vector<int>& path, double bytes) {
+    return {env, network, path, bytes};
+}
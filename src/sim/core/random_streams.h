@@ -0,0 +1,51 @@
+//random_streams.h gives every consumer of randomness its own named stream
+//a stream is a pure function of (seed, replica, name), so two runs of the same replica
+//draw identical numbers for the same purpose even when the model parameters differ
+//(common random numbers); copying RandomStreams forks every stream at its current position
+#pragma once
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+
+class RandomStreams {
+private:
+    uint64_t seed;
+    uint64_t replica_index;
+    std::map<std::string, std::mt19937_64, std::less<>> streams;
+
+    static uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t hash_name(std::string_view name) {
+        uint64_t h = 0xcbf29ce484222325ULL; //FNV-1a, stable across platforms unlike std::hash
+        for (unsigned char c : name) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+public:
+    RandomStreams(uint64_t seed, uint64_t replica)
+        : seed(seed), replica_index(replica) {}
+
+    uint64_t replica() const { return replica_index; }
+
+    //seed for a stream that is owned elsewhere (e.g. an entity's own engine)
+    uint64_t seed_for(std::string_view name) const {
+        return mix(mix(seed ^ mix(replica_index)) ^ hash_name(name));
+    }
+
+    std::mt19937_64& stream(std::string_view name) {
+        auto it = streams.find(name);
+        if (it == streams.end())
+            it = streams.emplace(std::string(name), std::mt19937_64(seed_for(name))).first;
+        return it->second;
+    }
+};
@@ -1,8 +1,8 @@
 #pragma once
+#include "event_queue.h"
 #include <memory>
 
 class Event;
-class EventQueue;
 
 class EventScheduler {
 private:
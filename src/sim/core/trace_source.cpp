@@ -0,0 +1,267 @@
+#include "trace_source.h"
+#include "event_queue.h"
+#include "scheduler.h"
+#include "../events/trace_arrival_event.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+
+constexpr char BINARY_MAGIC[8] = {'S', 'I', 'M', 'T', 'R', 'C', '0', '1'};
+constexpr size_t BINARY_HEADER = 16;
+constexpr size_t BINARY_RECORD = 16;
+
+string_view trim(string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+    if (s.size() >= 2 && s.front() == '"' && s.back() == '"') s = s.substr(1, s.size() - 2);
+    return s;
+}
+
+//splits a line into at most `wanted` fields; a double-quoted field may contain the delimiter
+void split_fields(string_view line, char delimiter, size_t wanted, vector<string_view>& out) {
+    out.clear();
+    size_t i = 0;
+    while (out.size() < wanted && i <= line.size()) {
+        size_t begin = i;
+        bool quoted = false;
+        while (i < line.size() && (quoted || line[i] != delimiter)) {
+            if (line[i] == '"') quoted = !quoted;
+            ++i;
+        }
+        out.push_back(trim(line.substr(begin, i - begin)));
+        ++i;
+    }
+}
+
+//the line starting at `at` (without its newline); `at` moves past it
+string_view take_line(string_view data, size_t& at) {
+    size_t end = data.find('\n', at);
+    if (end == string_view::npos) end = data.size();
+    string_view line = data.substr(at, end - at);
+    at = std::min(data.size(), end + 1);
+    return line;
+}
+
+//finite numbers only; from_chars also accepts inf and nan
+bool parse_number(string_view field, double& out) {
+    const char* end = field.data() + field.size();
+    auto [p, ec] = std::from_chars(field.data(), end, out);
+    return ec == std::errc() && p == end && std::isfinite(out);
+}
+
+int column_index(const vector<string_view>& header, const string& name, const string& path) {
+    if (header.empty()) {
+        double index;
+        if (!parse_number(name, index) || index < 0 || index != std::floor(index))
+            throw std::invalid_argument(path + ": column '" + name + "' must be an index without a header");
+        return static_cast<int>(index);
+    }
+    for (size_t i = 0; i < header.size(); ++i) {
+        if (header[i] == name) return static_cast<int>(i);
+    }
+    throw std::invalid_argument(path + ": no column '" + name + "'");
+}
+
+}
+
+TraceSource::TraceSource(TraceReplayConfig config, OnArrival on_arrival)
+    : config(std::move(config)),
+      on_arrival(std::move(on_arrival)) {
+    if (!(this->config.time_scale > 0.0) || !(this->config.ticks_per_second > 0.0))
+        throw std::invalid_argument("Trace time_scale and ticks_per_second must be positive");
+
+    streams.resize(this->config.streams.size());
+    for (size_t i = 0; i < streams.size(); ++i) {
+        streams[i].config = this->config.streams[i];
+        streams[i].pending.stream = i;
+        open(streams[i]);
+    }
+
+    //a shared origin and period keep the streams aligned with each other, also across loops
+    bool any = false;
+    double end = 0.0;
+    for (const Stream& s : streams) {
+        if (s.empty) continue;
+        double first = s.first * s.config.time_unit, last = s.last * s.config.time_unit;
+        origin = any ? std::min(origin, first) : first;
+        end = any ? std::max(end, last) : last;
+        any = true;
+    }
+    double span = std::max(0.0, end - origin) * this->config.time_scale * this->config.ticks_per_second;
+    period = std::max<SimTime>(1, static_cast<SimTime>(std::llround(span)) + this->config.loop_gap);
+}
+
+void TraceSource::open(Stream& s) {
+    const TraceStreamConfig& c = s.config;
+    s.file = std::make_unique<MappedFile>(c.path, config.readahead_bytes);
+    string_view data = s.file->bytes();
+
+    if (c.format == TraceFormat::BINARY) {
+        if (data.size() < BINARY_HEADER || std::memcmp(data.data(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+            throw std::runtime_error(c.path + ": not a binary trace");
+        std::uint32_t record;
+        std::memcpy(&record, data.data() + 8, sizeof(record));
+        if (record != BINARY_RECORD)
+            throw std::runtime_error(c.path + ": unsupported record size " + std::to_string(record));
+        if ((data.size() - BINARY_HEADER) % BINARY_RECORD != 0)
+            throw std::runtime_error(c.path + ": truncated record");
+        s.begin = BINARY_HEADER;
+    } else {
+        vector<string_view> header;
+        size_t at = 0;
+        if (c.header) {
+            while (at < data.size() && header.empty()) {
+                string_view line = trim(take_line(data, at));
+                ++s.line;
+                if (!line.empty()) split_fields(line, c.delimiter, static_cast<size_t>(-1), header);
+            }
+            if (header.empty()) return;     //no header, no records
+        }
+        s.time_field = column_index(header, c.time_column, c.path);
+        s.route_field = column_index(header, c.route_column, c.path);
+        if (!c.bytes_column.empty()) s.bytes_field = column_index(header, c.bytes_column, c.path);
+        s.begin = at;
+    }
+
+    //the last record, read from the end without scanning the file (its line number is unknown)
+    s.header_lines = s.line;
+    s.line = static_cast<size_t>(-1);
+    double time, bytes;
+    int route;
+    if (c.format == TraceFormat::BINARY) {
+        if (data.size() == s.begin) return;
+        s.cursor = data.size() - BINARY_RECORD;
+    } else {
+        size_t end = data.size();
+        while (end > s.begin && (data[end - 1] == '\n' || data[end - 1] == '\r' ||
+                                 data[end - 1] == ' ' || data[end - 1] == '\t')) --end;
+        if (end == s.begin) return;
+        size_t nl = data.rfind('\n', end - 1);
+        s.cursor = nl == string_view::npos || nl < s.begin ? s.begin : nl + 1;
+    }
+    read(s, time, route, bytes);
+    s.last = time;
+    s.file->rewind();
+
+    s.cursor = s.begin;
+    s.line = s.header_lines;
+    read(s, time, route, bytes);
+    s.first = time;
+    s.empty = false;
+
+    s.cursor = s.begin;
+    s.line = s.header_lines;
+    s.previous = s.first;
+}
+
+//the record at the cursor; false at the end of the file
+bool TraceSource::read(Stream& s, double& time, int& route, double& bytes) {
+    string_view data = s.file->bytes();
+    const TraceStreamConfig& c = s.config;
+    s.file->advance(s.cursor);
+
+    if (c.format == TraceFormat::BINARY) {
+        if (s.cursor + BINARY_RECORD > data.size()) return false;
+        std::uint32_t r, b;
+        std::memcpy(&time, data.data() + s.cursor, 8);
+        std::memcpy(&r, data.data() + s.cursor + 8, 4);
+        std::memcpy(&b, data.data() + s.cursor + 12, 4);
+        if (!std::isfinite(time))
+            throw std::runtime_error(c.path + ": bad timestamp at byte " + std::to_string(s.cursor));
+        s.cursor += BINARY_RECORD;
+        route = static_cast<int>(r);
+        bytes = b;
+        return true;
+    }
+
+    size_t wanted = static_cast<size_t>(std::max({s.time_field, s.route_field, s.bytes_field})) + 1;
+    while (s.cursor < data.size()) {
+        string_view line = take_line(data, s.cursor);
+        ++s.line;
+        if (trim(line).empty()) continue;
+
+        split_fields(line, c.delimiter, wanted, fields);
+        auto fail = [&](const char* what) {
+            string where = s.line ? ":" + std::to_string(s.line) : " (last record)";
+            return std::runtime_error(c.path + where + ": " + what);
+        };
+        if (fields.size() < wanted) throw fail("missing columns");
+        if (!parse_number(fields[s.time_field], time)) throw fail("bad timestamp");
+        bytes = 0.0;
+        if (s.bytes_field >= 0 && !parse_number(fields[s.bytes_field], bytes)) throw fail("bad size");
+
+        auto it = config.routes.find(fields[s.route_field]);
+        route = it != config.routes.end() ? it->second : config.default_route;
+        return true;
+    }
+    return false;
+}
+
+SimTime TraceSource::to_ticks(const Stream& s, double time) const {
+    double offset = (time - s.first) * s.config.time_unit + (s.first * s.config.time_unit - origin);
+    double ticks = std::max(0.0, offset) * config.time_scale * config.ticks_per_second;
+    return config.start + s.pass * period + static_cast<SimTime>(std::llround(ticks));
+}
+
+//parses the stream's next request into `pending`; false once the stream is finished
+bool TraceSource::next(size_t stream) {
+    Stream& s = streams[stream];
+    if (s.empty) return false;
+
+    double time, bytes;
+    int route;
+    while (true) {
+        if (!read(s, time, route, bytes)) {
+            //a pass in which every request was skipped would loop forever
+            if (!s.mapped_this_pass) return false;
+            if (config.loops != 0 && s.pass + 1 >= config.loops) return false;
+            ++s.pass;
+            s.file->rewind();
+            s.cursor = s.begin;
+            s.line = s.header_lines;
+            s.previous = s.first;
+            s.mapped_this_pass = false;
+            continue;
+        }
+        if (time < s.previous) {
+            time = s.previous;
+            ++reordered_count;
+        }
+        s.previous = time;
+        if (route < 0) {
+            ++skipped_count;
+            continue;
+        }
+        s.mapped_this_pass = true;
+
+        //a record past the span of `last` could otherwise land behind the next pass's first one
+        SimTime at = std::max(to_ticks(s, time), s.pending.time);
+        if (at >= config.until) return false;
+        s.pending.time = at;
+        s.pending.route = route;
+        s.pending.bytes = bytes;
+        return true;
+    }
+}
+
+void TraceSource::start(EventScheduler& scheduler) {
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (next(i)) scheduler.schedule(std::make_unique<TraceArrivalEvent>(streams[i].pending.time, *this, i));
+    }
+}
+
+void TraceSource::arrive(size_t stream, EventScheduler& scheduler) {
+    ++delivered_count;
+    on_arrival(streams[stream].pending, scheduler);
+    if (next(stream))
+        scheduler.schedule(std::make_unique<TraceArrivalEvent>(streams[stream].pending.time, *this, stream));
+}
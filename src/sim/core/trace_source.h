@@ -0,0 +1,128 @@
+//trace_source.h replays recorded request logs as arrivals, for traffic the synthetic workload
+//patterns do not capture. every log is a stream read in place through a MappedFile; a stream has
+//exactly one pending TraceArrivalEvent, and the next record is parsed only when that event fires,
+//so a multi-GB log costs one record and a readahead window of memory.
+//
+//formats
+//  CSV     one request per line; the columns holding the timestamp (a number in `time_unit`
+//          seconds, e.g. epoch milliseconds with time_unit 1e-3), the route and optionally the
+//          payload size are found by name in the header line, or given as 0-based indices.
+//          fields may be double-quoted (without embedded quotes); blank lines are skipped.
+//  BINARY  "SIMTRC01" | u32 record bytes (16) | u32 reserved, then records of
+//          f64 time | u32 route | u32 bytes, little-endian; the route is already an index.
+//
+//times: all streams share one origin (the earliest first record), so their relative offsets are
+//kept; a record lands at start + (time - origin) * time_unit * time_scale seconds. a time_scale
+//of 0.5 replays twice as fast. a record earlier than its predecessor in the same stream is moved
+//up to it (counted in reordered()). inf and nan timestamps are rejected as bad timestamps.
+//looping: at its end a stream starts over one period later, where the period is the span of all
+//streams plus loop_gap, so the streams stay aligned across passes. replay stops after `loops`
+//passes (0 = no limit) or at `until`, whichever is first.
+#pragma once
+#include "mapped_file.h"
+#include "sim_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class EventScheduler;
+
+enum class TraceFormat {
+    CSV,
+    BINARY
+};
+
+struct TraceStreamConfig {
+    std::string path;
+    TraceFormat format = TraceFormat::CSV;
+
+    //CSV
+    char delimiter = ',';
+    bool header = true;
+    std::string time_column = "timestamp";  //column name, or its index without a header
+    std::string route_column = "route";
+    std::string bytes_column;               //optional
+    double time_unit = 1e-3;                //seconds per unit of the timestamp (and of BINARY times)
+};
+
+struct TraceReplayConfig {
+    std::vector<TraceStreamConfig> streams;
+
+    std::map<std::string, int, std::less<>> routes;    //CSV route field -> route index
+    int default_route = -1;                             //unmapped field; -1 skips the request
+
+    double ticks_per_second = 1000.0;
+    double time_scale = 1.0;
+    SimTime start = 0;
+    unsigned loops = 1;
+    SimTime loop_gap = 0;
+    SimTime until = std::numeric_limits<SimTime>::max();
+
+    std::size_t readahead_bytes = 8 << 20;
+};
+
+struct TraceRequest {
+    SimTime time;
+    int route;
+    double bytes;           //0 without a bytes column
+    std::size_t stream;
+};
+
+class TraceSource {
+public:
+    using OnArrival = std::function<void(const TraceRequest& request, EventScheduler& scheduler)>;
+
+private:
+    struct Stream {
+        TraceStreamConfig config;
+        std::unique_ptr<MappedFile> file;
+        std::size_t begin = 0;          //first record
+        std::size_t cursor = 0;
+        std::size_t line = 0;           //CSV, for error messages
+        std::size_t header_lines = 0;
+        int time_field = -1, route_field = -1, bytes_field = -1;
+
+        double first = 0.0, last = 0.0; //trace time of the first / last record
+        double previous = 0.0;
+        unsigned pass = 0;
+        bool mapped_this_pass = false;
+        bool empty = true;
+        TraceRequest pending{};
+    };
+
+    TraceReplayConfig config;
+    OnArrival on_arrival;
+    std::vector<Stream> streams;
+    double origin = 0.0;
+    SimTime period = 0;
+    std::vector<std::string_view> fields;   //CSV scratch
+
+    std::size_t delivered_count = 0;
+    std::size_t skipped_count = 0;
+    std::size_t reordered_count = 0;
+
+    void open(Stream& s);
+    bool read(Stream& s, double& time, int& route, double& bytes);
+    bool next(std::size_t stream);
+    SimTime to_ticks(const Stream& s, double time) const;
+
+public:
+    TraceSource(TraceReplayConfig config, OnArrival on_arrival);
+
+    //schedules the first arrival of every stream
+    void start(EventScheduler& scheduler);
+
+    //TraceArrivalEvent: hands the stream's pending request over and schedules its next one
+    void arrive(std::size_t stream, EventScheduler& scheduler);
+
+    std::size_t delivered() const { return delivered_count; }
+    std::size_t skipped() const { return skipped_count; }      //unmapped routes
+    std::size_t reordered() const { return reordered_count; }
+    SimTime loop_period() const { return period; }
+};
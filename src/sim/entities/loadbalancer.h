@@ -0,0 +1,209 @@
+#pragma once
+#include "../core/base_entity.h"
+#include "../core/indexed_heap.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+enum class LoadBalancingAlgorithm {
+    ROUND_ROBIN,
+    LEAST_CONNECTIONS,
+    IP_HASH,
+    RANDOM,
+    WEIGHTED_ROUND_ROBIN,
+    POWER_OF_TWO_CHOICES
+};
+
+//every selection path is O(1) or O(log n) in the number of backends:
+//  ROUND_ROBIN / RANDOM / IP_HASH -> dense array of live backends
+//  LEAST_CONNECTIONS              -> indexed min-heap on active connections
+//  POWER_OF_TWO_CHOICES           -> two random live backends, fewer connections wins
+//  WEIGHTED_ROUND_ROBIN           -> smooth WRR as stride scheduling on an indexed heap
+//backend faults remove/reinsert a single backend from these structures incrementally
+class LoadBalancerEntity final : public BaseEntity {
+public:
+    static constexpr int NO_BACKEND = -1;
+
+    // ---- context ----
+    const LoadBalancingAlgorithm algorithm;
+    const std::vector<std::string> backends;
+    const std::vector<int> weights;
+    const double latency_mean;
+    const double failure_prob;
+
+    // ---- state ----
+    bool is_down = false;
+
+    LoadBalancerEntity(
+        std::string id,
+        LoadBalancingAlgorithm algorithm,
+        std::vector<std::string> backends,
+        std::vector<int> weights,
+        double latency_mean,
+        double failure_prob,
+        uint64_t seed = 0
+    )
+        : BaseEntity(std::move(id)),
+          algorithm(algorithm),
+          backends(std::move(backends)),
+          weights(normalise_weights(std::move(weights), this->backends.size())),
+          latency_mean(latency_mean),
+          failure_prob(failure_prob),
+          active(this->backends.size(), 0),
+          live_pos(this->backends.size(), NOT_LIVE),
+          conn_heap(this->backends.size()),
+          stride_heap(this->backends.size()),
+          rng(seed) {
+        for (int b = 0; b < backend_count(); ++b) {
+            if (algorithm == LoadBalancingAlgorithm::WEIGHTED_ROUND_ROBIN && this->weights[b] <= 0)
+                continue; //zero weight never receives traffic
+            mark_live(b);
+        }
+    }
+
+    std::unique_ptr<BaseEntity> clone() const override {
+        return std::make_unique<LoadBalancerEntity>(*this);
+    }
+
+    int backend_count() const { return static_cast<int>(backends.size()); }
+    int live_backends() const { return static_cast<int>(live.size()); }
+    bool backend_down(int b) const { return live_pos[b] == NOT_LIVE; }
+    int connections(int b) const { return active[b]; }
+
+    //chooses a backend for a new request and counts it as an active connection
+    //client_key is only consulted by IP_HASH; returns NO_BACKEND when all backends are down
+    int pick(uint64_t client_key = 0) {
+        if (live.empty()) return NO_BACKEND;
+
+        int b = NO_BACKEND;
+        switch (algorithm) {
+        case LoadBalancingAlgorithm::ROUND_ROBIN:
+            if (rr_cursor >= live.size()) rr_cursor = 0;
+            b = live[rr_cursor++];
+            break;
+
+        case LoadBalancingAlgorithm::LEAST_CONNECTIONS:
+            b = conn_heap.top();
+            break;
+
+        case LoadBalancingAlgorithm::IP_HASH: {
+            //keep a client on its home backend; only clients of a down backend move
+            uint64_t h = mix(client_key);
+            b = static_cast<int>(h % backends.size());
+            if (backend_down(b)) b = live[mix(h) % live.size()];
+            break;
+        }
+
+        case LoadBalancingAlgorithm::RANDOM:
+            b = live[uniform(live.size())];
+            break;
+
+        case LoadBalancingAlgorithm::POWER_OF_TWO_CHOICES: {
+            int x = live[uniform(live.size())];
+            int y = live[uniform(live.size())];
+            b = active[y] < active[x] ? y : x;
+            break;
+        }
+
+        case LoadBalancingAlgorithm::WEIGHTED_ROUND_ROBIN:
+            b = stride_heap.top();
+            virtual_time = stride_heap.key(b);
+            stride_heap.update(b, virtual_time + stride(b));
+            break;
+        }
+
+        ++active[b];
+        if (conn_heap.contains(b)) conn_heap.update(b, active[b]);
+        return b;
+    }
+
+    //a request routed to backend b finished (successfully or not)
+    void on_complete(int b) {
+        if (active[b] > 0) --active[b];
+        if (conn_heap.contains(b)) conn_heap.update(b, active[b]);
+    }
+
+    //fault injection hook: takes a backend out of / back into rotation
+    void set_backend_down(int b, bool down) {
+        if (down == backend_down(b)) return;
+        if (down) unmark_live(b);
+        else if (algorithm != LoadBalancingAlgorithm::WEIGHTED_ROUND_ROBIN || weights[b] > 0) mark_live(b);
+    }
+
+    void reseed(uint64_t seed) override { rng.seed(seed); }
+
+    //carries the mutable state of a warmed-up balancer over to one rebuilt with a new context
+    void adopt_state(const LoadBalancerEntity& warmed) {
+        is_down = warmed.is_down;
+        if (warmed.backend_count() != backend_count()) return; //different pool, nothing to carry
+
+        active = warmed.active;
+        rr_cursor = warmed.rr_cursor;
+        virtual_time = warmed.virtual_time;
+        rng = warmed.rng;
+        for (int b = 0; b < backend_count(); ++b) {
+            set_backend_down(b, warmed.backend_down(b));
+            if (conn_heap.contains(b)) conn_heap.update(b, active[b]);
+            if (stride_heap.contains(b) && warmed.stride_heap.contains(b))
+                stride_heap.update(b, warmed.stride_heap.key(b));
+        }
+    }
+
+private:
+    static constexpr std::size_t NOT_LIVE = static_cast<std::size_t>(-1);
+
+    std::vector<int> active;            //backend -> active connections
+    std::vector<int> live;              //dense list of backends currently up
+    std::vector<std::size_t> live_pos;  //backend -> slot in live (NOT_LIVE when down)
+    std::size_t rr_cursor = 0;
+
+    IndexedMinHeap<int> conn_heap;      //LEAST_CONNECTIONS only
+    IndexedMinHeap<double> stride_heap; //WEIGHTED_ROUND_ROBIN only: next virtual pass per backend
+    double virtual_time = 0.0;
+
+    std::mt19937_64 rng;
+
+    static std::vector<int> normalise_weights(std::vector<int> w, std::size_t n) {
+        w.resize(n, 1); //missing weights default to 1
+        return w;
+    }
+
+    static uint64_t mix(uint64_t x) {
+        //splitmix64 finaliser, spreads sequential client keys over all backends
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    std::size_t uniform(std::size_t n) {
+        return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng);
+    }
+
+    double stride(int b) const { return 1.0 / weights[b]; }
+
+    void mark_live(int b) {
+        live_pos[b] = live.size();
+        live.push_back(b);
+
+        if (algorithm == LoadBalancingAlgorithm::LEAST_CONNECTIONS)
+            conn_heap.push(b, active[b]);
+        if (algorithm == LoadBalancingAlgorithm::WEIGHTED_ROUND_ROBIN)
+            //half a stride ahead of the current virtual time interleaves it smoothly instead of bursting
+            stride_heap.push(b, virtual_time + stride(b) / 2);
+    }
+
+    void unmark_live(int b) {
+        //swap-remove keeps the live array dense in O(1)
+        std::size_t slot = live_pos[b];
+        int last = live.back();
+        live[slot] = last;
+        live_pos[last] = slot;
+        live.pop_back();
+        live_pos[b] = NOT_LIVE;
+
+        if (conn_heap.contains(b)) conn_heap.erase(b);
+        if (stride_heap.contains(b)) stride_heap.erase(b);
+    }
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include "../core/base_entity.h"
+#include "../core/flow_network.h"
 #include <string>
 
 class NetworkLinkEntity final : public BaseEntity {
@@ -9,21 +10,34 @@ public:
     const std::string to;
     const double latency_mean;
     const double failure_prob;
+    const double bandwidth_mbps;    //shared by concurrent transfers; 0 is unlimited
 
     // ---- state ----
     bool is_down = false;
     int in_flight = 0;
+    int flow_link = -1;             //id in the run's FlowNetwork once registered
 
     NetworkLinkEntity(
         std::string id,
         std::string from,
         std::string to,
         double latency_mean,
-        double failure_prob
+        double failure_prob,
+        double bandwidth_mbps = 0.0
     )
         : BaseEntity(std::move(id)),
           from(std::move(from)),
           to(std::move(to)),
           latency_mean(latency_mean),
-          failure_prob(failure_prob) {}
+          failure_prob(failure_prob),
+          bandwidth_mbps(bandwidth_mbps) {}
+
+    //transfers over this link go through `network` from now on
+    void register_with(FlowNetwork& network) {
+        flow_link = network.add_link(bandwidth_mbps);
+    }
+
+    std::unique_ptr<BaseEntity> clone() const override {
+        return std::make_unique<NetworkLinkEntity>(*this);
+    }
 };
@@ -23,4 +23,8 @@ public:
           capacity(capacity),
           latency_mean(latency_mean),
           failure_prob(failure_prob) {}
+
+    std::unique_ptr<BaseEntity> clone() const override {
+        return std::make_unique<ServiceEntity>(*this);
+    }
 };
@@ -0,0 +1,17 @@
+//event.h is the base of everything the simulator schedules: a time, and what happens then
+#pragma once
+#include "../core/sim_types.h"
+
+class EventScheduler;
+struct SimulationContext;
+struct SimulationState;
+
+class Event {
+public:
+    SimTime time;
+
+    explicit Event(SimTime time) : time(time) {}
+    virtual ~Event() = default;
+
+    virtual void execute(const SimulationContext& context, SimulationState& state, EventScheduler& scheduler) = 0;
+};
@@ -0,0 +1,20 @@
+//flow_completion_event.h fires when a transfer on a FlowNetwork is due to finish at its current rate
+#pragma once
+#include "event.h"
+#include "../core/flow_network.h"
+#include <cstdint>
+
+class FlowCompletionEvent final : public Event {
+private:
+    FlowNetwork& network;
+    int flow;
+    std::uint64_t generation;   //the flow's rate when this was scheduled; a newer one supersedes it
+
+public:
+    FlowCompletionEvent(SimTime time, FlowNetwork& network, int flow, std::uint64_t generation)
+        : Event(time), network(network), flow(flow), generation(generation) {}
+
+    void execute(const SimulationContext&, SimulationState&, EventScheduler& scheduler) override {
+        network.complete(flow, generation, time, scheduler);
+    }
+};
@@ -0,0 +1,19 @@
+//trace_arrival_event.h delivers the pending request of one TraceSource stream
+#pragma once
+#include "event.h"
+#include "../core/trace_source.h"
+#include <cstddef>
+
+class TraceArrivalEvent final : public Event {
+private:
+    TraceSource& source;
+    std::size_t stream;
+
+public:
+    TraceArrivalEvent(SimTime time, TraceSource& source, std::size_t stream)
+        : Event(time), source(source), stream(stream) {}
+
+    void execute(const SimulationContext&, SimulationState&, EventScheduler& scheduler) override {
+        source.arrive(stream, scheduler);
+    }
+};
@@ -1,8 +1,12 @@
 #include "entity_factory.h"
 #include <stdexcept>
+#include <string_view>
 
 using std::make_unique;
 using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::unique_ptr;
 using std::vector;
 
 // ---------------- Public ----------------
@@ -11,52 +15,218 @@ void EntityFactory::build(
     const vector<IRNode>& ir,
     Simulation& simulation
 ) {
-    create_entities(ir, simulation);
+    create_entities(ir, simulation, nullptr);
+}
+
+void EntityFactory::build(
+    const vector<IRNode>& ir,
+    Simulation& simulation,
+    const RandomStreams& streams
+) {
+    create_entities(ir, simulation, &streams);
+}
+
+// ---------------- Binary IR ----------------
+
+namespace {
+
+// UI categories -> simulated entity kinds; a cache is simulated as a (fast) service for now, and a
+// network component placed on the canvas is a link hop between its neighbours
+bool node_type_for(string_view category, IRType& type) {
+    if (category == "api" || category == "service" || category == "cache") type = IRType::SERVICE;
+    else if (category == "database") type = IRType::DATABASE;
+    else if (category == "load_balancer" || category == "loadbalancer") type = IRType::LOAD_BALANCER;
+    else if (category == "network") type = IRType::NETWORK_LINK;
+    else return false;
+    return true;
+}
+
+LoadBalancingAlgorithm algorithm_for(string_view name) {
+    if (name == "LEAST_CONNECTIONS")    return LoadBalancingAlgorithm::LEAST_CONNECTIONS;
+    if (name == "IP_HASH")              return LoadBalancingAlgorithm::IP_HASH;
+    if (name == "RANDOM")               return LoadBalancingAlgorithm::RANDOM;
+    if (name == "WEIGHTED_ROUND_ROBIN") return LoadBalancingAlgorithm::WEIGHTED_ROUND_ROBIN;
+    if (name == "POWER_OF_TWO_CHOICES") return LoadBalancingAlgorithm::POWER_OF_TWO_CHOICES;
+    return LoadBalancingAlgorithm::ROUND_ROBIN;
+}
+
+}
+
+void EntityFactory::build(
+    const IRImage& image,
+    Simulation& simulation
+) {
+    // load balancers route to the targets of their outgoing links
+    std::unordered_map<string_view, vector<string>> targets;
+    std::unordered_map<string_view, vector<string>> sources;
+    for (size_t i = 0; i < image.link_count(); ++i) {
+        const auto& l = image.link(i);
+        targets[image.str(l.from)].emplace_back(image.str(l.to));
+        sources[image.str(l.to)].emplace_back(image.str(l.from));
+    }
+
+    // one node per component and link, then the same path as a hand-built model
+    vector<IRNode> nodes;
+    nodes.reserve(image.component_count() + image.link_count());
+
+    for (size_t i = 0; i < image.component_count(); ++i) {
+        const auto& c = image.component(i);
+        IRNode node;
+        if (!node_type_for(image.str(c.category), node.type))
+            throw runtime_error("Unsupported component category: " + string(image.str(c.category)));
+
+        node.id = string(image.str(c.id));
+        node.capacity = static_cast<int>(image.number(c.param_begin, c.param_count,
+            {"capacity", "max_concurrency", "max_connections"}, 1));
+        node.latency_mean = image.number(c.param_begin, c.param_count,
+            {"latency", "processing_latency_ms", "base_latency_ms"}, 0.0);
+        node.failure_prob = image.number(c.param_begin, c.param_count,
+            {"error_rate", "disk_fail_prob", "failure_prob"}, 0.0);
+
+        if (node.type == IRType::NETWORK_LINK) {
+            // a network component joins the component wired into it to the one it feeds
+            auto in = sources.find(image.str(c.id));
+            auto out = targets.find(image.str(c.id));
+            if (in == sources.end() || in->second.size() != 1 || out == targets.end() || out->second.size() != 1)
+                throw runtime_error("Network component needs exactly one upstream and one downstream "
+                                    "neighbour: " + node.id);
+            node.from = in->second.front();
+            node.to = out->second.front();
+            node.capacity = 0;
+            node.latency_mean = image.number(c.param_begin, c.param_count, {"latency_ms"}, 0.0);
+            node.failure_prob = image.number(c.param_begin, c.param_count, {"loss_prob", "failure_prob"}, 0.0);
+            node.bandwidth_mbps = image.number(c.param_begin, c.param_count,
+                {"bandwidth_mbps", "bandwidth_limit"}, 0.0);
+        }
+        if (node.type == IRType::LOAD_BALANCER) {
+            node.algorithm = algorithm_for(image.text(c.param_begin, c.param_count, "algorithm"));
+            auto it = targets.find(image.str(c.id));
+            if (it != targets.end()) node.backends = it->second;
+        }
+        nodes.push_back(std::move(node));
+    }
+
+    for (size_t i = 0; i < image.link_count(); ++i) {
+        const auto& l = image.link(i);
+        IRNode node;
+        node.type = IRType::NETWORK_LINK;
+        node.id = string(image.str(l.id));
+        node.from = string(image.str(l.from));
+        node.to = string(image.str(l.to));
+        node.capacity = 0;
+        node.latency_mean = image.number(l.param_begin, l.param_count, {"latency_ms"}, 0.0);
+        node.failure_prob = image.number(l.param_begin, l.param_count, {"loss_prob", "failure_prob"}, 0.0);
+        node.bandwidth_mbps = image.number(l.param_begin, l.param_count, {"bandwidth_mbps", "bandwidth_limit"}, 0.0);
+        nodes.push_back(std::move(node));
+    }
+
+    create_entities(nodes, simulation, nullptr);
+}
+
+void EntityFactory::rebuild(
+    const IRNode& node,
+    Simulation& simulation
+) {
+    auto it = simulation.entities.find(node.id);
+    if (it == simulation.entities.end())
+        throw runtime_error("Cannot rebuild unknown entity: " + node.id);
+
+    auto fresh = create_entity(node, 0);
+    const BaseEntity* warmed = it->second.get();
+
+    if (auto* s = dynamic_cast<ServiceEntity*>(fresh.get())) {
+        auto& w = dynamic_cast<const ServiceEntity&>(*warmed);
+        s->is_down = w.is_down;
+        s->active_requests = w.active_requests;
+        s->queued_requests = w.queued_requests;
+    } else if (auto* d = dynamic_cast<DatabaseEntity*>(fresh.get())) {
+        auto& w = dynamic_cast<const DatabaseEntity&>(*warmed);
+        d->is_down = w.is_down;
+        d->active_connections = w.active_connections;
+    } else if (auto* l = dynamic_cast<NetworkLinkEntity*>(fresh.get())) {
+        auto& w = dynamic_cast<const NetworkLinkEntity&>(*warmed);
+        l->is_down = w.is_down;
+        l->in_flight = w.in_flight;
+        if (w.flow_link >= 0 && l->bandwidth_mbps != w.bandwidth_mbps)
+            throw runtime_error("Cannot change the bandwidth of a registered link: " + node.id);
+        l->flow_link = w.flow_link;
+    } else if (auto* lb = dynamic_cast<LoadBalancerEntity*>(fresh.get())) {
+        lb->adopt_state(dynamic_cast<const LoadBalancerEntity&>(*warmed));
+    }
+
+    it->second = std::move(fresh);
+}
+
+Simulation Simulation::fork() const {
+    Simulation copy;
+    copy.entities.reserve(entities.size());
+    for (const auto& [id, entity] : entities)
+        copy.entities.emplace(id, entity->clone());
+    return copy;
+}
+
+void Simulation::reseed(const RandomStreams& streams) {
+    for (auto& [id, entity] : entities)
+        entity->reseed(streams.seed_for(id));
 }
 
 // ---------------- Private ----------------
 
 void EntityFactory::create_entities(
     const vector<IRNode>& ir,
-    Simulation& simulation
+    Simulation& simulation,
+    const RandomStreams* streams
 ) {
     for (const auto& node : ir) {
+        uint64_t seed = streams ? streams->seed_for(node.id) : 0;
+        simulation.entities[node.id] = create_entity(node, seed);
+    }
+}
 
-        switch (node.type) {
-
-        case IRType::SERVICE:
-            simulation.entities[node.id] =
-                make_unique<ServiceEntity>(
-                    node.id,
-                    node.capacity,
-                    node.latency_mean,
-                    node.failure_prob
-                );
-            break;
-
-        case IRType::DATABASE:
-            simulation.entities[node.id] =
-                make_unique<DatabaseEntity>(
-                    node.id,
-                    node.capacity,
-                    node.latency_mean,
-                    node.failure_prob
-                );
-            break;
-
-        case IRType::NETWORK_LINK:
-            simulation.entities[node.id] =
-                make_unique<NetworkLinkEntity>(
-                    node.id,
-                    node.from,
-                    node.to,
-                    node.latency_mean,
-                    node.failure_prob
-                );
-            break;
-
-        default:
-            throw runtime_error("Unknown IRType");
-        }
+unique_ptr<BaseEntity> EntityFactory::create_entity(
+    const IRNode& node,
+    uint64_t seed
+) {
+    switch (node.type) {
+
+    case IRType::SERVICE:
+        return make_unique<ServiceEntity>(
+            node.id,
+            node.capacity,
+            node.latency_mean,
+            node.failure_prob
+        );
+
+    case IRType::DATABASE:
+        return make_unique<DatabaseEntity>(
+            node.id,
+            node.capacity,
+            node.latency_mean,
+            node.failure_prob
+        );
+
+    case IRType::NETWORK_LINK:
+        return make_unique<NetworkLinkEntity>(
+            node.id,
+            node.from,
+            node.to,
+            node.latency_mean,
+            node.failure_prob,
+            node.bandwidth_mbps
+        );
+
+    case IRType::LOAD_BALANCER:
+        return make_unique<LoadBalancerEntity>(
+            node.id,
+            node.algorithm,
+            node.backends,
+            node.weights,
+            node.latency_mean,
+            node.failure_prob,
+            seed
+        );
+
+    default:
+        throw runtime_error("Unknown IRType");
     }
 }
@@ -8,13 +8,22 @@
 #include "../entities/service.h"
 #include "../entities/database.h"
 #include "../entities/network_link.h"
+#include "../entities/loadbalancer.h"
 
-// IR (will be changed after UI -> frontend is finalised)
+#include "../core/random_streams.h"
+#include "ir_image.h"
+
+// IRNode: the simulator's own description of one entity. It is not the
+// compiler's IR; a compiled diagram arrives as an IRImage (ir_image.h) and
+// build(image) translates it into nodes once per build. The sweep,
+// replication and rare-event runners keep IRNode because they edit single
+// fields through member pointers between runs.
 
 enum class IRType {
     SERVICE,
     DATABASE,
-    NETWORK_LINK
+    NETWORK_LINK,
+    LOAD_BALANCER
 };
 
 struct IRNode {
@@ -24,6 +33,12 @@ struct IRNode {
     // For network links
     std::string from;
     std::string to;
+    double bandwidth_mbps = 0.0;    // 0 is unlimited
+
+    // For load balancers
+    LoadBalancingAlgorithm algorithm = LoadBalancingAlgorithm::ROUND_ROBIN;
+    std::vector<std::string> backends;
+    std::vector<int> weights;
 
     // Common parameters
     int capacity;
@@ -35,6 +50,12 @@ struct IRNode {
 
 struct Simulation {
     std::unordered_map<std::string, std::unique_ptr<BaseEntity>> entities;
+
+    // deep copy of every entity, used to branch several runs off one warmed-up state
+    Simulation fork() const;
+
+    // reseeds every entity's own engine from `streams`, so a fork draws independently
+    void reseed(const RandomStreams& streams);
 };
 
 // Factory
@@ -45,9 +66,35 @@ public:
         Simulation& simulation
     );
 
+    // entities that own randomness are seeded from the run's streams (common random numbers)
+    void build(
+        const std::vector<IRNode>& ir,
+        Simulation& simulation,
+        const RandomStreams& streams
+    );
+
+    // builds straight from a binary IR image produced by the compiler
+    void build(
+        const IRImage& image,
+        Simulation& simulation
+    );
+
+    // replaces one entity with a copy built from a changed node, keeping the
+    // mutable state (queues, connections, faults) of the entity it replaces
+    void rebuild(
+        const IRNode& node,
+        Simulation& simulation
+    );
+
 private:
     void create_entities(
         const std::vector<IRNode>& ir,
-        Simulation& simulation
+        Simulation& simulation,
+        const RandomStreams* streams
+    );
+
+    std::unique_ptr<BaseEntity> create_entity(
+        const IRNode& node,
+        uint64_t seed
     );
 };
@@ -0,0 +1,161 @@
+#include "ir_image.h"
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using std::runtime_error;
+using std::size_t;
+using std::string;
+using std::string_view;
+using namespace irbin;
+
+// ---------------- Lifetime ----------------
+
+IRImage IRImage::map_file(const string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("Cannot open IR image: " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(BinHeader))) {
+        ::close(fd);
+        throw runtime_error("IR image too small: " + path);
+    }
+
+    void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); //the mapping keeps the file alive
+    if (p == MAP_FAILED) throw runtime_error("Cannot mmap IR image: " + path);
+
+    IRImage image;
+    image.base = static_cast<const char*>(p);
+    image.size = static_cast<size_t>(st.st_size);
+    image.mapped = true;
+    image.validate();
+    return image;
+}
+
+IRImage::IRImage(const void* data, size_t size)
+    : base(static_cast<const char*>(data)),
+      size(size) {
+    validate();
+}
+
+IRImage::IRImage(IRImage&& other) noexcept
+    : base(other.base),
+      size(other.size),
+      mapped(other.mapped),
+      header(other.header) {
+    other.base = nullptr;
+    other.mapped = false;
+}
+
+IRImage& IRImage::operator=(IRImage&& other) noexcept {
+    if (this != &other) {
+        release();
+        base = other.base;
+        size = other.size;
+        mapped = other.mapped;
+        header = other.header;
+        other.base = nullptr;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+IRImage::~IRImage() {
+    release();
+}
+
+void IRImage::release() {
+    if (mapped && base) ::munmap(const_cast<char*>(base), size);
+    base = nullptr;
+    mapped = false;
+}
+
+// ---------------- Validation ----------------
+
+void IRImage::validate() {
+    auto fail = [this](const char* what) {
+        release();
+        throw runtime_error(string("Invalid IR image: ") + what);
+    };
+
+    if (size < sizeof(BinHeader)) fail("truncated header");
+    if (reinterpret_cast<uintptr_t>(base) % alignof(BinHeader) != 0) fail("misaligned buffer");
+
+    header = reinterpret_cast<const BinHeader*>(base);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("bad magic");
+    if (header->byte_order != ENDIAN_TAG) fail("foreign byte order");
+    if (header->version != VERSION) fail("unsupported version");
+    if (header->total_size > size) fail("truncated image");
+
+    //every table must lie inside the image; everything after this is unchecked pointer math
+    auto within = [&](uint64_t offset, uint64_t count, uint64_t width) {
+        return offset <= size && count <= (size - offset) / width;
+    };
+    if (!within(header->components_offset, header->component_count, sizeof(BinComponent))
+        || !within(header->links_offset, header->link_count, sizeof(BinLink))
+        || !within(header->params_offset, header->param_count, sizeof(BinParam))
+        || !within(header->string_offsets_offset, uint64_t(header->string_count) + 1, sizeof(uint32_t)))
+        fail("table out of bounds");
+
+    //the tables are used in place, so each has to start on its own type's alignment
+    auto aligned = [](uint64_t offset, size_t alignment) { return offset % alignment == 0; };
+    if (!aligned(header->components_offset, alignof(BinComponent))
+        || !aligned(header->links_offset, alignof(BinLink))
+        || !aligned(header->params_offset, alignof(BinParam))
+        || !aligned(header->string_offsets_offset, alignof(uint32_t)))
+        fail("misaligned table");
+
+    auto offsets = reinterpret_cast<const uint32_t*>(base + header->string_offsets_offset);
+    if (header->string_data_offset > size
+        || offsets[header->string_count] > size - header->string_data_offset)
+        fail("string data out of bounds");
+    for (uint32_t i = 0; i < header->string_count; ++i)
+        if (offsets[i] >= offsets[i + 1]) fail("string offsets not increasing");
+
+    auto check_params = [&](uint32_t begin, uint32_t count) {
+        return begin <= header->param_count && count <= header->param_count - begin;
+    };
+    for (size_t i = 0; i < component_count(); ++i)
+        if (!check_params(component(i).param_begin, component(i).param_count)) fail("component params out of bounds");
+    for (size_t i = 0; i < link_count(); ++i)
+        if (!check_params(link(i).param_begin, link(i).param_count)) fail("link params out of bounds");
+}
+
+// ---------------- Access ----------------
+
+string_view IRImage::str(uint32_t index) const {
+    if (index >= header->string_count) return {};
+    auto offsets = reinterpret_cast<const uint32_t*>(base + header->string_offsets_offset);
+    const char* data = base + header->string_data_offset;
+    //each entry is NUL-terminated, hence the -1
+    return string_view(data + offsets[index], offsets[index + 1] - offsets[index] - 1);
+}
+
+double IRImage::number(uint32_t param_begin, uint32_t param_count,
+                       std::initializer_list<string_view> keys, double fallback) const {
+    const BinParam* p = params(param_begin);
+    for (string_view key : keys) {
+        for (uint32_t i = 0; i < param_count; ++i) {
+            if (str(p[i].key) != key) continue;
+            switch (p[i].type) {
+            case PARAM_INT:    return static_cast<double>(p[i].value.i);
+            case PARAM_DOUBLE: return p[i].value.d;
+            case PARAM_BOOL:   return p[i].value.b ? 1.0 : 0.0;
+            default:           break;
+            }
+        }
+    }
+    return fallback;
+}
+
+string_view IRImage::text(uint32_t param_begin, uint32_t param_count, string_view key) const {
+    const BinParam* p = params(param_begin);
+    for (uint32_t i = 0; i < param_count; ++i)
+        if (p[i].type == PARAM_STRING && str(p[i].key) == key) return str(p[i].value.s);
+    return {};
+}
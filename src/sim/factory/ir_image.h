@@ -0,0 +1,59 @@
+//ir_image.h gives read-only access to a binary IR produced by the compiler (serializeIRBinary)
+//the image is either mmap'ed from a file or borrowed from memory; after the header and bounds are
+//checked once, every table is used in place - no parsing, no copies
+#pragma once
+#include "../../compiler/src/ir_binary_format.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+class IRImage {
+private:
+    const char* base = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;    //true when base came from mmap and must be unmapped
+    const irbin::BinHeader* header = nullptr;
+
+    void validate();
+    void release();
+
+public:
+    //maps `path` read-only; throws runtime_error if it cannot be opened or is not a valid image
+    static IRImage map_file(const std::string& path);
+
+    //borrows an in-memory image (e.g. straight from the compiler); `data` must outlive this object
+    IRImage(const void* data, std::size_t size);
+
+    IRImage(IRImage&& other) noexcept;
+    IRImage& operator=(IRImage&& other) noexcept;
+    IRImage(const IRImage&) = delete;
+    IRImage& operator=(const IRImage&) = delete;
+    ~IRImage();
+
+    std::size_t component_count() const { return header->component_count; }
+    std::size_t link_count() const { return header->link_count; }
+
+    const irbin::BinComponent& component(std::size_t i) const {
+        return reinterpret_cast<const irbin::BinComponent*>(base + header->components_offset)[i];
+    }
+    const irbin::BinLink& link(std::size_t i) const {
+        return reinterpret_cast<const irbin::BinLink*>(base + header->links_offset)[i];
+    }
+    const irbin::BinParam* params(uint32_t begin) const {
+        return reinterpret_cast<const irbin::BinParam*>(base + header->params_offset) + begin;
+    }
+
+    std::string_view str(uint32_t index) const;
+
+    //string slot `key`, empty when missing or not a string
+    std::string_view text(uint32_t param_begin, uint32_t param_count, std::string_view key) const;
+
+    //first numeric slot among `keys` (ints and bools widen to double); `fallback` when none is set
+    double number(uint32_t param_begin, uint32_t param_count,
+                  std::initializer_list<std::string_view> keys, double fallback) const;
+
+private:
+    IRImage() = default;
+};
@@ -0,0 +1,182 @@
+#include "downsample.h"
+#include <algorithm>
+#include <cmath>
+
+using std::size_t;
+using std::vector;
+
+namespace {
+
+void push_point(ChartSlice& out, double t, double v, double lo, double hi) {
+    out.time.push_back(t);
+    out.value.push_back(v);
+    out.min.push_back(lo);
+    out.max.push_back(hi);
+}
+
+//LTTB over points that each carry their own envelope [lo, hi]
+ChartSlice lttb_envelope(const double* t, const double* v, const double* lo, const double* hi,
+                         size_t n, size_t points) {
+    ChartSlice out;
+    points = std::max<size_t>(points, 3);
+    out.time.reserve(std::min(n, points));
+    out.value.reserve(std::min(n, points));
+    out.min.reserve(std::min(n, points));
+    out.max.reserve(std::min(n, points));
+
+    if (n <= points) {
+        for (size_t i = 0; i < n; ++i) push_point(out, t[i], v[i], lo[i], hi[i]);
+        return out;
+    }
+
+    //first and last points are kept; the n - 2 between them form points - 2 buckets
+    push_point(out, t[0], v[0], lo[0], hi[0]);
+    const double every = double(n - 2) / double(points - 2);
+    size_t a = 0;
+    for (size_t b = 0; b + 2 < points; ++b) {
+        //the last bucket is closed explicitly: rounding must not drop the point before the last
+        bool last_bucket = b + 3 == points;
+        size_t start = size_t(b * every) + 1;
+        size_t end = last_bucket ? n - 1 : std::min(size_t((b + 1) * every) + 1, n - 1);
+        size_t next_end = last_bucket ? n : std::min(size_t((b + 2) * every) + 1, n);
+
+        //the next bucket is represented by its average; for the last bucket that is the last point
+        double avg_t = 0.0, avg_v = 0.0;
+        for (size_t i = end; i < next_end; ++i) {
+            avg_t += t[i];
+            avg_v += v[i];
+        }
+        avg_t /= double(next_end - end);
+        avg_v /= double(next_end - end);
+
+        size_t pick = start;
+        double best = -1.0;
+        double env_lo = lo[start], env_hi = hi[start];
+        for (size_t i = start; i < end; ++i) {
+            double area = std::abs((t[a] - avg_t) * (v[i] - v[a]) - (t[a] - t[i]) * (avg_v - v[a]));
+            if (area > best) {
+                best = area;
+                pick = i;
+            }
+            env_lo = std::min(env_lo, lo[i]);
+            env_hi = std::max(env_hi, hi[i]);
+        }
+        push_point(out, t[pick], v[pick], env_lo, env_hi);
+        a = pick;
+    }
+    push_point(out, t[n - 1], v[n - 1], lo[n - 1], hi[n - 1]);
+    return out;
+}
+
+}
+
+ChartSlice lttb(const double* time, const double* value, size_t n, size_t points) {
+    return lttb_envelope(time, value, value, value, n, points);
+}
+
+void SeriesLevels::trim(vector<Bucket>& level, size_t keep) {
+    if (level.size() > keep) level.erase(level.begin(), level.end() - static_cast<std::ptrdiff_t>(keep));
+}
+
+void SeriesLevels::set_max_buckets(size_t n) {
+    max_buckets = n ? std::max(n, 4 * FANOUT) : 0;
+    if (!max_buckets) return;
+    for (auto& level : levels) {
+        trim(level, max_buckets);
+        level.shrink_to_fit();
+    }
+}
+
+void SeriesLevels::add(double time, double value) {
+    size_t span = FANOUT;
+    for (auto& level : levels) {
+        if (level.empty() || level.back().count == span) {
+            //capped levels drop their oldest buckets an eighth at a time
+            if (max_buckets && level.size() >= max_buckets + max_buckets / 8) trim(level, max_buckets);
+            level.push_back({time, time, value, value, value, 1});
+        } else {
+            Bucket& b = level.back();
+            b.t_last = time;
+            b.min = std::min(b.min, value);
+            b.max = std::max(b.max, value);
+            b.sum += value;
+            ++b.count;
+        }
+        span *= FANOUT;
+    }
+
+    if (levels.empty()) {
+        levels.emplace_back();
+        levels.back().push_back({time, time, value, value, value, 1});
+        return;
+    }
+
+    //a new level starts once the top one has more than FANOUT buckets, built from it once
+    const vector<Bucket>& top = levels.back();
+    if (top.size() <= FANOUT) return;
+
+    vector<Bucket> next;
+    next.reserve(top.size() / FANOUT + 1);
+    for (size_t i = 0; i < top.size(); i += FANOUT) {
+        Bucket merged = top[i];
+        for (size_t j = i + 1; j < std::min(i + FANOUT, top.size()); ++j) {
+            merged.t_last = top[j].t_last;
+            merged.min = std::min(merged.min, top[j].min);
+            merged.max = std::max(merged.max, top[j].max);
+            merged.sum += top[j].sum;
+            merged.count += top[j].count;
+        }
+        next.push_back(merged);
+    }
+    levels.push_back(std::move(next));
+}
+
+ChartSlice SeriesLevels::query(const vector<double>& time, const vector<double>& value,
+                               double from, double to, size_t points, std::uint64_t evicted) const {
+    if (points == 0 || from > to) return {};
+
+    size_t first = size_t(std::lower_bound(time.begin(), time.end(), from) - time.begin());
+    size_t last = size_t(std::upper_bound(time.begin(), time.end(), to) - time.begin());
+    size_t budget = std::max<size_t>(points, 3) * OVERSAMPLE;
+    bool raw_covers = evicted == 0 || (!time.empty() && from >= time.front());
+    if ((last - first <= budget && raw_covers) || levels.empty())
+        return lttb(time.data() + first, value.data() + first, last - first, points);
+
+    //the finest level with few enough buckets in the window that still reaches back to `from`;
+    //the coarsest if none does
+    size_t k = 0;
+    size_t lo = 0, hi = 0;
+    for (; k < levels.size(); ++k) {
+        const vector<Bucket>& level = levels[k];
+        lo = size_t(std::lower_bound(level.begin(), level.end(), from,
+                                     [](const Bucket& b, double t) { return b.t_last < t; }) - level.begin());
+        hi = size_t(std::upper_bound(level.begin(), level.end(), to,
+                                     [](double t, const Bucket& b) { return t < b.t_first; }) - level.begin());
+        bool covers = !level.empty() && level.front().t_first <= from;
+        if ((hi - lo <= budget && covers) || k + 1 == levels.size()) break;
+    }
+
+    const vector<Bucket>& level = levels[k];
+    size_t n = hi - lo;
+    vector<double> t(n), v(n), env_lo(n), env_hi(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Bucket& b = level[lo + i];
+        t[i] = 0.5 * (b.t_first + b.t_last);
+        v[i] = b.sum / double(b.count);
+        env_lo[i] = b.min;
+        env_hi[i] = b.max;
+    }
+    return lttb_envelope(t.data(), v.data(), env_lo.data(), env_hi.data(), n, points);
+}
+
+size_t SeriesLevels::largest_level() const {
+    size_t n = 0;
+    for (const auto& level : levels) n = std::max(n, level.size());
+    return n;
+}
+
+size_t SeriesLevels::memory_bytes() const {
+    size_t n = levels.capacity() * sizeof(vector<Bucket>);
+    for (const auto& level : levels) n += level.capacity() * sizeof(Bucket);
+    return n;
+}
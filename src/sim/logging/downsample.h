@@ -0,0 +1,59 @@
+//downsample.h reduces a time series to what a chart can show: a few hundred points picked by
+//largest-triangle-three-buckets (LTTB), each with the min/max envelope of the samples it stands
+//for, so spikes that LTTB skips still show up as a band
+//
+//SeriesLevels keeps a pyramid of min/max/mean buckets that grows as samples arrive. A query for
+//N points over a window starts from the finest level that has at most a few times N buckets in
+//it, so zooming into a long run costs about the same as viewing all of it. for bounded-memory
+//runs each level can be capped; its oldest buckets are dropped, and charts of old windows fall
+//back to coarser levels.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//one entry per output point; min/max cover every sample the point represents
+struct ChartSlice {
+    std::vector<double> time;
+    std::vector<double> value;
+    std::vector<double> min;
+    std::vector<double> max;
+};
+
+//plain LTTB with envelope over (time, value); at most `points` points (at least 3 are kept)
+ChartSlice lttb(const double* time, const double* value, std::size_t n, std::size_t points);
+
+class SeriesLevels {
+private:
+    struct Bucket {
+        double t_first, t_last;
+        double min, max;
+        double sum;
+        std::uint64_t count;    //raw samples
+    };
+
+    std::vector<std::vector<Bucket>> levels;    //a level k bucket spans FANOUT^(k+1) samples
+    std::size_t max_buckets = 0;                //per level; 0 keeps all
+
+    void trim(std::vector<Bucket>& level, std::size_t keep);
+
+public:
+    static constexpr std::size_t FANOUT = 8;        //children per bucket; level 0 buckets hold raw samples
+    static constexpr std::size_t OVERSAMPLE = 4;    //input points per output point fed to LTTB
+
+    //times must not decrease
+    void add(double time, double value);
+
+    //`time`/`value` are the series' raw samples passed to add(), except the first `evicted` of
+    //them, which a rolling window has already let go of
+    ChartSlice query(const std::vector<double>& time, const std::vector<double>& value,
+                     double from, double to, std::size_t points, std::uint64_t evicted = 0) const;
+
+    //at least 4 * FANOUT; 0 removes the cap
+    void set_max_buckets(std::size_t n);
+    std::size_t bucket_cap() const { return max_buckets; }
+
+    std::size_t level_count() const { return levels.size(); }
+    std::size_t largest_level() const;
+    std::size_t memory_bytes() const;
+};
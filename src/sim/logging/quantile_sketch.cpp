@@ -0,0 +1,127 @@
+#include "quantile_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+using std::size_t;
+using std::uint64_t;
+
+//---- Store ----
+
+void QuantileSketch::Store::add(int index, uint64_t count, size_t max_bins) {
+    if (bins.empty()) {
+        offset = index;
+        bins.assign(1, 0);
+    }
+
+    if (index < offset) {
+        size_t grow = static_cast<size_t>(offset - index);
+        if (bins.size() + grow > max_bins) {
+            index = offset;     //below the collapsed range: counts towards the lowest bucket
+        } else {
+            bins.insert(bins.begin(), grow, 0);
+            offset = index;
+        }
+    } else if (index - offset >= static_cast<int>(bins.size())) {
+        bins.resize(static_cast<size_t>(index - offset) + 1, 0);
+        if (bins.size() > max_bins) {
+            size_t extra = bins.size() - max_bins;
+            bins[extra] = std::accumulate(bins.begin(), bins.begin() + extra + 1, uint64_t(0));
+            bins.erase(bins.begin(), bins.begin() + extra);
+            offset += static_cast<int>(extra);
+            index = std::max(index, offset);
+        }
+    }
+    bins[static_cast<size_t>(index - offset)] += count;
+}
+
+void QuantileSketch::Store::merge(const Store& other, size_t max_bins) {
+    for (size_t i = 0; i < other.bins.size(); ++i)
+        if (other.bins[i]) add(other.offset + static_cast<int>(i), other.bins[i], max_bins);
+}
+
+//---- QuantileSketch ----
+
+QuantileSketch::QuantileSketch(double accuracy, size_t max_bins)
+    : gamma((1.0 + accuracy) / (1.0 - accuracy)),
+      log_gamma(std::log(gamma)),
+      max_bins(std::max<size_t>(max_bins, 16)) {
+    if (!(accuracy > 0.0 && accuracy < 1.0))
+        throw std::invalid_argument("Sketch accuracy must be in (0, 1)");
+}
+
+//bucket i holds magnitudes in (gamma^(i-1), gamma^i]
+int QuantileSketch::index_of(double magnitude) const {
+    return static_cast<int>(std::ceil(std::log(magnitude) / log_gamma));
+}
+
+double QuantileSketch::value_of(int index) const {
+    return 2.0 * std::pow(gamma, index) / (gamma + 1.0);
+}
+
+void QuantileSketch::add(double value) {
+    if (std::isnan(value)) return;
+    lo = n ? std::min(lo, value) : value;
+    hi = n ? std::max(hi, value) : value;
+    ++n;
+
+    double magnitude = std::abs(value);
+    if (magnitude < MIN_VALUE) ++zero_count;
+    else if (value > 0) positive.add(index_of(magnitude), 1, max_bins);
+    else negative.add(index_of(magnitude), 1, max_bins);
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.gamma != gamma) throw std::invalid_argument("Cannot merge sketches of different accuracy");
+    if (!other.n) return;
+    lo = n ? std::min(lo, other.lo) : other.lo;
+    hi = n ? std::max(hi, other.hi) : other.hi;
+    n += other.n;
+    zero_count += other.zero_count;
+    positive.merge(other.positive, max_bins);
+    negative.merge(other.negative, max_bins);
+}
+
+double QuantileSketch::quantile(double q) const {
+    if (!n) return std::numeric_limits<double>::quiet_NaN();
+    uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) * double(n - 1));
+
+    //ascending values: negatives from the largest magnitude down, zero, then positives
+    uint64_t seen = 0;
+    for (size_t i = negative.bins.size(); i-- > 0;) {
+        seen += negative.bins[i];
+        if (seen > rank) return std::clamp(-value_of(negative.offset + static_cast<int>(i)), lo, hi);
+    }
+    seen += zero_count;
+    if (seen > rank) return std::clamp(0.0, lo, hi);
+    for (size_t i = 0; i < positive.bins.size(); ++i) {
+        seen += positive.bins[i];
+        if (seen > rank) return std::clamp(value_of(positive.offset + static_cast<int>(i)), lo, hi);
+    }
+    return hi;
+}
+
+void QuantileSketch::buckets(std::vector<double>& upper, std::vector<uint64_t>& counts) const {
+    upper.clear();
+    counts.clear();
+    for (size_t i = negative.bins.size(); i-- > 0;) {
+        if (!negative.bins[i]) continue;
+        upper.push_back(-std::pow(gamma, negative.offset + static_cast<int>(i) - 1));
+        counts.push_back(negative.bins[i]);
+    }
+    if (zero_count) {
+        upper.push_back(MIN_VALUE);
+        counts.push_back(zero_count);
+    }
+    for (size_t i = 0; i < positive.bins.size(); ++i) {
+        if (!positive.bins[i]) continue;
+        upper.push_back(std::pow(gamma, positive.offset + static_cast<int>(i)));
+        counts.push_back(positive.bins[i]);
+    }
+}
+
+size_t QuantileSketch::memory_bytes() const {
+    return sizeof(*this) + (positive.bins.capacity() + negative.bins.capacity()) * sizeof(uint64_t);
+}
@@ -0,0 +1,51 @@
+//quantile_sketch.h is a fixed-memory distribution sink (DDSketch): values fall into logarithmic
+//buckets, so every quantile is answered within a relative error of `accuracy`, however many
+//values were added. when more than max_bins buckets are in use the lowest ones are merged, which
+//only costs accuracy at the low end (the tail quantiles that matter for latency stay exact to alpha)
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class QuantileSketch {
+private:
+    //counts of consecutive bucket indices starting at `offset`
+    struct Store {
+        std::vector<std::uint64_t> bins;
+        int offset = 0;
+
+        void add(int index, std::uint64_t count, std::size_t max_bins);
+        void merge(const Store& other, std::size_t max_bins);
+    };
+
+    double gamma;
+    double log_gamma;
+    std::size_t max_bins;
+
+    Store positive;
+    Store negative;                 //by |value|
+    std::uint64_t zero_count = 0;   //|value| below MIN_VALUE
+    std::uint64_t n = 0;
+    double lo = 0.0, hi = 0.0;
+
+    int index_of(double magnitude) const;
+    double value_of(int index) const;   //the bucket's representative value
+
+public:
+    static constexpr double MIN_VALUE = 1e-9;
+
+    explicit QuantileSketch(double accuracy = 0.01, std::size_t max_bins = 2048);
+
+    void add(double value);
+    void merge(const QuantileSketch& other);   //same accuracy required
+
+    std::uint64_t count() const { return n; }
+    double min() const { return lo; }
+    double max() const { return hi; }
+    double quantile(double q) const;            //NaN while empty
+
+    //bucket upper bounds and counts, ascending; the shape result_file.h writes as a histogram
+    void buckets(std::vector<double>& upper, std::vector<std::uint64_t>& counts) const;
+
+    std::size_t memory_bytes() const;
+};
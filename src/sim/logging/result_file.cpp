@@ -0,0 +1,422 @@
+#include "result_file.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using std::size_t;
+using std::string;
+using std::string_view;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+using namespace result_file;
+
+namespace {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool HOST_LITTLE_ENDIAN = true;
+#else
+constexpr bool HOST_LITTLE_ENDIAN = false;
+#endif
+
+//appends to the stream while tracking the file offset, which the 8-byte padding is relative to
+class ColumnOut {
+private:
+    std::ostream& os;
+    uint64_t pos = 0;
+
+    void put_le(uint64_t v, int bytes) {
+        char b[8];
+        for (int i = 0; i < bytes; ++i) b[i] = static_cast<char>(v >> (8 * i));
+        raw(b, bytes);
+    }
+
+    //whole arrays in one write on little-endian hosts, value by value otherwise
+    template <typename T>
+    void array(const T* data, size_t n) {
+        if (HOST_LITTLE_ENDIAN) {
+            raw(data, n * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &data[i], sizeof(T));
+            put_le(bits, sizeof(T));
+        }
+    }
+
+public:
+    explicit ColumnOut(std::ostream& os) : os(os) {}
+
+    void raw(const void* data, size_t n) {
+        os.write(static_cast<const char*>(data), static_cast<std::streamsize>(n));
+        pos += n;
+    }
+
+    void pad() {
+        static const char zeros[8] = {};
+        if (pos % 8) raw(zeros, 8 - pos % 8);
+    }
+
+    void u32(uint32_t v) { put_le(v, 4); }
+    void u64(uint64_t v) { put_le(v, 8); }
+
+    void text(string_view s) {
+        u32(static_cast<uint32_t>(s.size()));
+        raw(s.data(), s.size());
+        pad();
+    }
+
+    void header(uint32_t tables) {
+        raw(MAGIC, sizeof(MAGIC));
+        u32(VERSION);
+        u32(tables);
+    }
+
+    void table(string_view name, uint64_t rows, uint32_t columns) {
+        text(name);
+        u64(rows);
+        u32(columns);
+        u32(0);
+    }
+
+    void column(string_view name, ColumnType type) {
+        text(name);
+        u32(static_cast<uint32_t>(type));
+        u32(0);
+    }
+
+    //a F64 or I64 column may be written in several parts; pad() closes it
+    void f64s(const double* data, size_t n) { array(data, n); }
+    void i64s(const std::int64_t* data, size_t n) { array(data, n); }
+
+    void f64_column(string_view name, const vector<double>& values) {
+        column(name, ColumnType::F64);
+        f64s(values.data(), values.size());
+        pad();
+    }
+
+    void i64_column(string_view name, const vector<std::int64_t>& values) {
+        column(name, ColumnType::I64);
+        i64s(values.data(), values.size());
+        pad();
+    }
+
+    void dict_column(string_view name, const vector<string_view>& rows) {
+        std::unordered_map<string_view, uint32_t> codes_of;
+        vector<string_view> entries;
+        vector<uint32_t> codes;
+        codes.reserve(rows.size());
+        for (string_view s : rows) {
+            auto [it, inserted] = codes_of.try_emplace(s, static_cast<uint32_t>(entries.size()));
+            if (inserted) entries.push_back(s);
+            codes.push_back(it->second);
+        }
+
+        vector<uint32_t> offsets{0};
+        for (string_view e : entries) offsets.push_back(offsets.back() + static_cast<uint32_t>(e.size()));
+
+        column(name, ColumnType::DICT);
+        u32(static_cast<uint32_t>(entries.size()));
+        u32(0);
+        array(offsets.data(), offsets.size());
+        pad();
+        for (string_view e : entries) raw(e.data(), e.size());
+        pad();
+        array(codes.data(), codes.size());
+        pad();
+    }
+};
+
+template <typename T, typename F>
+vector<string_view> strings_of(const vector<T>& items, F field) {
+    vector<string_view> out;
+    out.reserve(items.size());
+    for (const auto& item : items) out.push_back(item.*field);
+    return out;
+}
+
+//what the histograms tables hold: recorded histograms, then the buckets of each distribution
+vector<Histogram> histograms_of(const RunResults& results) {
+    vector<Histogram> out = results.all_histograms();
+    for (const auto& d : results.all_distributions()) {
+        Histogram h{d.entity, d.metric, {}, {}};
+        d.sketch.buckets(h.upper, h.count);
+        out.push_back(std::move(h));
+    }
+    return out;
+}
+
+//recorded summaries, then the count and quantiles of each distribution as "<metric>.p99" etc.
+vector<SummaryValue> summaries_of(const RunResults& results) {
+    static const std::pair<const char*, double> QUANTILES[] = {{".p50", 0.5}, {".p90", 0.9}, {".p99", 0.99}};
+    vector<SummaryValue> out = results.all_summaries();
+    for (const auto& d : results.all_distributions()) {
+        out.push_back({d.entity, d.metric + ".count", static_cast<double>(d.sketch.count())});
+        for (const auto& [suffix, q] : QUANTILES) out.push_back({d.entity, d.metric + suffix, d.sketch.quantile(q)});
+        out.push_back({d.entity, d.metric + ".max", d.sketch.count() ? d.sketch.max() : std::nan("")});
+    }
+    return out;
+}
+
+uint64_t spilled_count(const RunResults& results, size_t series) {
+    const SpillFile* spill = results.spill_file();
+    return spill ? spill->count(static_cast<uint32_t>(series)) : 0;
+}
+
+//a series' times or values, oldest first: spilled blocks, then the retained window
+template <typename F>
+void for_each_part(const RunResults& results, size_t series, bool times, F emit) {
+    if (const SpillFile* spill = results.spill_file())
+        spill->for_each_block(static_cast<uint32_t>(series), [&](const vector<double>& t, const vector<double>& v) {
+            emit(times ? t : v);
+        });
+    const Series& s = results.all_series()[series];
+    emit(times ? s.time : s.value);
+}
+
+//---- JSON ----
+
+void json_string(std::ostream& os, string_view s) {
+    os << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':  os << "\\\""; break;
+            case '\\': os << "\\\\"; break;
+            case '\n': os << "\\n"; break;
+            case '\r': os << "\\r"; break;
+            case '\t': os << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char hex[] = "0123456789abcdef";
+                    os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
+
+void json_number(std::ostream& os, double v) {
+    if (std::isfinite(v)) os << v;
+    else os << "null";
+}
+
+void json_number(std::ostream& os, uint64_t v) {
+    os << v;
+}
+
+template <typename T>
+void json_array(std::ostream& os, const vector<T>& values) {
+    os << '[';
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i) os << ',';
+        json_number(os, values[i]);
+    }
+    os << ']';
+}
+
+void json_name(std::ostream& os, const string& entity, const string& metric) {
+    os << "\"entity\":";
+    json_string(os, entity);
+    os << ",\"metric\":";
+    json_string(os, metric);
+}
+
+}
+
+void write_columnar(const RunResults& results, std::ostream& os) {
+    const auto& series = results.all_series();
+    const auto summaries = summaries_of(results);
+    const auto histograms = histograms_of(results);
+
+    ColumnOut out(os);
+    out.header(static_cast<uint32_t>(6 + results.tables().size()));
+
+    //identical time vectors are written once; the map is keyed by their bytes. series with
+    //spilled samples are not held in memory whole, so they always get their own axis
+    vector<std::int64_t> first, count, time_first;
+    vector<size_t> axes;
+    std::unordered_map<string_view, std::int64_t> axis_at;
+    std::int64_t next = 0, next_time = 0;
+    for (size_t i = 0; i < series.size(); ++i) {
+        const Series& s = series[i];
+        uint64_t spilled = spilled_count(results, i);
+        first.push_back(next);
+        count.push_back(static_cast<std::int64_t>(s.time.size() + spilled));
+        next += count.back();
+
+        if (spilled) {
+            axes.push_back(i);
+            time_first.push_back(next_time);
+            next_time += count.back();
+            continue;
+        }
+        string_view bytes(reinterpret_cast<const char*>(s.time.data()), s.time.size() * sizeof(double));
+        auto [it, inserted] = axis_at.try_emplace(bytes, next_time);
+        if (inserted) {
+            axes.push_back(i);
+            next_time += count.back();
+        }
+        time_first.push_back(it->second);
+    }
+
+    out.table("series", series.size(), 5);
+    out.dict_column("entity", strings_of(series, &Series::entity));
+    out.dict_column("metric", strings_of(series, &Series::metric));
+    out.i64_column("first", first);
+    out.i64_column("count", count);
+    out.i64_column("time_first", time_first);
+
+    //the series are laid end to end instead of being copied into one buffer first
+    auto write_part = [&](const vector<double>& part) { out.f64s(part.data(), part.size()); };
+    out.table("samples", static_cast<uint64_t>(next), 1);
+    out.column("value", ColumnType::F64);
+    for (size_t i = 0; i < series.size(); ++i) for_each_part(results, i, false, write_part);
+    out.pad();
+
+    out.table("sample_times", static_cast<uint64_t>(next_time), 1);
+    out.column("time", ColumnType::F64);
+    for (size_t axis : axes) for_each_part(results, axis, true, write_part);
+    out.pad();
+
+    vector<double> values;
+    values.reserve(summaries.size());
+    for (const auto& s : summaries) values.push_back(s.value);
+
+    out.table("summary", summaries.size(), 3);
+    out.dict_column("entity", strings_of(summaries, &SummaryValue::entity));
+    out.dict_column("metric", strings_of(summaries, &SummaryValue::metric));
+    out.f64_column("value", values);
+
+    first.clear();
+    count.clear();
+    next = 0;
+    vector<double> upper;
+    vector<std::int64_t> bin_count;
+    for (const auto& h : histograms) {
+        first.push_back(next);
+        count.push_back(static_cast<std::int64_t>(h.upper.size()));
+        next += count.back();
+        upper.insert(upper.end(), h.upper.begin(), h.upper.end());
+        for (uint64_t c : h.count) bin_count.push_back(static_cast<std::int64_t>(c));
+    }
+
+    out.table("histograms", histograms.size(), 4);
+    out.dict_column("entity", strings_of(histograms, &Histogram::entity));
+    out.dict_column("metric", strings_of(histograms, &Histogram::metric));
+    out.i64_column("first", first);
+    out.i64_column("count", count);
+
+    out.table("histogram_bins", upper.size(), 2);
+    out.f64_column("upper", upper);
+    out.i64_column("count", bin_count);
+
+    for (const auto& [name, table] : results.tables()) {
+        out.table(name, table.rows(), static_cast<uint32_t>(table.cols()));
+        for (size_t c = 0; c < table.cols(); ++c)
+            out.f64_column(table.column_names()[c], table.column(c));
+    }
+}
+
+void write_columnar(const RunResults& results, const string& path) {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) throw std::runtime_error("Cannot open result file: " + path);
+    write_columnar(results, os);
+    if (!os) throw std::runtime_error("Cannot write result file: " + path);
+}
+
+void write_json(const RunResults& results, std::ostream& os) {
+    auto precision = os.precision(std::numeric_limits<double>::max_digits10);
+
+    //spilled samples are streamed from disk block by block
+    auto series_array = [&](size_t series, bool times) {
+        bool first_value = true;
+        os << '[';
+        for_each_part(results, series, times, [&](const vector<double>& part) {
+            for (double v : part) {
+                if (!first_value) os << ',';
+                first_value = false;
+                json_number(os, v);
+            }
+        });
+        os << ']';
+    };
+
+    os << "{\"series\":[";
+    bool first = true;
+    const auto& series = results.all_series();
+    for (size_t i = 0; i < series.size(); ++i) {
+        os << (first ? "" : ",") << '{';
+        first = false;
+        json_name(os, series[i].entity, series[i].metric);
+        os << ",\"time\":";
+        series_array(i, true);
+        os << ",\"value\":";
+        series_array(i, false);
+        os << '}';
+    }
+
+    os << "],\"summary\":[";
+    first = true;
+    for (const auto& s : summaries_of(results)) {
+        os << (first ? "" : ",") << '{';
+        first = false;
+        json_name(os, s.entity, s.metric);
+        os << ",\"value\":";
+        json_number(os, s.value);
+        os << '}';
+    }
+
+    os << "],\"histograms\":[";
+    first = true;
+    for (const auto& h : histograms_of(results)) {
+        os << (first ? "" : ",") << '{';
+        first = false;
+        json_name(os, h.entity, h.metric);
+        os << ",\"upper\":";
+        json_array(os, h.upper);
+        os << ",\"count\":";
+        json_array(os, h.count);
+        os << '}';
+    }
+
+    os << "],\"tables\":{";
+    first = true;
+    for (const auto& [name, table] : results.tables()) {
+        os << (first ? "" : ",");
+        first = false;
+        json_string(os, name);
+        os << ":{";
+        for (size_t c = 0; c < table.cols(); ++c) {
+            if (c) os << ',';
+            json_string(os, table.column_names()[c]);
+            os << ':';
+            json_array(os, table.column(c));
+        }
+        os << '}';
+    }
+    os << "}}\n";
+
+    os.precision(precision);
+}
+
+void write_json(const ChartSlice& slice, std::ostream& os) {
+    auto precision = os.precision(std::numeric_limits<double>::max_digits10);
+    os << "{\"time\":";
+    json_array(os, slice.time);
+    os << ",\"value\":";
+    json_array(os, slice.value);
+    os << ",\"min\":";
+    json_array(os, slice.min);
+    os << ",\"max\":";
+    json_array(os, slice.max);
+    os << "}\n";
+    os.precision(precision);
+}
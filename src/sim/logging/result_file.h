@@ -0,0 +1,62 @@
+//result_file.h writes RunResults to disk: a columnar binary file for the UI and analysis tools,
+//and JSON as an optional, human-readable export
+//
+//the columnar file is a sequence of tables, each a sequence of equally long columns. every
+//column's data starts on an 8-byte boundary of the file, so a reader can map or load the file
+//once and view each column in place (Float64Array, BigInt64Array, Uint32Array) without parsing
+//or copying. all integers are little-endian.
+//
+//  file    := magic "SIMRES\0\1" | u32 version | u32 table_count | table*
+//  table   := string name | u64 rows | u32 column_count | u32 0 | column*
+//  column  := string name | u32 type | u32 0 | data
+//  string  := u32 byte_length | utf-8 bytes | zero padding to 8
+//  data    := F64:  f64[rows]                          padded to 8
+//             I64:  i64[rows]
+//             DICT: u32 entries | u32 0 | u32 offsets[entries + 1] | padding
+//                   | utf-8 bytes of all entries | padding | u32 codes[rows] | padding
+//
+//a DICT column holds strings: row r is the dictionary entry codes[r], whose bytes are
+//[offsets[code], offsets[code + 1]) of the byte block.
+//
+//tables written for a RunResults:
+//  series          entity DICT, metric DICT, first I64, count I64, time_first I64
+//  samples         value F64                    series i is rows [first, first + count)
+//  sample_times    time F64                     its times are rows [time_first, time_first + count)
+//  summary         entity DICT, metric DICT, value F64
+//  histograms      entity DICT, metric DICT, first I64, count I64
+//  histogram_bins  upper F64, count I64
+//  <name>          one F64 column per ResultTable column, for each RunResults::add_table
+//
+//series sampled at the same instants (the usual case: every entity reported once per interval)
+//share one stretch of sample_times, so a timestamp is stored once per time axis, not per value.
+//
+//a series holds its spilled samples (RetentionPolicy::spill_path) followed by its retained
+//window. each distribution is written as a histogram of its sketch buckets, plus summary rows
+//<metric>.count, .p50, .p90, .p99 and .max.
+#pragma once
+#include "run_results.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace result_file {
+
+constexpr char MAGIC[8] = {'S', 'I', 'M', 'R', 'E', 'S', '\0', '\1'};
+constexpr std::uint32_t VERSION = 1;
+
+enum class ColumnType : std::uint32_t {
+    F64 = 1,
+    I64 = 2,
+    DICT = 3
+};
+
+}
+
+void write_columnar(const RunResults& results, std::ostream& os);
+void write_columnar(const RunResults& results, const std::string& path);
+
+//the same content as nested JSON; NaN and infinities become null
+void write_json(const RunResults& results, std::ostream& os);
+
+//a chart payload: {"time": [...], "value": [...], "min": [...], "max": [...]}
+void write_json(const ChartSlice& slice, std::ostream& os);
@@ -0,0 +1,148 @@
+#include "run_results.h"
+#include <algorithm>
+#include <stdexcept>
+
+using std::size_t;
+using std::string;
+
+void RunResults::set_retention(RetentionPolicy policy) {
+    if (sample_count() || dropped || spill || !distributions.empty())
+        throw std::runtime_error("Retention must be set before the run records anything");
+    if (!policy.spill_path.empty()) spill = std::make_unique<SpillFile>(policy.spill_path);
+    retention = std::move(policy);
+    for (auto& s : series_list) {
+        s.window = retention.window_samples;
+        s.levels.set_max_buckets(retention.level_buckets);
+    }
+}
+
+std::uint32_t RunResults::series(const string& entity, const string& metric) {
+    auto [it, inserted] = series_index.try_emplace({entity, metric}, 0);
+    if (inserted) {
+        it->second = static_cast<std::uint32_t>(series_list.size());
+        series_list.push_back({entity, metric, {}, {}, {}});
+        series_list.back().window = retention.window_samples;
+        series_list.back().levels.set_max_buckets(retention.level_buckets);
+    }
+    return it->second;
+}
+
+void RunResults::sample(std::uint32_t series, SimTime time, double value) {
+    Series& s = series_list[series];
+    if (s.window && s.time.size() == s.time.capacity()) {
+        //a windowed series never holds more than an eighth over its window, so stop doubling there
+        size_t cap = std::min(std::max<size_t>(2 * s.time.capacity(), 16),
+                              s.window + std::max<size_t>(s.window / 8, 1));
+        s.time.reserve(cap);
+        s.value.reserve(cap);
+    }
+    s.time.push_back(static_cast<double>(time));
+    s.value.push_back(value);
+    s.levels.add(static_cast<double>(time), value);
+
+    //the window slides an eighth at a time, so eviction is amortized over many samples
+    if (s.window && s.time.size() >= s.window + std::max<size_t>(s.window / 8, 1)) evict(series, s.window);
+    if (retention.memory_budget && ++since_check == BUDGET_CHECK_INTERVAL) {
+        since_check = 0;
+        enforce_budget();
+    }
+}
+
+void RunResults::evict(std::uint32_t series, size_t keep) {
+    Series& s = series_list[series];
+    if (s.time.size() <= keep) return;
+    size_t n = s.time.size() - keep;
+    if (spill) spill->append(series, s.time.data(), s.value.data(), n);
+    else dropped += n;
+
+    s.time.erase(s.time.begin(), s.time.begin() + static_cast<std::ptrdiff_t>(n));
+    s.value.erase(s.value.begin(), s.value.begin() + static_cast<std::ptrdiff_t>(n));
+    s.evicted += n;
+}
+
+size_t RunResults::series_bytes(const Series& s) const {
+    return sizeof(Series) + s.entity.capacity() + s.metric.capacity()
+           + (s.time.capacity() + s.value.capacity()) * sizeof(double) + s.levels.memory_bytes();
+}
+
+//raw windows give way first, largest first, halving each time; then every series' chart levels
+void RunResults::enforce_budget() {
+    size_t used = memory_bytes();
+    while (used > retention.memory_budget) {
+        size_t largest = series_list.size();
+        for (size_t i = 0; i < series_list.size(); ++i) {
+            size_t n = series_list[i].time.size();
+            if (n > MIN_WINDOW && (largest == series_list.size() || n > series_list[largest].time.size()))
+                largest = i;
+        }
+
+        if (largest < series_list.size()) {
+            Series& s = series_list[largest];
+            size_t before = series_bytes(s);
+            s.window = std::max(s.time.size() / 2, MIN_WINDOW);
+            evict(static_cast<std::uint32_t>(largest), s.window);
+            s.time.shrink_to_fit();
+            s.value.shrink_to_fit();
+            used -= before - std::min(before, series_bytes(s));
+            continue;
+        }
+
+        size_t cap = retention.level_buckets;
+        if (!cap)
+            for (const auto& s : series_list) cap = std::max(cap, s.levels.largest_level());
+        if (cap <= 4 * SeriesLevels::FANOUT)
+            throw std::runtime_error("Run needs more than its memory budget of " +
+                                     std::to_string(retention.memory_budget) + " bytes, even with minimal windows");
+        retention.level_buckets = std::max(cap / 2, 4 * SeriesLevels::FANOUT);
+        for (auto& s : series_list) s.levels.set_max_buckets(retention.level_buckets);
+        used = memory_bytes();
+    }
+}
+
+ChartSlice RunResults::chart(std::uint32_t series, double from, double to, size_t points) const {
+    const Series& s = series_list[series];
+    return s.levels.query(s.time, s.value, from, to, points, s.evicted);
+}
+
+std::uint32_t RunResults::distribution(const string& entity, const string& metric) {
+    auto [it, inserted] = distribution_index.try_emplace({entity, metric}, 0);
+    if (inserted) {
+        it->second = static_cast<std::uint32_t>(distributions.size());
+        distributions.push_back({entity, metric, QuantileSketch(retention.sketch_accuracy, retention.sketch_bins)});
+    }
+    return it->second;
+}
+
+void RunResults::observe(std::uint32_t distribution, double value) {
+    distributions[distribution].sketch.add(value);
+}
+
+void RunResults::summary(const string& entity, const string& metric, double value) {
+    summaries.push_back({entity, metric, value});
+}
+
+void RunResults::histogram(Histogram h) {
+    if (h.upper.size() != h.count.size())
+        throw std::invalid_argument("Histogram " + h.entity + "." + h.metric + ": bounds and counts differ in length");
+    histograms.push_back(std::move(h));
+}
+
+void RunResults::add_table(const string& name, ResultTable table) {
+    extra_tables.emplace_back(name, std::move(table));
+}
+
+size_t RunResults::sample_count() const {
+    size_t n = 0;
+    for (const auto& s : series_list) n += s.time.size();
+    return n;
+}
+
+size_t RunResults::memory_bytes() const {
+    size_t n = sizeof(*this);
+    for (const auto& s : series_list) n += series_bytes(s);
+    for (const auto& d : distributions) n += d.sketch.memory_bytes() + d.entity.capacity() + d.metric.capacity();
+    for (const auto& h : histograms) n += sizeof(h) + (h.upper.capacity() + h.count.capacity()) * 8;
+    n += summaries.capacity() * sizeof(SummaryValue);
+    if (spill) n += spill->memory_bytes();
+    return n;
+}
@@ -0,0 +1,117 @@
+//run_results.h collects what one simulation run reports: time series, per-entity summaries,
+//histograms and any extra tables (e.g. a sweep's ResultTable), ready to be written out by
+//result_file.h in the columnar format or as JSON
+//
+//series are indexed for charting while they are recorded (downsample.h), so a chart can ask for
+//N points of any window at any time during or after the run
+//
+//by default everything is kept in memory. a RetentionPolicy bounds that for long runs: each
+//series keeps a rolling window of raw samples (older ones are spilled to disk or dropped), the
+//chart levels are capped, distributions are quantile sketches, and the whole is held within a
+//memory budget by shrinking the largest windows first
+#pragma once
+#include "downsample.h"
+#include "quantile_sketch.h"
+#include "spill_file.h"
+#include "../core/sim_types.h"
+#include "../runner/result_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Series {
+    std::string entity;
+    std::string metric;
+    std::vector<double> time;       //the retained window
+    std::vector<double> value;
+    SeriesLevels levels;
+    std::uint64_t evicted = 0;      //samples recorded before time[0]
+    std::size_t window = 0;         //raw samples kept; 0 keeps all
+};
+
+//a value distribution (e.g. request latency) kept as a sketch instead of raw observations
+struct Distribution {
+    std::string entity;
+    std::string metric;
+    QuantileSketch sketch;
+};
+
+struct RetentionPolicy {
+    std::size_t memory_budget = 0;      //bytes; 0 is unbounded
+    std::size_t window_samples = 0;     //raw samples kept per series; 0 keeps all
+    std::string spill_path;             //evicted samples go here; empty drops them
+    std::size_t level_buckets = 0;      //buckets kept per chart level; 0 keeps all
+    double sketch_accuracy = 0.01;      //relative error of distribution quantiles
+    std::size_t sketch_bins = 2048;
+};
+
+struct SummaryValue {
+    std::string entity;
+    std::string metric;
+    double value;
+};
+
+//bucket i counts observations in (upper[i-1], upper[i]]; the last bound may be +infinity
+struct Histogram {
+    std::string entity;
+    std::string metric;
+    std::vector<double> upper;
+    std::vector<std::uint64_t> count;
+};
+
+class RunResults {
+private:
+    std::vector<Series> series_list;
+    std::map<std::pair<std::string, std::string>, std::uint32_t> series_index;
+    std::vector<SummaryValue> summaries;
+    std::vector<Histogram> histograms;
+    std::vector<std::pair<std::string, ResultTable>> extra_tables;
+    std::vector<Distribution> distributions;
+    std::map<std::pair<std::string, std::string>, std::uint32_t> distribution_index;
+
+    RetentionPolicy retention;
+    std::unique_ptr<SpillFile> spill;
+    std::uint64_t dropped = 0;
+    std::size_t since_check = 0;
+
+    static constexpr std::size_t BUDGET_CHECK_INTERVAL = 1 << 16;    //samples
+    static constexpr std::size_t MIN_WINDOW = 1024;
+
+    void evict(std::uint32_t series, std::size_t keep);
+    std::size_t series_bytes(const Series& s) const;
+    void enforce_budget();
+
+public:
+    //must be set before anything is recorded
+    void set_retention(RetentionPolicy policy);
+    const RetentionPolicy& retention_policy() const { return retention; }
+
+    //handle of the (entity, metric) series, created empty on first use
+    std::uint32_t series(const std::string& entity, const std::string& metric);
+    void sample(std::uint32_t series, SimTime time, double value);   //times of a series must not decrease
+
+    std::uint32_t distribution(const std::string& entity, const std::string& metric);
+    void observe(std::uint32_t distribution, double value);
+
+    //at most `points` points of the series over [from, to], with min/max envelope
+    ChartSlice chart(std::uint32_t series, double from, double to, std::size_t points) const;
+
+    void summary(const std::string& entity, const std::string& metric, double value);
+    void histogram(Histogram h);
+    void add_table(const std::string& name, ResultTable table);
+
+    const std::vector<Series>& all_series() const { return series_list; }
+    const std::vector<SummaryValue>& all_summaries() const { return summaries; }
+    const std::vector<Histogram>& all_histograms() const { return histograms; }
+    const std::vector<std::pair<std::string, ResultTable>>& tables() const { return extra_tables; }
+    const std::vector<Distribution>& all_distributions() const { return distributions; }
+    const SpillFile* spill_file() const { return spill.get(); }
+
+    std::size_t sample_count() const;           //held in memory
+    std::uint64_t dropped_samples() const { return dropped; }
+    std::size_t memory_bytes() const;           //approximate
+};
@@ -0,0 +1,163 @@
+#include "spill_file.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+
+namespace {
+
+void put_varint(vector<unsigned char>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<unsigned char>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(v));
+}
+
+uint64_t get_varint(const unsigned char*& p, const unsigned char* end) {
+    uint64_t v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        unsigned char b = *p++;
+        v |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    throw std::runtime_error("Corrupt spill block");
+}
+
+uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+uint64_t bits_of(double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+double double_of(uint64_t bits) {
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+void put_le(vector<unsigned char>& out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+}
+
+uint64_t get_le(const unsigned char*& p, const unsigned char* end, int bytes) {
+    if (end - p < bytes) throw std::runtime_error("Corrupt spill block");
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= uint64_t(*p++) << (8 * i);
+    return v;
+}
+
+//header byte: leading zero bytes in the high nibble, trailing ones in the low; x == 0 is 0x80
+void put_xor(vector<unsigned char>& out, uint64_t x) {
+    int lead = x ? __builtin_clzll(x) / 8 : 8;
+    int trail = x ? __builtin_ctzll(x) / 8 : 0;
+    out.push_back(static_cast<unsigned char>(lead << 4 | trail));
+    put_le(out, x >> (8 * trail), 8 - lead - trail);
+}
+
+uint64_t get_xor(const unsigned char*& p, const unsigned char* end) {
+    if (p == end) throw std::runtime_error("Corrupt spill block");
+    int lead = *p >> 4, trail = *p & 0xf;
+    ++p;
+    if (lead + trail > 8) throw std::runtime_error("Corrupt spill block");
+    return get_le(p, end, 8 - lead - trail) << (8 * trail);
+}
+
+}
+
+SpillFile::SpillFile(string path) : file_path(std::move(path)) {
+    file.open(file_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) throw std::runtime_error("Cannot open spill file: " + file_path);
+}
+
+SpillFile::~SpillFile() {
+    file.close();
+    std::remove(file_path.c_str());
+}
+
+void SpillFile::append(uint32_t series, const double* time, const double* value, size_t n) {
+    if (n == 0) return;
+    if (n > UINT32_MAX) throw std::invalid_argument("Spill block too large");
+
+    buffer.clear();
+    buffer.resize(12);
+    int64_t t_prev = static_cast<int64_t>(time[0]);
+    int64_t delta_prev = 0;
+    uint64_t v_prev = bits_of(value[0]);
+    put_le(buffer, static_cast<uint64_t>(t_prev), 8);
+    put_le(buffer, v_prev, 8);
+    for (size_t i = 1; i < n; ++i) {
+        int64_t t = static_cast<int64_t>(time[i]);
+        int64_t delta = t - t_prev;
+        put_varint(buffer, zigzag(delta - delta_prev));
+        t_prev = t;
+        delta_prev = delta;
+
+        uint64_t v = bits_of(value[i]);
+        put_xor(buffer, v ^ v_prev);
+        v_prev = v;
+    }
+
+    uint32_t payload = static_cast<uint32_t>(buffer.size() - 12);
+    uint32_t header[3] = {series, static_cast<uint32_t>(n), payload};
+    for (int i = 0; i < 3; ++i)
+        for (int b = 0; b < 4; ++b) buffer[size_t(i * 4 + b)] = static_cast<unsigned char>(header[i] >> (8 * b));
+
+    file.seekp(static_cast<std::streamoff>(end));
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (!file) throw std::runtime_error("Cannot write spill file: " + file_path);
+
+    if (series >= blocks.size()) {
+        blocks.resize(series + 1);
+        counts.resize(series + 1, 0);
+    }
+    blocks[series].push_back({end + 12, static_cast<uint32_t>(n), payload});
+    counts[series] += n;
+    end += buffer.size();
+}
+
+void SpillFile::for_each_block(uint32_t series, const BlockVisitor& visit) const {
+    if (series >= blocks.size()) return;
+
+    file.flush();
+    vector<unsigned char> payload;
+    vector<double> time, value;
+    for (const Block& block : blocks[series]) {
+        payload.resize(block.bytes);
+        file.seekg(static_cast<std::streamoff>(block.offset));
+        file.read(reinterpret_cast<char*>(payload.data()), block.bytes);
+        if (!file) throw std::runtime_error("Cannot read spill file: " + file_path);
+
+        const unsigned char* p = payload.data();
+        const unsigned char* stop = p + payload.size();
+        time.resize(block.count);
+        value.resize(block.count);
+        int64_t t = static_cast<int64_t>(get_le(p, stop, 8));
+        int64_t delta = 0;
+        uint64_t v = get_le(p, stop, 8);
+        time[0] = static_cast<double>(t);
+        value[0] = double_of(v);
+        for (size_t i = 1; i < block.count; ++i) {
+            delta += unzigzag(get_varint(p, stop));
+            t += delta;
+            v ^= get_xor(p, stop);
+            time[i] = static_cast<double>(t);
+            value[i] = double_of(v);
+        }
+        visit(time, value);
+    }
+}
+
+size_t SpillFile::memory_bytes() const {
+    size_t n = sizeof(*this) + buffer.capacity() + counts.capacity() * sizeof(uint64_t);
+    for (const auto& b : blocks) n += sizeof(b) + b.capacity() * sizeof(Block);
+    return n;
+}
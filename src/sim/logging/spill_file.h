@@ -0,0 +1,55 @@
+//spill_file.h is where bounded-memory runs put the samples that leave a series' rolling window.
+//evicted samples are appended as compressed blocks and read back, oldest first, when the run
+//is exported, so memory holds only the window plus a small per-block index.
+//
+//  block   := u32 series | u32 count | u32 payload_bytes | payload
+//  payload := time[0] i64 | value[0] f64 bits | (time delta-of-delta, value xor)*
+//
+//times (SimTime, so integral) are stored as zigzag varints of their delta-of-delta, which is a
+//single zero byte for a series sampled at a fixed interval. a value is stored as the xor of its
+//bits with the previous value's: one byte with the counts of leading and trailing zero bytes,
+//then the bytes between them, so a repeated value costs one byte.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+class SpillFile {
+private:
+    struct Block {
+        std::uint64_t offset;       //of the payload
+        std::uint32_t count;
+        std::uint32_t bytes;
+    };
+
+    std::string file_path;
+    mutable std::fstream file;
+    std::vector<std::vector<Block>> blocks;     //by series
+    std::vector<std::uint64_t> counts;          //by series
+    std::uint64_t end = 0;
+    std::vector<unsigned char> buffer;
+
+public:
+    using BlockVisitor = std::function<void(const std::vector<double>& time, const std::vector<double>& value)>;
+
+    //creates (or truncates) the file
+    explicit SpillFile(std::string path);
+    ~SpillFile();
+
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    //the samples must follow everything appended for the series before
+    void append(std::uint32_t series, const double* time, const double* value, std::size_t n);
+
+    //decodes the series' blocks in order
+    void for_each_block(std::uint32_t series, const BlockVisitor& visit) const;
+
+    std::uint64_t count(std::uint32_t series) const { return series < counts.size() ? counts[series] : 0; }
+    std::uint64_t bytes() const { return end; }
+    const std::string& path() const { return file_path; }
+    std::size_t memory_bytes() const;
+};
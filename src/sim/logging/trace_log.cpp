@@ -0,0 +1,41 @@
+#include "trace_log.h"
+#include <cstdio>
+#include <stdexcept>
+
+using std::size_t;
+using std::string;
+
+TraceLog::TraceLog(string prefix, std::uint64_t max_file_bytes, size_t max_files)
+    : prefix(std::move(prefix)), max_file_bytes(max_file_bytes), max_files(max_files) {
+    if (max_file_bytes == 0 || max_files == 0)
+        throw std::invalid_argument("Trace log needs a positive file size and file count");
+    out.open(path_of(0), std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot open trace log: " + path_of(0));
+}
+
+string TraceLog::path_of(std::uint64_t index) const {
+    return prefix + "." + std::to_string(index) + ".log";
+}
+
+void TraceLog::open_next() {
+    out.close();
+    ++file_index;
+    if (file_index >= max_files) std::remove(path_of(file_index - max_files).c_str());
+
+    out.open(path_of(file_index), std::ios::trunc);
+    if (!out) throw std::runtime_error("Cannot open trace log: " + path_of(file_index));
+    written = 0;
+}
+
+void TraceLog::write(SimTime time, const string& entity, const string& message) {
+    if (written >= max_file_bytes) open_next();
+
+    string line = std::to_string(time);
+    line += '\t';
+    line += entity;
+    line += '\t';
+    line += message;
+    line += '\n';
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    written += line.size();
+}
@@ -0,0 +1,31 @@
+//trace_log.h is a rolling text trace of a run: one "time<TAB>entity<TAB>message" line per event,
+//written to prefix.0.log, prefix.1.log, ... a new file is started once the current one reaches
+//max_file_bytes, and only the newest max_files are kept, so a trace of any length stays within
+//max_file_bytes * max_files on disk
+#pragma once
+#include "../core/sim_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+class TraceLog {
+private:
+    std::string prefix;
+    std::uint64_t max_file_bytes;
+    std::size_t max_files;
+    std::ofstream out;
+    std::uint64_t written = 0;      //to the current file
+    std::uint64_t file_index = 0;
+
+    std::string path_of(std::uint64_t index) const;
+    void open_next();
+
+public:
+    TraceLog(std::string prefix, std::uint64_t max_file_bytes = 64ull << 20, std::size_t max_files = 8);
+
+    void write(SimTime time, const std::string& entity, const std::string& message);
+    void flush() { out.flush(); }
+
+    std::string current_path() const { return path_of(file_index); }
+};
@@ -0,0 +1,683 @@
+#include "distributed.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+using std::size_t;
+using std::string;
+using std::uint32_t;
+using std::uint64_t;
+using std::vector;
+using namespace sweep_protocol;
+
+namespace {
+
+constexpr uint32_t MAX_FRAME_BYTES = 64u << 20;
+constexpr double HEARTBEAT_SECONDS = 2.0;
+
+double seconds_now() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ---------------- Frames ----------------
+
+class FrameOut {
+private:
+    vector<unsigned char> buf;
+
+    void le(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) buf.push_back(static_cast<unsigned char>(v >> (8 * i)));
+    }
+
+public:
+    explicit FrameOut(Frame type) {
+        buf.resize(4);
+        buf.push_back(static_cast<unsigned char>(type));
+    }
+
+    FrameOut& u32(uint32_t v) { le(v, 4); return *this; }
+    FrameOut& u64(uint64_t v) { le(v, 8); return *this; }
+    FrameOut& i32(int32_t v) { le(static_cast<uint32_t>(v), 4); return *this; }
+    FrameOut& f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return u64(bits);
+    }
+    FrameOut& str(const string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        buf.insert(buf.end(), s.begin(), s.end());
+        return *this;
+    }
+
+    const vector<unsigned char>& bytes() {
+        uint32_t n = static_cast<uint32_t>(buf.size() - 4);
+        for (int i = 0; i < 4; ++i) buf[size_t(i)] = static_cast<unsigned char>(n >> (8 * i));
+        return buf;
+    }
+};
+
+class FrameIn {
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+
+    uint64_t le(int bytes) {
+        if (end - p < bytes) throw std::runtime_error("Truncated sweep frame");
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= uint64_t(*p++) << (8 * i);
+        return v;
+    }
+
+public:
+    explicit FrameIn(const vector<unsigned char>& payload)
+        : p(payload.data()), end(payload.data() + payload.size()) {}
+
+    size_t remaining() const { return static_cast<size_t>(end - p); }
+
+    uint32_t u32() { return static_cast<uint32_t>(le(4)); }
+    uint64_t u64() { return le(8); }
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+    double f64() {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    string str() {
+        uint32_t n = u32();
+        if (static_cast<uint64_t>(end - p) < n) throw std::runtime_error("Truncated sweep frame");
+        string s(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return s;
+    }
+};
+
+bool send_frame(int fd, FrameOut& frame) {
+    const auto& b = frame.bytes();
+    size_t sent = 0;
+    while (sent < b.size()) {
+        ssize_t n = ::send(fd, b.data() + sent, b.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+//takes one complete frame off the front of `in`
+bool next_frame(vector<unsigned char>& in, Frame& type, vector<unsigned char>& payload) {
+    if (in.size() < 4) return false;
+    uint32_t n = uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+    if (n == 0 || n > MAX_FRAME_BYTES) throw std::runtime_error("Bad sweep frame length");
+    if (in.size() < 4 + size_t(n)) return false;
+    type = static_cast<Frame>(in[4]);
+    payload.assign(in.begin() + 5, in.begin() + 4 + n);
+    in.erase(in.begin(), in.begin() + 4 + n);
+    return true;
+}
+
+//appends what is available; false once the peer has closed or failed
+bool receive(int fd, vector<unsigned char>& in) {
+    unsigned char chunk[64 * 1024];
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) return true;
+    if (n <= 0) return false;
+    in.insert(in.end(), chunk, chunk + n);
+    return true;
+}
+
+// ---------------- Sockets and processes ----------------
+
+//launched workers must not inherit the coordinator's sockets
+void close_on_exec(int fd) {
+    fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+void split_host_port(const string& address, string& host, string& port) {
+    size_t colon = address.rfind(':');
+    if (colon == string::npos) throw std::invalid_argument("Expected host:port, got " + address);
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+}
+
+int listen_on(const string& host, uint16_t port, uint16_t& bound) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &found) != 0 || !found)
+        throw std::runtime_error("Cannot resolve " + host);
+
+    int fd = ::socket(found->ai_family, found->ai_socktype, found->ai_protocol);
+    int yes = 1;
+    if (fd >= 0) {
+        close_on_exec(fd);
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    }
+    if (fd < 0 || ::bind(fd, found->ai_addr, found->ai_addrlen) != 0 || ::listen(fd, 64) != 0) {
+        freeaddrinfo(found);
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error("Cannot listen on " + host + ":" + std::to_string(port) + ": " + std::strerror(errno));
+    }
+    freeaddrinfo(found);
+
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound = ntohs(addr.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port
+                                             : reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    return fd;
+}
+
+//retries until `timeout` seconds have passed, so workers may start before the coordinator
+int connect_to(const string& address, double timeout) {
+    string host, port;
+    split_host_port(address, host, port);
+    const double deadline = seconds_now() + timeout;
+    while (true) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) == 0) {
+            for (addrinfo* a = found; a; a = a->ai_next) {
+                int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+                if (fd < 0) continue;
+                if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+                    int yes = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                    freeaddrinfo(found);
+                    return fd;
+                }
+                ::close(fd);
+            }
+            freeaddrinfo(found);
+        }
+        if (seconds_now() >= deadline) return -1;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+}
+
+string expand(string command, const string& coordinator, size_t worker) {
+    auto replace = [&](const string& key, const string& value) {
+        for (size_t at = command.find(key); at != string::npos; at = command.find(key, at + value.size()))
+            command.replace(at, key.size(), value);
+    };
+    replace("{coordinator}", coordinator);
+    replace("{worker}", std::to_string(worker));
+    return command;
+}
+
+//each worker gets its own process group, so signalling -pid reaches whatever the shell started
+pid_t launch(const string& command) {
+    const char* argv[] = {"sh", "-c", command.c_str(), nullptr};
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attr, 0);
+    pid_t pid = -1;
+    int rc = posix_spawn(&pid, "/bin/sh", nullptr, &attr, const_cast<char* const*>(argv), environ);
+    posix_spawnattr_destroy(&attr);
+    return rc == 0 ? pid : -1;
+}
+
+template <typename F>
+class ScopeExit {
+private:
+    F fn;
+
+public:
+    explicit ScopeExit(F fn) : fn(std::move(fn)) {}
+    ~ScopeExit() { fn(); }
+};
+
+void encode_runs(FrameOut& out, uint64_t unit, const vector<SweepDriver::UnitResult>& runs) {
+    out.u64(unit).u32(static_cast<uint32_t>(runs.size()));
+    for (const auto& run : runs) {
+        out.u64(run.point).u32(static_cast<uint32_t>(run.replica)).u32(static_cast<uint32_t>(run.metrics.size()));
+        for (const auto& [name, value] : run.metrics) out.str(name).f64(value);
+    }
+}
+
+vector<SweepDriver::UnitResult> decode_runs(FrameIn& in) {
+    //a run takes at least its point, replica and metric count; a larger count cannot be genuine
+    uint32_t count = in.u32();
+    if (count > in.remaining() / 16) throw std::runtime_error("Truncated sweep frame");
+    vector<SweepDriver::UnitResult> runs(count);
+    for (auto& run : runs) {
+        run.point = static_cast<size_t>(in.u64());
+        run.replica = static_cast<int>(in.u32());
+        for (uint32_t m = in.u32(); m > 0; --m) {
+            string name = in.str();
+            run.metrics[name] = in.f64();
+        }
+    }
+    return runs;
+}
+
+}
+
+// ---------------- ShardMerge ----------------
+
+ShardMerge::ShardMerge(size_t points, size_t replicas)
+    : points(points), replicas(replicas), results(points * replicas), filled(points * replicas, false) {}
+
+void ShardMerge::add(const SweepDriver::UnitResult& run) {
+    //checked before the slot is computed, which a wild point could overflow into range
+    if (run.point >= points || run.replica < 0 || static_cast<size_t>(run.replica) >= replicas)
+        throw std::out_of_range("Shard result outside the sweep grid");
+    size_t slot = run.point * replicas + static_cast<size_t>(run.replica);
+    if (filled[slot]) return;
+    filled[slot] = true;
+    ++filled_count;
+    results[slot] = run.metrics;
+
+    for (const auto& [metric, value] : run.metrics) {
+        MetricSummary& s = summaries[{run.point, metric}];
+        s.min = s.stat.count() ? std::min(s.min, value) : value;
+        s.max = s.stat.count() ? std::max(s.max, value) : value;
+        s.stat.add(value);
+        s.sketch.add(value);
+    }
+}
+
+const MetricSummary* ShardMerge::summary(size_t point, const string& metric) const {
+    auto it = summaries.find({point, metric});
+    return it == summaries.end() ? nullptr : &it->second;
+}
+
+// ---------------- Coordinator ----------------
+
+SweepCoordinator::SweepCoordinator(const SweepDriver& driver, DistributedConfig config)
+    : driver(driver), config(std::move(config)) {}
+
+ResultTable SweepCoordinator::run() {
+    const size_t total = driver.unit_count();
+    const uint64_t fingerprint = driver.fingerprint();
+    ShardMerge merge(driver.point_count(), driver.replica_count());
+
+    struct Unit {
+        bool done = false;
+        size_t attempts = 0;            //failed runs
+        double started = 0.0;
+        vector<int> running_on;         //connection ids
+    };
+
+    struct Connection {
+        int fd;
+        vector<unsigned char> in;
+        bool ready = false;             //HELLO accepted
+        uint32_t slots = 0;
+        uint32_t busy = 0;              //units sent and not yet answered, including abandoned copies
+        int worker = -1;                //index into the launched workers, -1 if started by hand
+        double last_seen;
+        std::set<size_t> units;
+    };
+
+    struct Launched {
+        string command;
+        pid_t pid = -1;
+        unsigned restarts = 0;
+    };
+
+    vector<Unit> units(total);
+    std::deque<size_t> pending;
+    for (size_t u = 0; u < total; ++u) pending.push_back(u);
+    vector<double> durations;
+    std::map<int, Connection> connections;
+    int next_connection = 0;
+    vector<Launched> launched;
+    SweepProgress progress;
+    progress.units_total = total;
+    progress.merged = &merge;
+
+    uint16_t port = 0;
+    int listen_fd = listen_on(config.listen_host, config.port, port);
+    const string address = config.advertise_host + ":" + std::to_string(port);
+
+    ScopeExit shutdown([&] {
+        for (auto& [id, c] : connections) {
+            FrameOut stop(Frame::STOP);
+            send_frame(c.fd, stop);
+            ::close(c.fd);
+        }
+        ::close(listen_fd);
+
+        //workers exit on STOP once their current unit is done; give them a moment, then insist
+        const double deadline = seconds_now() + 5.0;
+        for (auto& w : launched) {
+            if (w.pid <= 0) continue;
+            while (waitpid(w.pid, nullptr, WNOHANG) == 0) {
+                if (seconds_now() > deadline) {
+                    kill(-w.pid, SIGKILL);
+                    waitpid(w.pid, nullptr, 0);
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+            kill(-w.pid, SIGKILL);  //anything the shell left behind
+            w.pid = -1;
+        }
+    });
+
+    if (on_listening) on_listening(port);
+    for (size_t i = 0; i < config.worker_commands.size(); ++i) {
+        launched.push_back({expand(config.worker_commands[i], address, i)});
+        launched.back().pid = launch(launched.back().command);
+        if (launched.back().pid < 0) std::cerr << "sweep: cannot start worker " << i << "\n";
+    }
+
+    auto requeue = [&](size_t u, int connection) {
+        Unit& unit = units[u];
+        unit.running_on.erase(std::remove(unit.running_on.begin(), unit.running_on.end(), connection),
+                              unit.running_on.end());
+        if (!unit.done && unit.running_on.empty()) pending.push_front(u);
+    };
+
+    auto drop = [&](int id) {
+        Connection& c = connections.at(id);
+        ::close(c.fd);
+        for (size_t u : c.units) requeue(u, id);
+        //a launched worker that went quiet is killed; reaping it below starts a fresh one
+        if (c.worker >= 0 && static_cast<size_t>(c.worker) < launched.size() && launched[size_t(c.worker)].pid > 0)
+            kill(-launched[size_t(c.worker)].pid, SIGKILL);
+        connections.erase(id);
+    };
+
+    auto dispatch = [&](int id, Connection& c, size_t u, double now) {
+        FrameOut run(Frame::RUN);
+        run.u64(u);
+        if (!send_frame(c.fd, run)) return false;
+        Unit& unit = units[u];
+        if (unit.running_on.empty()) unit.started = now;
+        unit.running_on.push_back(id);
+        c.units.insert(u);
+        ++c.busy;
+        return true;
+    };
+
+    //the longest-running unit, if it is running alone and well past the median unit time
+    auto straggler = [&](const Connection& c, double now) -> long {
+        if (durations.size() < 3) return -1;
+        vector<double> sorted = durations;
+        std::nth_element(sorted.begin(), sorted.begin() + long(sorted.size() / 2), sorted.end());
+        double limit = config.straggler_factor * sorted[sorted.size() / 2];
+
+        long best = -1;
+        double longest = limit;
+        for (const auto& [id, other] : connections) {
+            for (size_t u : other.units) {
+                const Unit& unit = units[u];
+                if (unit.done || unit.running_on.size() != 1 || c.units.count(u)) continue;
+                if (now - unit.started > longest) {
+                    longest = now - unit.started;
+                    best = static_cast<long>(u);
+                }
+            }
+        }
+        return best;
+    };
+
+    double idle_since = seconds_now();
+    string fatal;
+    vector<pollfd> fds;
+    vector<int> ids;
+    vector<unsigned char> payload;
+
+    while (progress.units_done < total) {
+        if (!fatal.empty()) throw std::runtime_error(fatal);
+        fds.assign(1, pollfd{listen_fd, POLLIN, 0});
+        ids.assign(1, -1);
+        for (auto& [id, c] : connections) {
+            fds.push_back(pollfd{c.fd, POLLIN, 0});
+            ids.push_back(id);
+        }
+        if (::poll(fds.data(), fds.size(), 200) < 0 && errno != EINTR)
+            throw std::runtime_error(string("poll failed: ") + std::strerror(errno));
+        double now = seconds_now();
+
+        if (fds[0].revents & POLLIN) {
+            int fd = ::accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0) {
+                int yes = 1;
+                close_on_exec(fd);
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                connections.emplace(next_connection++, Connection{fd, {}, false, 0, 0, -1, now, {}});
+            }
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (!fds[i].revents) continue;
+            int id = ids[i];
+            Connection& c = connections.at(id);
+            if (!receive(c.fd, c.in)) {
+                drop(id);
+                continue;
+            }
+            c.last_seen = now;
+
+            Frame type;
+            bool alive = true;
+            try {
+                while (alive && next_frame(c.in, type, payload)) {
+                    FrameIn in(payload);
+                    if (type == Frame::HELLO) {
+                        uint32_t version = in.u32();
+                        uint64_t theirs = in.u64();
+                        c.slots = std::max<uint32_t>(in.u32(), 1);
+                        c.worker = in.i32();
+                        if (version != VERSION || theirs != fingerprint) {
+                            FrameOut reject(Frame::REJECT);
+                            reject.str(version != VERSION ? "protocol version differs" : "worker set up a different sweep");
+                            send_frame(c.fd, reject);
+                            std::cerr << "sweep: rejected a worker whose sweep does not match\n";
+                            drop(id);
+                            alive = false;
+                            continue;
+                        }
+                        c.ready = true;
+                    } else if (type == Frame::RESULT || type == Frame::FAILED) {
+                        size_t u = static_cast<size_t>(in.u64());
+                        if (u >= total) throw std::runtime_error("unit out of range");
+                        if (!c.ready || !c.units.count(u)) throw std::runtime_error("answer to a unit it was not sent");
+                        if (c.busy) --c.busy;
+                        c.units.erase(u);
+                        Unit& unit = units[u];
+
+                        if (type == Frame::RESULT) {
+                            vector<SweepDriver::UnitResult> runs = decode_runs(in);
+                            if (unit.done) continue;    //the slower copy of a re-dispatched unit
+                            for (const auto& run : runs) merge.add(run);
+                            unit.done = true;
+                            unit.running_on.clear();
+                            durations.push_back(now - unit.started);
+                            ++progress.units_done;
+                            if (on_progress) {
+                                progress.workers = connections.size();
+                                on_progress(progress);
+                            }
+                        } else {
+                            string error = in.str();
+                            if (unit.done) continue;
+                            if (++unit.attempts >= config.max_unit_attempts)
+                                fatal = "Sweep unit " + std::to_string(u) + " failed " +
+                                        std::to_string(unit.attempts) + " times: " + error;
+                            else
+                                requeue(u, id);
+                        }
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "sweep: dropping worker after a bad frame: " << e.what() << "\n";
+                drop(id);
+            }
+        }
+
+        for (auto it = connections.begin(); it != connections.end();) {
+            int id = it->first;
+            ++it;
+            if (now - connections.at(id).last_seen > config.heartbeat_timeout) drop(id);
+        }
+
+        //restart launched workers that exited before the sweep was done
+        for (size_t i = 0; i < launched.size(); ++i) {
+            Launched& w = launched[i];
+            if (w.pid <= 0 || waitpid(w.pid, nullptr, WNOHANG) == 0) continue;
+            w.pid = -1;
+            if (w.restarts >= config.max_restarts) {
+                std::cerr << "sweep: worker " << i << " exited too often, not restarting\n";
+                continue;
+            }
+            ++w.restarts;
+            ++progress.restarts;
+            w.pid = launch(w.command);
+        }
+
+        for (auto& [id, c] : connections) {
+            if (!c.ready) continue;
+            while (c.busy < c.slots) {
+                while (!pending.empty() && units[pending.front()].done) pending.pop_front();
+                long u = -1;
+                if (!pending.empty()) {
+                    u = static_cast<long>(pending.front());
+                    pending.pop_front();
+                } else if ((u = straggler(c, now)) >= 0) {
+                    ++progress.redispatched;
+                } else {
+                    break;
+                }
+                if (!dispatch(id, c, static_cast<size_t>(u), now)) {
+                    requeue(static_cast<size_t>(u), id);
+                    break;
+                }
+            }
+        }
+
+        bool any_launched = std::any_of(launched.begin(), launched.end(), [](const Launched& w) { return w.pid > 0; });
+        if (!connections.empty() || any_launched) idle_since = now;
+        else if (now - idle_since > config.idle_timeout)
+            throw std::runtime_error("Sweep has no workers left");
+    }
+
+    return driver.assemble(merge.all_results());
+}
+
+// ---------------- Worker ----------------
+
+int run_sweep_worker(const SweepDriver& driver, const string& coordinator, int worker, unsigned threads) {
+    if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+    int fd = connect_to(coordinator, 30.0);
+    if (fd < 0) {
+        std::cerr << "sweep worker: cannot reach " << coordinator << "\n";
+        return 1;
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<uint64_t> queue;
+    bool stopping = false;
+    std::mutex send_mutex;
+    auto send = [&](FrameOut& frame) {
+        std::lock_guard<std::mutex> lock(send_mutex);
+        send_frame(fd, frame);
+    };
+
+    FrameOut hello(Frame::HELLO);
+    hello.u32(VERSION).u64(driver.fingerprint()).u32(threads).i32(worker);
+    send(hello);
+
+    auto run_units = [&] {
+        while (true) {
+            uint64_t unit;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (stopping) return;
+                unit = queue.front();
+                queue.pop_front();
+            }
+            try {
+                auto runs = driver.run_unit(static_cast<size_t>(unit));
+                FrameOut result(Frame::RESULT);
+                encode_runs(result, unit, runs);
+                send(result);
+            } catch (const std::exception& e) {
+                FrameOut failed(Frame::FAILED);
+                failed.u64(unit).str(e.what());
+                send(failed);
+            }
+        }
+    };
+
+    vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) pool.emplace_back(run_units);
+    std::thread heartbeat([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::duration<double>(HEARTBEAT_SECONDS), [&] { return stopping; })) {
+            lock.unlock();
+            FrameOut beat(Frame::HEARTBEAT);
+            send(beat);
+            lock.lock();
+        }
+    });
+
+    int status = 1;     //the coordinator went away without STOP
+    vector<unsigned char> in, payload;
+    Frame type;
+    try {
+        while (status == 1 && receive(fd, in)) {
+            while (next_frame(in, type, payload)) {
+                FrameIn frame(payload);
+                if (type == Frame::RUN) {
+                    uint64_t unit = frame.u64();
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push_back(unit);
+                    wake.notify_all();  //the heartbeat thread waits on it too
+                } else if (type == Frame::STOP) {
+                    status = 0;
+                    break;
+                } else if (type == Frame::REJECT) {
+                    std::cerr << "sweep worker: rejected: " << frame.str() << "\n";
+                    status = 2;
+                    break;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "sweep worker: " << e.what() << "\n";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wake.notify_all();
+    for (auto& t : pool) t.join();
+    heartbeat.join();
+    ::close(fd);
+    return status;
+}
@@ -0,0 +1,126 @@
+//distributed.h runs a sweep's units (SweepDriver::run_unit) on worker processes over TCP, so
+//one study can use several machines. replications of a single model are a sweep without axes.
+//
+//every worker runs the same program and builds the same SweepDriver; the coordinator checks
+//this with SweepDriver::fingerprint() and then only sends unit numbers. the coordinator
+//  - launches workers from shell commands ("{coordinator}" becomes host:port, "{worker}" the
+//    command's index), e.g. "./simulator --worker {coordinator}" or "ssh box2 ..." for other
+//    hosts, and restarts a worker whose process exits or stops sending heartbeats;
+//  - also accepts workers started by hand that connect to it;
+//  - hands units out as workers have free slots; once none are left to hand out, an idle worker
+//    re-runs the longest-running unit if it is taking straggler_factor times the median unit
+//    time, and whichever copy finishes first is kept;
+//  - merges every shard as it arrives: per (point, metric) running mean/variance, min/max and a
+//    quantile sketch over the replicas seen so far, reported through on_progress.
+//
+//  frame := u32 length | u8 type | payload            (length counts type + payload; little-endian)
+//  HELLO     worker -> coordinator  u32 version | u64 fingerprint | u32 slots | i32 worker
+//  RUN       coordinator -> worker  u64 unit
+//  RESULT    worker -> coordinator  u64 unit | u32 runs | (u64 point | u32 replica | u32 metrics
+//                                   | (string name | f64 value)*)*
+//  FAILED    worker -> coordinator  u64 unit | string error
+//  HEARTBEAT worker -> coordinator  (empty)
+//  STOP      coordinator -> worker  (empty)
+//  REJECT    coordinator -> worker  string reason
+//  string := u32 length | bytes
+//
+//POSIX sockets and processes only.
+#pragma once
+#include "sweep.h"
+#include "../logging/quantile_sketch.h"
+#include "../stats/confidence.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sweep_protocol {
+
+constexpr std::uint32_t VERSION = 1;
+
+enum class Frame : std::uint8_t {
+    HELLO = 1,
+    RUN = 2,
+    RESULT = 3,
+    FAILED = 4,
+    HEARTBEAT = 5,
+    STOP = 6,
+    REJECT = 7
+};
+
+}
+
+struct DistributedConfig {
+    std::string listen_host = "127.0.0.1";      //"0.0.0.0" for workers on other hosts
+    std::uint16_t port = 0;                     //0 picks a free port
+    std::string advertise_host = "127.0.0.1";   //what "{coordinator}" expands to
+
+    std::vector<std::string> worker_commands;   //run through /bin/sh -c
+    unsigned max_restarts = 3;                  //per command
+
+    double straggler_factor = 2.0;
+    std::size_t max_unit_attempts = 3;          //failures of one unit before the sweep fails
+    double heartbeat_timeout = 30.0;            //seconds without a frame before a worker is dropped
+    double idle_timeout = 60.0;                 //seconds with no worker at all before giving up
+};
+
+//one (point, metric) over the replicas merged so far
+struct MetricSummary {
+    RunningStat stat;
+    double min = 0.0;
+    double max = 0.0;
+    QuantileSketch sketch;
+};
+
+class ShardMerge {
+private:
+    std::size_t points;
+    std::size_t replicas;
+    std::vector<Metrics> results;
+    std::vector<bool> filled;
+    std::size_t filled_count = 0;
+    std::map<std::pair<std::size_t, std::string>, MetricSummary> summaries;
+
+public:
+    ShardMerge(std::size_t points, std::size_t replicas);
+
+    //a run already merged (the other copy of a re-dispatched unit) is ignored
+    void add(const SweepDriver::UnitResult& run);
+
+    std::size_t runs() const { return filled_count; }
+    const MetricSummary* summary(std::size_t point, const std::string& metric) const;
+    const std::map<std::pair<std::size_t, std::string>, MetricSummary>& all_summaries() const { return summaries; }
+    const std::vector<Metrics>& all_results() const { return results; }
+};
+
+struct SweepProgress {
+    std::size_t units_done = 0;
+    std::size_t units_total = 0;
+    std::size_t workers = 0;            //connected
+    std::size_t restarts = 0;
+    std::size_t redispatched = 0;       //straggler copies handed out
+    const ShardMerge* merged = nullptr;
+};
+
+class SweepCoordinator {
+private:
+    const SweepDriver& driver;
+    DistributedConfig config;
+
+public:
+    SweepCoordinator(const SweepDriver& driver, DistributedConfig config);
+
+    std::function<void(const SweepProgress&)> on_progress;     //after every merged shard
+    std::function<void(std::uint16_t port)> on_listening;      //once the port is bound
+
+    //the same table as SweepDriver::run()
+    ResultTable run();
+};
+
+//the worker side: connects to "host:port", runs units on `threads` threads until told to stop;
+//returns a process exit code
+int run_sweep_worker(const SweepDriver& driver, const std::string& coordinator, int worker = -1,
+                     unsigned threads = 0);
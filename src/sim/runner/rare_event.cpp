@@ -0,0 +1,230 @@
+#include "rare_event.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+double metric_or_throw(const Metrics& m, const string& key) {
+    auto it = m.find(key);
+    if (it == m.end())
+        throw std::runtime_error("Importance sampling needs metric '" + key + "' from the run function");
+    return it->second;
+}
+
+}
+
+RareEventRunner::RareEventRunner(vector<IRNode> model, RunFn run, RareEventRule rule)
+    : model(std::move(model)),
+      run_fn(std::move(run)),
+      rule(std::move(rule)) {
+    const RareEventRule& r = this->rule;
+    if (!r.importance)
+        throw std::invalid_argument("Rare-event rule has no importance function");
+    if (r.step == 0 || r.duration == 0)
+        throw std::invalid_argument("Rare-event rule needs a positive step and duration");
+
+    if (r.method == RareEventMethod::SPLITTING) {
+        if (r.levels.empty())
+            throw std::invalid_argument("Splitting needs at least one level below the target");
+        for (size_t i = 0; i < r.levels.size(); ++i) {
+            if (r.levels[i] >= r.target || (i > 0 && r.levels[i] <= r.levels[i - 1]))
+                throw std::invalid_argument("Splitting levels must be ascending and below the target");
+        }
+        if (r.splits.size() != 1 && r.splits.size() != r.levels.size())
+            throw std::invalid_argument("Splitting needs one split factor, or one per level");
+        for (unsigned s : r.splits) {
+            if (s == 0) throw std::invalid_argument("Split factors must be at least 1");
+        }
+        return;
+    }
+
+    //IMPORTANCE_SAMPLING: the biased model and the per-entity terms of the likelihood ratio
+    for (const auto& entry : r.biased_prob) {
+        auto it = std::find_if(this->model.begin(), this->model.end(),
+                               [&](const IRNode& n) { return n.id == entry.first; });
+        if (it == this->model.end())
+            throw std::invalid_argument("Biased failure_prob for unknown entity '" + entry.first + "'");
+    }
+    sampling_model = this->model;
+    for (IRNode& node : sampling_model) {
+        double p = node.failure_prob;
+        auto it = r.biased_prob.find(node.id);
+        double q = it != r.biased_prob.end() ? it->second
+                 : p > 0.0 ? std::max(p, std::min(r.max_biased_prob, p * r.bias_factor))
+                 : p;
+        if (q == p) continue;
+        if (!(p > 0.0 && p < 1.0) || !(q > 0.0 && q < 1.0))
+            throw std::invalid_argument("Biased failure_prob of '" + node.id +
+                                        "' needs 0 < p, q < 1 (p = " + std::to_string(p) +
+                                        ", q = " + std::to_string(q) + ")");
+        node.failure_prob = q;
+        biases.push_back({node.id + r.trials_suffix, node.id + r.failures_suffix,
+                          std::log(p / q), std::log1p(-p) - std::log1p(-q)});
+    }
+}
+
+double RareEventRunner::log_likelihood_ratio(const Metrics& window) const {
+    double log_ratio = 0.0;
+    for (const Bias& b : biases) {
+        double trials = metric_or_throw(window, b.trials);
+        double failures = metric_or_throw(window, b.failures);
+        log_ratio += failures * b.log_fail + (trials - failures) * b.log_pass;
+    }
+    return log_ratio;
+}
+
+// ---------------- Importance sampling ----------------
+
+RareEventRunner::RunResult RareEventRunner::sample(size_t run) const {
+    RandomStreams streams(rule.seed, run);
+    Simulation sim;
+    EntityFactory().build(sampling_model, sim, streams);
+
+    //the ratio covers every draw up to the step that decided the run, warm-up included
+    double log_ratio = 0.0;
+    if (rule.warmup > 0) log_ratio += log_likelihood_ratio(run_fn(sim, streams, 0, rule.warmup));
+
+    RunResult result;
+    result.paths = 1;
+    const SimTime end = rule.warmup + rule.duration;
+    SimTime t = rule.warmup;
+    while (t < end && result.hits == 0) {
+        SimTime next = std::min(t + rule.step, end);
+        Metrics window = run_fn(sim, streams, t, next);
+        log_ratio += log_likelihood_ratio(window);
+        if (rule.importance(sim, window) >= rule.target) result.hits = 1;
+        t = next;
+    }
+    result.simulated = t;
+    result.likelihood_ratio = std::exp(log_ratio);
+    result.estimate = result.hits ? result.likelihood_ratio : 0.0;
+    return result;
+}
+
+// ---------------- Multilevel splitting ----------------
+
+RareEventRunner::RunResult RareEventRunner::split(size_t root) const {
+    auto factor = [&](size_t level) { return rule.splits.size() == 1 ? rule.splits[0] : rule.splits[level]; };
+
+    RunResult result;
+
+    //follows one trajectory from `t` on; a copy made at a level continues from the same state,
+    //depth first so only one state per level is alive at a time. `share` is the trajectory's part
+    //of its root: 1 over the product of the split factors of the levels it has crossed
+    std::function<void(Simulation&, RandomStreams&, SimTime, size_t, double)> follow =
+        [&](Simulation& sim, RandomStreams& streams, SimTime t, size_t level, double share) {
+            if (++result.paths > rule.max_paths)
+                throw std::runtime_error("Splitting exceeded max_paths; use fewer levels or smaller split factors");
+            const SimTime end = rule.warmup + rule.duration;
+            while (t < end) {
+                SimTime next = std::min(t + rule.step, end);
+                Metrics window = run_fn(sim, streams, t, next);
+                result.simulated += next - t;
+                t = next;
+
+                double f = rule.importance(sim, window);
+                if (f >= rule.target) {
+                    //levels jumped over on the way are not split, so the hit keeps its share
+                    ++result.hits;
+                    result.estimate += share;
+                    return;
+                }
+                size_t reached = std::upper_bound(rule.levels.begin(), rule.levels.end(), f) - rule.levels.begin();
+                if (reached <= level) continue;
+
+                //a jump over several levels splits by all of their factors at once
+                size_t copies = 1;
+                for (size_t l = level; l < reached; ++l) copies *= factor(l);
+                share /= static_cast<double>(copies);
+                for (size_t c = 1; c < copies; ++c) {
+                    //fork() also copies the entities' own generators, so they are reseeded too
+                    Simulation copy = sim.fork();
+                    RandomStreams copy_streams(streams.seed_for("split." + std::to_string(result.paths)),
+                                               streams.replica());
+                    copy.reseed(copy_streams);
+                    follow(copy, copy_streams, t, reached, share);
+                }
+                level = reached;
+            }
+        };
+
+    RandomStreams streams(rule.seed, root);
+    Simulation sim;
+    EntityFactory().build(model, sim, streams);
+    if (rule.warmup > 0) run_fn(sim, streams, 0, rule.warmup);
+    result.simulated += rule.warmup;
+    follow(sim, streams, rule.warmup, 0, 1.0);
+    return result;
+}
+
+// ---------------- Driver ----------------
+
+RareEventReport RareEventRunner::run() const {
+    RareEventReport report;
+    RunningStat estimates;
+    RunningStat ratios;
+
+    auto one = [&](size_t i) { return rule.method == RareEventMethod::SPLITTING ? split(i) : sample(i); };
+    unsigned wave = rule.threads ? rule.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    //runs are computed in parallel waves but consumed in order, so where the run stops does not
+    //depend on thread timing
+    size_t next = 0;
+    while (next < rule.max_runs) {
+        size_t count = std::min<size_t>(wave, rule.max_runs - next);
+        vector<RunResult> results(count);
+        vector<std::thread> pool;
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        std::atomic<size_t> cursor{0};
+
+        auto worker = [&]() {
+            while (true) {
+                size_t i = cursor.fetch_add(1);
+                if (i >= count) break;
+                try { results[i] = one(next + i); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure) failure = std::current_exception();
+                    cursor = count;
+                }
+            }
+        };
+        for (unsigned t = 1; t < std::min<size_t>(wave, count); ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+        if (failure) std::rethrow_exception(failure);
+
+        for (const RunResult& r : results) {
+            estimates.add(r.estimate);
+            ratios.add(r.likelihood_ratio);
+            ++report.runs;
+            report.hits += r.hits;
+            report.paths += r.paths;
+            report.simulated += r.simulated;
+
+            report.probability = confidence_interval(estimates, rule.confidence);
+            report.converged = report.runs >= rule.min_runs && report.hits > 0 &&
+                               report.probability.relative() <= rule.relative_half_width;
+            if (report.converged) break;
+        }
+        if (report.converged) break;
+        next += count;
+    }
+
+    report.variance = estimates.variance() / static_cast<double>(std::max<size_t>(1, estimates.count()));
+    report.relative_error = estimates.mean() > 0.0 ? std::sqrt(report.variance) / estimates.mean()
+                                                   : std::numeric_limits<double>::infinity();
+    report.mean_likelihood_ratio = ratios.mean();
+    return report;
+}
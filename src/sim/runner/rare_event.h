@@ -0,0 +1,119 @@
+//rare_event.h estimates the probability of an event too rare for plain replications, e.g. an
+//outage caused by failure_prob values of 1e-4..1e-6
+//
+//the event is "importance(simulation, window metrics) reaches `target`" at the end of some step
+//of the measured window [warmup, warmup + duration). the importance function is the model's own
+//measure of how close the system is to the event (a queue length, the number of failed backends).
+//
+//IMPORTANCE_SAMPLING: the model is built with failure_prob raised to a biased q (per entity, or
+//  p * bias_factor), so failures are common. the run function reports how many failure draws it
+//  made and how many failed as "<entity><trials_suffix>" / "<entity><failures_suffix>" for every
+//  biased entity; each run is then weighted by its likelihood ratio
+//      L = prod (p/q)^failures * ((1-p)/(1-q))^(trials-failures)
+//  up to the step where the event happened, and mean(hit * L) is unbiased. mean(L) should stay
+//  near 1: far from it, the bias is too strong for the number of runs.
+//SPLITTING: multilevel splitting with fixed split factors. a trajectory whose importance first
+//  reaches levels[i] is forked into splits[i] copies (Simulation::fork, copies draw from their own
+//  streams); a jump over several levels splits by all of their factors at once. every copy that
+//  reaches the target adds 1 / (product of the split factors of the levels it crossed) to its
+//  root's estimate, so a hit that jumps straight to the target from below the last levels counts
+//  for more. the model is not changed, so this also covers events that do not come from
+//  failure_prob (overload, queue build-up).
+//
+//both report the mean of i.i.d. per-run (per-root) estimates, so the variance and interval are
+//the usual ones; runs continue until the relative half width is reached or the budget runs out.
+//crude Monte Carlo is IMPORTANCE_SAMPLING without any bias.
+#pragma once
+#include "run_types.h"
+#include "../stats/confidence.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+enum class RareEventMethod {
+    IMPORTANCE_SAMPLING,
+    SPLITTING
+};
+
+using ImportanceFn = std::function<double(const Simulation& simulation, const Metrics& window)>;
+
+struct RareEventRule {
+    RareEventMethod method = RareEventMethod::IMPORTANCE_SAMPLING;
+
+    ImportanceFn importance;
+    double target = 0.0;                    //the event: importance >= target
+    SimTime step = 0;                       //importance is evaluated at the end of every step
+
+    SimTime warmup = 0;                     //simulated before the event is watched
+    SimTime duration = 0;                   //window in which the event is watched
+
+    //IMPORTANCE_SAMPLING
+    std::map<std::string, double> biased_prob;  //entity id -> failure_prob used while sampling
+    double bias_factor = 1.0;                   //every other entity with failure_prob > 0: p * factor
+    double max_biased_prob = 0.5;               //cap for bias_factor
+    std::string trials_suffix = ".trials";
+    std::string failures_suffix = ".failures";
+
+    //SPLITTING
+    std::vector<double> levels;             //ascending, below target
+    std::vector<unsigned> splits;           //copies per level (the trajectory included); one entry = all levels
+    std::size_t max_paths = 1 << 20;        //trajectories per root; more fail run() with an error
+
+    double relative_half_width = 0.1;       //stop once the interval is this tight
+    double confidence = 0.95;
+    std::size_t min_runs = 30;              //IS runs or splitting roots
+    std::size_t max_runs = 1000000;
+
+    uint64_t seed = 1;
+    unsigned threads = 0;                   //0 = hardware concurrency
+};
+
+struct RareEventReport {
+    bool converged = false;
+    ConfidenceInterval probability;         //estimate and its interval
+    double variance = 0.0;                  //of the estimate
+    double relative_error = 0.0;            //sqrt(variance) / estimate; infinite without a hit
+
+    std::size_t runs = 0;                   //IS runs or splitting roots
+    std::size_t hits = 0;                   //runs / trajectories that reached the target
+    std::size_t paths = 0;                  //trajectories simulated (SPLITTING: copies included)
+    SimTime simulated = 0;                  //total simulated time over all trajectories
+
+    double mean_likelihood_ratio = 1.0;     //IMPORTANCE_SAMPLING diagnostic, ~1 when healthy
+};
+
+class RareEventRunner {
+private:
+    std::vector<IRNode> model;
+    RunFn run_fn;
+    RareEventRule rule;
+
+    struct Bias {
+        std::string trials;
+        std::string failures;
+        double log_fail;                    //log(p / q)
+        double log_pass;                    //log((1 - p) / (1 - q))
+    };
+
+    std::vector<IRNode> sampling_model;     //IMPORTANCE_SAMPLING: model with biased failure_prob
+    std::vector<Bias> biases;
+
+    struct RunResult {
+        double estimate = 0.0;
+        double likelihood_ratio = 1.0;
+        std::size_t hits = 0;
+        std::size_t paths = 0;
+        SimTime simulated = 0;
+    };
+
+    RunResult sample(std::size_t run) const;
+    RunResult split(std::size_t root) const;
+    double log_likelihood_ratio(const Metrics& window) const;
+
+public:
+    RareEventRunner(std::vector<IRNode> model, RunFn run, RareEventRule rule);
+
+    RareEventReport run() const;
+};
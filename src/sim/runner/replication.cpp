@@ -0,0 +1,187 @@
+#include "replication.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using std::size_t;
+using std::vector;
+
+namespace {
+
+//a detected warm-up draws from its own streams; replications forked from it are numbered from 0
+//and must not replay its draws
+constexpr uint64_t WARMUP_REPLICA = std::numeric_limits<uint64_t>::max();
+
+const double* find_metric(const Metrics& m, const std::string& key) {
+    auto it = m.find(key);
+    return it == m.end() ? nullptr : &it->second;
+}
+
+template <typename IntervalOf>
+bool evaluate(const StoppingRule& rule, IntervalOf interval_of, size_t observations,
+              vector<PrecisionResult>& out) {
+    out.clear();
+    bool all_met = observations >= rule.min_observations;
+    for (size_t i = 0; i < rule.targets.size(); ++i) {
+        PrecisionResult r;
+        r.metric = rule.targets[i].metric;
+        r.target = rule.targets[i].relative_half_width;
+        r.interval = interval_of(i);
+        r.relative_half_width = r.interval.relative();
+        r.met = r.relative_half_width <= r.target;
+        all_met = all_met && r.met;
+        out.push_back(std::move(r));
+    }
+    return all_met;
+}
+
+}
+
+ReplicationRunner::ReplicationRunner(vector<IRNode> model, RunFn run, StoppingRule rule)
+    : model(std::move(model)),
+      run_fn(std::move(run)),
+      rule(std::move(rule)) {
+    if (this->rule.targets.empty())
+        throw std::invalid_argument("Stopping rule has no precision targets");
+}
+
+ReplicationReport ReplicationRunner::run() const {
+    return rule.mode == StoppingMode::BATCH_MEANS ? run_batch_means() : run_replications();
+}
+
+// ---------------- Independent replications ----------------
+
+ReplicationReport ReplicationRunner::run_replications() const {
+    if (rule.duration == 0)
+        throw std::invalid_argument("Independent replications need a positive duration");
+
+    ReplicationReport report;
+    vector<RunningStat> stats(rule.targets.size());
+    SimTime start = rule.warmup;
+
+    unsigned wave = rule.threads ? rule.threads : std::max(1u, std::thread::hardware_concurrency());
+    EntityFactory factory;
+
+    //detected warm-up: simulated once, every replication forks the post-warm-up state
+    std::optional<WarmupResult> warmed;
+    if (rule.auto_warmup) {
+        warmed = WarmupDetector(model, run_fn, *rule.auto_warmup).run(rule.seed, WARMUP_REPLICA);
+        report.warmup = warmed->report;
+        report.simulated = warmed->report.simulated;
+        start = warmed->report.simulated;
+    }
+    const SimTime end = start + rule.duration;
+
+    auto replicate = [&](size_t replica) {
+        RandomStreams streams(rule.seed, replica);
+        if (warmed) {
+            Simulation sim = warmed->state.fork();
+            sim.reseed(streams);
+            return run_fn(sim, streams, start, end);
+        }
+        Simulation sim;
+        factory.build(model, sim, streams);
+        if (rule.warmup > 0) run_fn(sim, streams, 0, rule.warmup);
+        return run_fn(sim, streams, start, end);
+    };
+
+    //replications run in parallel waves but are consumed strictly in replica order, so the
+    //stopping point (and therefore the report) does not depend on thread timing
+    size_t next = 0;
+    while (next < rule.max_observations) {
+        size_t count = std::min<size_t>(wave, rule.max_observations - next);
+        vector<Metrics> results(count);
+        vector<std::thread> pool;
+        std::exception_ptr failure;
+        std::mutex failure_mutex;
+        std::atomic<size_t> cursor{0};
+
+        auto worker = [&]() {
+            while (true) {
+                size_t i = cursor.fetch_add(1);
+                if (i >= count) break;
+                try { results[i] = replicate(next + i); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(failure_mutex);
+                    if (!failure) failure = std::current_exception();
+                    cursor = count;
+                }
+            }
+        };
+        for (unsigned t = 1; t < std::min<size_t>(wave, count); ++t) pool.emplace_back(worker);
+        worker();
+        for (auto& t : pool) t.join();
+        if (failure) std::rethrow_exception(failure);
+
+        for (auto& m : results) {
+            ++report.observations;
+            report.simulated += warmed ? rule.duration : end;
+            for (size_t i = 0; i < rule.targets.size(); ++i) {
+                if (const double* v = find_metric(m, rule.targets[i].metric))
+                    stats[i].add(*v);
+            }
+            report.converged = evaluate(rule,
+                [&](size_t i) { return confidence_interval(stats[i], rule.confidence); },
+                report.observations, report.precision);
+            if (report.converged) return report;
+        }
+        next += count;
+    }
+    return report;
+}
+
+// ---------------- Batch means ----------------
+
+ReplicationReport ReplicationRunner::run_batch_means() const {
+    if (rule.batch_window == 0)
+        throw std::invalid_argument("Batch means need a positive batch_window");
+
+    ReplicationReport report;
+    vector<BatchMeans> batches(rule.targets.size(), BatchMeans(rule.max_batches));
+
+    RandomStreams streams(rule.seed, 0);
+    Simulation sim;
+    SimTime t = 0;
+
+    if (rule.auto_warmup) {
+        //the detection run is the start of the long run; windows after it are measured
+        WarmupResult warmed = WarmupDetector(model, run_fn, *rule.auto_warmup).run(rule.seed);
+        report.warmup = warmed.report;
+        sim = std::move(warmed.state);
+        streams = std::move(warmed.streams);
+        t = warmed.report.simulated;
+    } else {
+        EntityFactory factory;
+        factory.build(model, sim, streams);
+        if (rule.warmup > 0) {
+            run_fn(sim, streams, 0, rule.warmup);
+            t = rule.warmup;
+        }
+    }
+
+    while (report.observations < rule.max_observations) {
+        Metrics m = run_fn(sim, streams, t, t + rule.batch_window);
+        t += rule.batch_window;
+        ++report.observations;
+
+        for (size_t i = 0; i < rule.targets.size(); ++i) {
+            if (const double* v = find_metric(m, rule.targets[i].metric))
+                batches[i].add(*v);
+        }
+
+        size_t formed = batches.front().batch_count();
+        for (auto& b : batches) formed = std::min(formed, b.batch_count());
+        report.batches = formed;
+
+        report.converged = evaluate(rule,
+            [&](size_t i) { return batches[i].interval(rule.confidence); },
+            formed, report.precision);
+        if (report.converged) break;
+    }
+
+    report.simulated = t;
+    return report;
+}
@@ -0,0 +1,79 @@
+//replication.h runs a model until the requested precision is reached instead of for a guessed length
+//
+//INDEPENDENT_REPLICATIONS: each replication is a fresh run (own RandomStreams replica) over
+//  [warmup, warmup + duration); one observation per metric per replication.
+//BATCH_MEANS: one long run advanced in windows of batch_window; each window is one observation,
+//  grouped into batch means so the interval accounts for autocorrelation.
+//after every observation the Student-t interval of each target metric is checked; the run stops as
+//soon as every target's relative half width is at or below its goal (or a budget is exhausted).
+//with auto_warmup set, the warm-up is detected once (MSER) instead of using `warmup`: batch means
+//continue from the detection run, replications fork its post-warm-up state and reseed the
+//entities' own engines from their replica, so the forks stay independent.
+#pragma once
+#include "run_types.h"
+#include "warmup.h"
+#include "../stats/confidence.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+enum class StoppingMode {
+    INDEPENDENT_REPLICATIONS,
+    BATCH_MEANS
+};
+
+struct PrecisionTarget {
+    std::string metric;             //key in the Metrics returned by the RunFn, e.g. "route.checkout.p99"
+    double relative_half_width;     //e.g. 0.05 = +/-5% of the mean
+};
+
+struct StoppingRule {
+    StoppingMode mode = StoppingMode::INDEPENDENT_REPLICATIONS;
+    std::vector<PrecisionTarget> targets;
+    double confidence = 0.95;
+
+    std::size_t min_observations = 5;   //replications, or batches in BATCH_MEANS
+    std::size_t max_observations = 1000;
+
+    SimTime warmup = 0;
+    std::optional<WarmupRule> auto_warmup;
+    SimTime duration = 0;               //INDEPENDENT_REPLICATIONS: measured length of each replication
+    SimTime batch_window = 0;           //BATCH_MEANS: length of one observation window
+    std::size_t max_batches = 64;       //BATCH_MEANS: memory bound of the batch-means accumulator
+
+    uint64_t seed = 1;
+    unsigned threads = 0;               //replications run in waves of this size; 0 = hardware concurrency
+};
+
+struct PrecisionResult {
+    std::string metric;
+    ConfidenceInterval interval;
+    double relative_half_width = 0.0;   //achieved
+    double target = 0.0;                //requested
+    bool met = false;
+};
+
+struct ReplicationReport {
+    bool converged = false;             //every target met before the budget ran out
+    std::size_t observations = 0;       //replications, or windows in BATCH_MEANS
+    std::size_t batches = 0;            //BATCH_MEANS only
+    SimTime simulated = 0;              //total simulated time, warm-up included
+    WarmupReport warmup;                //filled when auto_warmup is set
+    std::vector<PrecisionResult> precision;
+};
+
+class ReplicationRunner {
+private:
+    std::vector<IRNode> model;
+    RunFn run_fn;
+    StoppingRule rule;
+
+    ReplicationReport run_replications() const;
+    ReplicationReport run_batch_means() const;
+
+public:
+    ReplicationRunner(std::vector<IRNode> model, RunFn run, StoppingRule rule);
+
+    ReplicationReport run() const;
+};
@@ -0,0 +1,51 @@
+#include "result_table.h"
+#include <limits>
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+constexpr double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+}
+
+size_t ResultTable::add_column(const string& name) {
+    auto it = index.find(name);
+    if (it != index.end()) return it->second;
+
+    names.push_back(name);
+    columns.emplace_back(row_count, MISSING);
+    return index[name] = columns.size() - 1;
+}
+
+size_t ResultTable::add_row() {
+    for (auto& c : columns) c.push_back(MISSING);
+    return row_count++;
+}
+
+void ResultTable::set(size_t column, size_t row, double value) {
+    columns[column][row] = value;
+}
+
+const vector<double>* ResultTable::find(const string& name) const {
+    auto it = index.find(name);
+    return it == index.end() ? nullptr : &columns[it->second];
+}
+
+void ResultTable::write_csv(std::ostream& os) const {
+    for (size_t c = 0; c < names.size(); ++c)
+        os << (c ? "," : "") << names[c];
+    os << "\n";
+
+    auto precision = os.precision(std::numeric_limits<double>::max_digits10);
+    for (size_t r = 0; r < row_count; ++r) {
+        for (size_t c = 0; c < columns.size(); ++c) {
+            if (c) os << ",";
+            if (columns[c][r] == columns[c][r]) os << columns[c][r]; //NaN stays an empty cell
+        }
+        os << "\n";
+    }
+    os.precision(precision);
+}
@@ -0,0 +1,31 @@
+//result_table.h is a columnar table of doubles: one contiguous vector per column
+//cells that were never set (e.g. a metric a run did not report) hold NaN
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ResultTable {
+private:
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> columns;
+    std::unordered_map<std::string, std::size_t> index;
+    std::size_t row_count = 0;
+
+public:
+    //returns the index of the named column, creating it (NaN-filled) when missing
+    std::size_t add_column(const std::string& name);
+    std::size_t add_row();
+
+    void set(std::size_t column, std::size_t row, double value);
+
+    std::size_t rows() const { return row_count; }
+    std::size_t cols() const { return columns.size(); }
+    const std::vector<std::string>& column_names() const { return names; }
+    const std::vector<double>& column(std::size_t i) const { return columns[i]; }
+    const std::vector<double>* find(const std::string& name) const;
+
+    void write_csv(std::ostream& os) const;
+};
@@ -0,0 +1,20 @@
+//run_types.h defines the contract between the run/replication layer and a simulation model
+#pragma once
+#include "../core/sim_types.h"
+#include "../core/random_streams.h"
+#include "../factory/factory.h"
+#include <functional>
+#include <map>
+#include <string>
+
+using Metrics = std::map<std::string, double>;
+
+//advances `simulation` over the simulated window [from, to) and returns the metrics observed
+//inside that window. everything that has to survive between two windows lives in `simulation`
+//and `streams`, which is what lets the runner fork a warmed-up state into several runs
+using RunFn = std::function<Metrics(
+    Simulation& simulation,
+    RandomStreams& streams,
+    SimTime from,
+    SimTime to
+)>;
@@ -0,0 +1,305 @@
+#include "sweep.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using std::size_t;
+using std::string;
+using std::vector;
+
+namespace {
+
+template <typename T>
+SweepAxis make_field_axis(string name, string node_id, T IRNode::* member,
+                          vector<double> values, bool after_warmup) {
+    SweepAxis axis;
+    axis.name = std::move(name);
+    axis.values = std::move(values);
+    axis.after_warmup = after_warmup;
+    axis.apply = [node_id = std::move(node_id), member](vector<IRNode>& nodes, double v) {
+        for (auto& n : nodes)
+            if (n.id == node_id) { n.*member = static_cast<T>(v); return; }
+        throw std::runtime_error("Sweep axis targets unknown node: " + node_id);
+    };
+    return axis;
+}
+
+bool same_node(const IRNode& a, const IRNode& b) {
+    return a.capacity == b.capacity
+        && a.latency_mean == b.latency_mean
+        && a.failure_prob == b.failure_prob
+        && a.algorithm == b.algorithm
+        && a.backends == b.backends
+        && a.weights == b.weights
+        && a.from == b.from
+        && a.to == b.to
+        && a.bandwidth_mbps == b.bandwidth_mbps;
+}
+
+}
+
+SweepAxis SweepAxis::field(string name, string node_id, int IRNode::* member,
+                           vector<double> values, bool after_warmup) {
+    return make_field_axis(std::move(name), std::move(node_id), member, std::move(values), after_warmup);
+}
+
+SweepAxis SweepAxis::field(string name, string node_id, double IRNode::* member,
+                           vector<double> values, bool after_warmup) {
+    //a warmed link's capacity is registered in a FlowNetwork the fork cannot reach
+    if (after_warmup && member == &IRNode::bandwidth_mbps)
+        throw std::invalid_argument("Bandwidth axes cannot be applied after warm-up: " + name);
+    return make_field_axis(std::move(name), std::move(node_id), member, std::move(values), after_warmup);
+}
+
+SweepDriver::SweepDriver(vector<IRNode> base, RunFn run, SweepConfig config)
+    : base(std::move(base)),
+      run_fn(std::move(run)),
+      config(config) {}
+
+void SweepDriver::add_axis(SweepAxis axis) {
+    if (axis.values.empty())
+        throw std::invalid_argument("Sweep axis has no values: " + axis.name);
+    axes.push_back(std::move(axis));
+}
+
+// ---------------- Grid ----------------
+
+vector<SweepDriver::Point> SweepDriver::enumerate_points() const {
+    vector<Point> points(1, Point{vector<size_t>(axes.size(), 0)});
+
+    //mixed-radix counter, first axis varies slowest
+    for (size_t a = 0; a < axes.size(); ++a) {
+        vector<Point> next;
+        next.reserve(points.size() * axes[a].values.size());
+        for (auto& p : points) {
+            for (size_t v = 0; v < axes[a].values.size(); ++v) {
+                next.push_back(p);
+                next.back().coords[a] = v;
+            }
+        }
+        points = std::move(next);
+    }
+    return points;
+}
+
+vector<SweepDriver::Group> SweepDriver::group_points(const vector<Point>& points) const {
+    bool shared_warmup = config.warmup > 0 && std::any_of(axes.begin(), axes.end(),
+        [](const SweepAxis& a) { return a.after_warmup; });
+
+    vector<Group> groups;
+    if (!shared_warmup) {
+        for (size_t i = 0; i < points.size(); ++i) groups.push_back(Group{{i}});
+        return groups;
+    }
+
+    std::map<vector<size_t>, size_t> by_key;
+    for (size_t i = 0; i < points.size(); ++i) {
+        vector<size_t> key;
+        for (size_t a = 0; a < axes.size(); ++a)
+            if (!axes[a].after_warmup) key.push_back(points[i].coords[a]);
+
+        auto [it, inserted] = by_key.emplace(std::move(key), groups.size());
+        if (inserted) groups.emplace_back();
+        groups[it->second].points.push_back(i);
+    }
+    return groups;
+}
+
+void SweepDriver::apply_axes(const Point& p, vector<IRNode>& nodes, bool after_warmup) const {
+    for (size_t a = 0; a < axes.size(); ++a)
+        if (axes[a].after_warmup == after_warmup)
+            axes[a].apply(nodes, axes[a].values[p.coords[a]]);
+}
+
+// ---------------- Execution ----------------
+
+void SweepDriver::run_group(const Group& g, int replica, const vector<Point>& points,
+                            const std::function<void(size_t, Metrics)>& emit) const {
+    EntityFactory factory;
+    const SimTime end = config.warmup + config.duration;
+
+    if (config.warmup == 0) {
+        for (size_t pi : g.points) {
+            vector<IRNode> nodes = base;
+            apply_axes(points[pi], nodes, false);
+            apply_axes(points[pi], nodes, true);
+
+            RandomStreams streams(config.seed, replica);
+            Simulation sim;
+            factory.build(nodes, sim, streams);
+            emit(pi, run_fn(sim, streams, 0, end));
+        }
+        return;
+    }
+
+    //one warm-up with the post-warm-up axes still at their base values, then fork per point; a
+    //lone point is warmed the same way so its results match the shared path
+    vector<IRNode> warm_nodes = base;
+    apply_axes(points[g.points.front()], warm_nodes, false);
+
+    RandomStreams warm_streams(config.seed, replica);
+    Simulation warm;
+    factory.build(warm_nodes, warm, warm_streams);
+    run_fn(warm, warm_streams, 0, config.warmup);
+
+    for (size_t pi : g.points) {
+        vector<IRNode> nodes = warm_nodes;
+        apply_axes(points[pi], nodes, true);
+
+        const bool last = pi == g.points.back();
+        Simulation sim = last ? std::move(warm) : warm.fork();
+        RandomStreams streams = last ? std::move(warm_streams) : warm_streams;
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (!same_node(nodes[i], warm_nodes[i])) factory.rebuild(nodes[i], sim);
+
+        emit(pi, run_fn(sim, streams, config.warmup, end));
+    }
+}
+
+ResultTable SweepDriver::run() const {
+    const vector<Point> points = enumerate_points();
+    const vector<Group> groups = group_points(points);
+    const size_t replicas = replica_count();
+
+    vector<Metrics> results(points.size() * replicas);
+
+    //work unit = (group, replica); units are independent so workers just pull the next index
+    const size_t units = groups.size() * replicas;
+    unsigned threads = config.threads ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, units));
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+
+    auto worker = [&]() {
+        while (true) {
+            size_t u = next.fetch_add(1);
+            if (u >= units) break;
+            try {
+                int replica = static_cast<int>(u % replicas);
+                run_group(groups[u / replicas], replica, points, [&](size_t point, Metrics m) {
+                    results[point * replicas + replica] = std::move(m);
+                });
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failure_mutex);
+                if (!failure) failure = std::current_exception();
+                next = units; //stop handing out work
+            }
+        }
+    };
+
+    vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& t : pool) t.join();
+    if (failure) std::rethrow_exception(failure);
+    return assemble(results);
+}
+
+size_t SweepDriver::unit_count() const {
+    return group_points(enumerate_points()).size() * replica_count();
+}
+
+size_t SweepDriver::point_count() const {
+    size_t n = 1;
+    for (const auto& a : axes) n *= a.values.size();
+    return n;
+}
+
+vector<SweepDriver::UnitResult> SweepDriver::run_unit(size_t unit) const {
+    const vector<Point> points = enumerate_points();
+    const vector<Group> groups = group_points(points);
+    const size_t replicas = replica_count();
+    if (unit >= groups.size() * replicas) throw std::out_of_range("Sweep unit out of range");
+
+    vector<UnitResult> out;
+    int replica = static_cast<int>(unit % replicas);
+    run_group(groups[unit / replicas], replica, points, [&](size_t point, Metrics m) {
+        out.push_back({point, replica, std::move(m)});
+    });
+    return out;
+}
+
+uint64_t SweepDriver::fingerprint() const {
+    uint64_t h = 0xcbf29ce484222325ULL; //FNV-1a over the sweep's model and shape
+    auto mix = [&](uint64_t v) {
+        for (int i = 0; i < 8; ++i) {
+            h ^= (v >> (8 * i)) & 0xff;
+            h *= 0x100000001b3ULL;
+        }
+    };
+    auto mix_double = [&](double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        mix(bits);
+    };
+    //length first, so adjacent strings cannot trade characters
+    auto mix_text = [&](const string& s) {
+        mix(s.size());
+        for (unsigned char c : s) mix(c);
+    };
+
+    mix(config.seed);
+    mix(replica_count());
+    mix(config.warmup);
+    mix(config.duration);
+
+    //every field of the base model: two workers must not agree on a sweep over different models
+    mix(base.size());
+    for (const auto& n : base) {
+        mix_text(n.id);
+        mix(static_cast<uint64_t>(n.type));
+        mix(static_cast<uint64_t>(n.capacity));
+        mix_double(n.latency_mean);
+        mix_double(n.failure_prob);
+        mix_text(n.from);
+        mix_text(n.to);
+        mix_double(n.bandwidth_mbps);
+        mix(static_cast<uint64_t>(n.algorithm));
+        mix(n.backends.size());
+        for (const auto& b : n.backends) mix_text(b);
+        mix(n.weights.size());
+        for (int w : n.weights) mix(static_cast<uint64_t>(w));
+    }
+
+    for (const auto& a : axes) {
+        mix_text(a.name);
+        mix(a.after_warmup);
+        mix(a.values.size());
+        for (double v : a.values) mix_double(v);
+    }
+    return h;
+}
+
+ResultTable SweepDriver::assemble(const vector<Metrics>& results) const {
+    const vector<Point> points = enumerate_points();
+    const size_t replicas = replica_count();
+    if (results.size() != points.size() * replicas)
+        throw std::invalid_argument("Sweep results do not match the grid");
+
+    // ---- assemble the columnar table in grid order ----
+    ResultTable table;
+    size_t point_col = table.add_column("point");
+    size_t replica_col = table.add_column("replica");
+    vector<size_t> axis_cols;
+    for (auto& a : axes) axis_cols.push_back(table.add_column(a.name));
+
+    for (size_t p = 0; p < points.size(); ++p) {
+        for (size_t r = 0; r < replicas; ++r) {
+            size_t row = table.add_row();
+            table.set(point_col, row, static_cast<double>(p));
+            table.set(replica_col, row, static_cast<double>(r));
+            for (size_t a = 0; a < axes.size(); ++a)
+                table.set(axis_cols[a], row, axes[a].values[points[p].coords[a]]);
+            for (auto& [metric, value] : results[p * replicas + r])
+                table.set(table.add_column(metric), row, value);
+        }
+    }
+    return table;
+}
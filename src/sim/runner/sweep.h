@@ -0,0 +1,90 @@
+//sweep.h drives the factory -> simulate pipeline over a grid of parameter values
+//
+//every grid point is run `replicas` times; replica r of every point draws from the same
+//RandomStreams (common random numbers), so point-to-point differences are not swamped by noise.
+//axes marked after_warmup do not change the model during warm-up: points that only differ in
+//those axes share one simulated warm-up per replica and fork from it.
+#pragma once
+#include "run_types.h"
+#include "result_table.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct SweepAxis {
+    std::string name;                   //column name in the result table
+    std::vector<double> values;
+    std::function<void(std::vector<IRNode>&, double)> apply;
+    bool after_warmup = false;
+
+    //axis that sets a numeric field of one IR node, e.g. SweepAxis::field("db.capacity", "db", &IRNode::capacity, {...});
+    //bandwidth_mbps cannot be an after_warmup axis
+    static SweepAxis field(std::string name, std::string node_id, int IRNode::* member,
+                           std::vector<double> values, bool after_warmup = false);
+    static SweepAxis field(std::string name, std::string node_id, double IRNode::* member,
+                           std::vector<double> values, bool after_warmup = false);
+};
+
+struct SweepConfig {
+    uint64_t seed = 1;
+    int replicas = 1;
+    SimTime warmup = 0;     //simulated, metrics discarded
+    SimTime duration = 0;   //measured window after warm-up
+    unsigned threads = 0;   //0 = hardware concurrency
+};
+
+class SweepDriver {
+private:
+    std::vector<IRNode> base;
+    std::vector<SweepAxis> axes;
+    RunFn run_fn;
+    SweepConfig config;
+
+    struct Point {
+        std::vector<std::size_t> coords;    //value index per axis
+    };
+
+    struct Group {
+        std::vector<std::size_t> points;    //points sharing every pre-warm-up coordinate
+    };
+
+    std::vector<Point> enumerate_points() const;
+    std::vector<Group> group_points(const std::vector<Point>& points) const;
+    void apply_axes(const Point& p, std::vector<IRNode>& nodes, bool after_warmup) const;
+
+    //emit(point, metrics) once per point of the group
+    void run_group(const Group& g, int replica, const std::vector<Point>& points,
+                   const std::function<void(std::size_t, Metrics)>& emit) const;
+
+public:
+    //one run of a unit: results[point * replicas + replica] in assemble()'s input
+    struct UnitResult {
+        std::size_t point;
+        int replica;
+        Metrics metrics;
+    };
+
+    SweepDriver(std::vector<IRNode> base, RunFn run, SweepConfig config);
+
+    void add_axis(SweepAxis axis);
+
+    //one row per (point, replica) in grid order: point, replica, one column per axis, then metrics
+    ResultTable run() const;
+
+    // ---- pieces of run(), for running the units elsewhere (distributed.h) ----
+
+    //a unit is one (group, replica), the smallest part of the sweep that runs on its own
+    std::size_t unit_count() const;
+    std::vector<UnitResult> run_unit(std::size_t unit) const;
+
+    std::size_t point_count() const;
+    std::size_t replica_count() const { return static_cast<std::size_t>(std::max(config.replicas, 1)); }
+
+    //run()'s table from results indexed point * replicas + replica
+    ResultTable assemble(const std::vector<Metrics>& results) const;
+
+    //same value in every process that set up the same sweep; workers are checked against it
+    std::uint64_t fingerprint() const;
+};
@@ -0,0 +1,61 @@
+#include "warmup.h"
+#include <algorithm>
+#include <stdexcept>
+
+using std::size_t;
+using std::vector;
+
+WarmupDetector::WarmupDetector(vector<IRNode> model, RunFn run, WarmupRule rule)
+    : model(std::move(model)),
+      run_fn(std::move(run)),
+      rule(std::move(rule)) {
+    if (this->rule.metrics.empty())
+        throw std::invalid_argument("Warm-up detection needs at least one metric");
+    if (this->rule.window == 0)
+        throw std::invalid_argument("Warm-up detection needs a positive window");
+}
+
+WarmupResult WarmupDetector::run(uint64_t seed, uint64_t replica) const {
+    WarmupResult result{{}, {}, RandomStreams(seed, replica)};
+    EntityFactory factory;
+    factory.build(model, result.state, result.streams);
+
+    vector<MserDetector> detectors(rule.metrics.size(), MserDetector(rule.batch_size));
+    WarmupReport& report = result.report;
+    report.metrics = rule.metrics;
+
+    //the O(k) scan runs on a geometric schedule, keeping detection amortised linear
+    size_t next_check = std::max<size_t>(rule.min_observations, 2 * rule.batch_size);
+    SimTime t = 0;
+
+    for (size_t n = 1; n <= rule.max_observations; ++n) {
+        Metrics m = run_fn(result.state, result.streams, t, t + rule.window);
+        t += rule.window;
+
+        for (size_t i = 0; i < detectors.size(); ++i) {
+            auto it = m.find(rule.metrics[i]);
+            if (it != m.end()) detectors[i].add(it->second);
+        }
+
+        if (n < next_check && n < rule.max_observations) continue;
+        next_check = n + std::max<size_t>(n / 4, rule.batch_size);
+
+        report.points.clear();
+        bool all_found = true;
+        for (auto& d : detectors) {
+            report.points.push_back(d.truncation());
+            all_found = all_found && report.points.back().found;
+        }
+        if (all_found) {
+            report.detected = true;
+            break;
+        }
+    }
+
+    size_t first_kept = 0;
+    for (auto& p : report.points) first_kept = std::max(first_kept, p.observation);
+
+    report.truncation = static_cast<SimTime>(first_kept) * rule.window;
+    report.simulated = t;
+    return result;
+}
@@ -0,0 +1,47 @@
+//warmup.h detects the end of the initial transient online instead of relying on a padded warm-up
+//
+//the model is advanced in windows of `window`; each window's value of every watched metric feeds
+//an MSER detector. once every detector reports a truncation point in the first half of its series,
+//the warm-up ends at the latest of them. the model state reached at that moment is already past the
+//warm-up and is handed back, so replications and sweep points can fork from it instead of
+//simulating the transient again.
+#pragma once
+#include "run_types.h"
+#include "../stats/mser.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct WarmupRule {
+    std::vector<std::string> metrics;       //series to watch, e.g. "svc.queued_requests"
+    SimTime window = 0;                     //one observation per window
+    std::size_t batch_size = 5;             //MSER-5
+    std::size_t min_observations = 50;
+    std::size_t max_observations = 10000;
+};
+
+struct WarmupReport {
+    bool detected = false;                  //false: budget exhausted, `truncation` is a fallback
+    SimTime truncation = 0;                 //simulated time at which the warm-up ends
+    SimTime simulated = 0;                  //simulated time spent detecting it
+    std::vector<std::string> metrics;
+    std::vector<TruncationPoint> points;    //per watched metric, same order
+};
+
+struct WarmupResult {
+    WarmupReport report;
+    Simulation state;                       //model at report.simulated (past the warm-up)
+    RandomStreams streams;
+};
+
+class WarmupDetector {
+private:
+    std::vector<IRNode> model;
+    RunFn run_fn;
+    WarmupRule rule;
+
+public:
+    WarmupDetector(std::vector<IRNode> model, RunFn run, WarmupRule rule);
+
+    WarmupResult run(uint64_t seed, uint64_t replica = 0) const;
+};
@@ -0,0 +1,122 @@
+#include "confidence.h"
+#include <cmath>
+#include <limits>
+
+using std::size_t;
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+//Acklam's rational approximation of the standard normal quantile (|rel err| < 1.2e-9)
+double normal_quantile(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double lo = 0.02425, hi = 1 - lo;
+
+    if (p < lo) {
+        double q = std::sqrt(-2 * std::log(p));
+        return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+             / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+    }
+    if (p > hi) {
+        double q = std::sqrt(-2 * std::log(1 - p));
+        return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+              / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1);
+    }
+    double q = p - 0.5, r = q * q;
+    return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q
+         / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1);
+}
+
+}
+
+// ---------------- RunningStat ----------------
+
+void RunningStat::add(double x) {
+    ++n;
+    double delta = x - mu;
+    mu += delta / n;
+    m2 += delta * (x - mu);
+}
+
+void RunningStat::merge(const RunningStat& other) {
+    if (other.n == 0) return;
+    if (n == 0) { *this = other; return; }
+
+    size_t total = n + other.n;
+    double delta = other.mu - mu;
+    mu += delta * other.n / total;
+    m2 += other.m2 + delta * delta * (static_cast<double>(n) * other.n / total);
+    n = total;
+}
+
+// ---------------- Intervals ----------------
+
+double ConfidenceInterval::relative() const {
+    if (observations < 2) return std::numeric_limits<double>::infinity();
+    if (mean == 0.0) return half_width == 0.0 ? 0.0 : std::numeric_limits<double>::infinity();
+    return half_width / std::fabs(mean);
+}
+
+double student_t_quantile(double confidence, size_t dof) {
+    double p = (1 + confidence) / 2;
+
+    //closed forms for the tiny cases where the expansion below is poor
+    if (dof == 1) return std::tan(PI * (p - 0.5));
+    if (dof == 2) return (2 * p - 1) / std::sqrt(2 * p * (1 - p));
+
+    //Cornish-Fisher expansion around the normal quantile (Abramowitz & Stegun 26.7.5)
+    double z = normal_quantile(p), v = static_cast<double>(dof);
+    double z2 = z * z, z3 = z2 * z, z5 = z3 * z2, z7 = z5 * z2, z9 = z7 * z2;
+    double g1 = (z3 + z) / 4;
+    double g2 = (5*z5 + 16*z3 + 3*z) / 96;
+    double g3 = (3*z7 + 19*z5 + 17*z3 - 15*z) / 384;
+    double g4 = (79*z9 + 776*z7 + 1482*z5 - 1920*z3 - 945*z) / 92160;
+    return z + g1 / v + g2 / (v * v) + g3 / (v * v * v) + g4 / (v * v * v * v);
+}
+
+ConfidenceInterval confidence_interval(const RunningStat& s, double confidence) {
+    ConfidenceInterval ci;
+    ci.mean = s.mean();
+    ci.observations = s.count();
+    if (s.count() > 1)
+        ci.half_width = student_t_quantile(confidence, s.count() - 1)
+                      * std::sqrt(s.variance() / s.count());
+    return ci;
+}
+
+// ---------------- BatchMeans ----------------
+
+BatchMeans::BatchMeans(size_t max_batches)
+    : max_batches(max_batches < 4 ? 4 : max_batches & ~size_t(1)) {
+    batches.reserve(this->max_batches);
+}
+
+void BatchMeans::add(double x) {
+    partial_sum += x;
+    if (++partial_n < batch_size) return;
+
+    batches.push_back(partial_sum / partial_n);
+    partial_sum = 0.0;
+    partial_n = 0;
+
+    if (batches.size() == max_batches) {
+        for (size_t i = 0; i < max_batches / 2; ++i)
+            batches[i] = (batches[2 * i] + batches[2 * i + 1]) / 2;
+        batches.resize(max_batches / 2);
+        batch_size *= 2;
+    }
+}
+
+ConfidenceInterval BatchMeans::interval(double confidence) const {
+    RunningStat s;
+    for (double b : batches) s.add(b);
+    return confidence_interval(s, confidence);
+}
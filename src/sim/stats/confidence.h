@@ -0,0 +1,56 @@
+//confidence.h holds the small statistics toolkit used by the replication layer:
+//streaming mean/variance, Student-t intervals and a fixed-memory batch-means accumulator
+#pragma once
+#include <cstddef>
+#include <vector>
+
+//Welford's streaming mean/variance
+class RunningStat {
+private:
+    std::size_t n = 0;
+    double mu = 0.0;
+    double m2 = 0.0;
+
+public:
+    void add(double x);
+    void merge(const RunningStat& other); //parallel (Chan et al.) combination
+
+    std::size_t count() const { return n; }
+    double mean() const { return mu; }
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+};
+
+struct ConfidenceInterval {
+    double mean = 0.0;
+    double half_width = 0.0;
+    std::size_t observations = 0;
+
+    //half width relative to |mean|; infinite while the interval cannot be formed
+    double relative() const;
+};
+
+//two-sided Student-t quantile t_{(1+confidence)/2, dof}
+double student_t_quantile(double confidence, std::size_t dof);
+
+//interval over i.i.d. observations summarised by `s`
+ConfidenceInterval confidence_interval(const RunningStat& s, double confidence);
+
+//batch means over a single long run: observations are averaged into at most `max_batches`
+//batches; when full, adjacent batches are merged and the batch size doubles, so memory stays fixed
+//while the batches grow long enough to be roughly independent
+class BatchMeans {
+private:
+    std::size_t max_batches;
+    std::size_t batch_size = 1;     //observations per completed batch
+    std::vector<double> batches;    //completed batch means
+    double partial_sum = 0.0;
+    std::size_t partial_n = 0;
+
+public:
+    explicit BatchMeans(std::size_t max_batches = 64);
+
+    void add(double x);
+
+    std::size_t batch_count() const { return batches.size(); }
+    ConfidenceInterval interval(double confidence) const;
+};
@@ -0,0 +1,44 @@
+#include "mser.h"
+#include <limits>
+
+using std::size_t;
+
+MserDetector::MserDetector(size_t batch_size)
+    : batch_size(batch_size ? batch_size : 1) {}
+
+void MserDetector::add(double x) {
+    ++seen;
+    partial_sum += x;
+    if (++partial_n < batch_size) return;
+
+    double mean = partial_sum / batch_size;
+    prefix_sum.push_back(prefix_sum.back() + mean);
+    prefix_sq.push_back(prefix_sq.back() + mean * mean);
+    partial_sum = 0.0;
+    partial_n = 0;
+}
+
+TruncationPoint MserDetector::truncation() const {
+    TruncationPoint tp;
+    tp.observations = seen;
+
+    const size_t k = batches();
+    if (k < 4) return tp;
+
+    //search the whole range (excluding the last couple of batches, where the variance estimate
+    //degenerates) so a minimiser in the second half can be recognised as "run too short"
+    size_t best = 0;
+    double best_stat = std::numeric_limits<double>::infinity();
+    for (size_t d = 0; d + 2 < k; ++d) {
+        double n = static_cast<double>(k - d);
+        double sum = prefix_sum[k] - prefix_sum[d];
+        double sq = prefix_sq[k] - prefix_sq[d];
+        double stat = (sq - sum * sum / n) / (n * n);
+        if (stat < best_stat) { best_stat = stat; best = d; }
+    }
+
+    tp.found = best <= k / 2;
+    tp.observation = best * batch_size;
+    tp.statistic = best_stat;
+    return tp;
+}
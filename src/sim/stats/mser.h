@@ -0,0 +1,37 @@
+//mser.h implements MSER-m initial transient detection on a streaming series
+//
+//observations are averaged into batches of m (MSER-5 by default). for a candidate truncation
+//point d (in batches), MSER(d) = S^2(d) / (k - d), where S^2(d) is the variance of the batches
+//after d and k the batch count; the warm-up ends at the d minimising it. the statistic is only
+//trusted when the minimiser lies in the first half of the series, otherwise the run is too short.
+//prefix sums keep every evaluation O(k) with O(k) memory of batch means, not raw observations.
+#pragma once
+#include <cstddef>
+#include <vector>
+
+struct TruncationPoint {
+    bool found = false;             //false until the minimiser is inside the first half
+    std::size_t observation = 0;    //first observation kept (multiple of the batch size)
+    std::size_t observations = 0;   //observations seen when it was computed
+    double statistic = 0.0;         //MSER value at the truncation point
+};
+
+class MserDetector {
+private:
+    std::size_t batch_size;
+    std::vector<double> prefix_sum{0.0};    //prefix sums over batch means
+    std::vector<double> prefix_sq{0.0};
+    double partial_sum = 0.0;
+    std::size_t partial_n = 0;
+    std::size_t seen = 0;
+
+public:
+    explicit MserDetector(std::size_t batch_size = 5);
+
+    void add(double x);
+
+    std::size_t observations() const { return seen; }
+    std::size_t batches() const { return prefix_sum.size() - 1; }
+
+    TruncationPoint truncation() const;
+};
@@ -0,0 +1,210 @@
+// Reader for the simulator's columnar result files (src/sim/logging/result_file.h).
+//
+// Columns are typed-array views straight into the loaded buffer, so opening a
+// result costs one pass over the table headers, whatever the number of samples.
+// Only dictionary strings are decoded.
+
+const MAGIC = [0x53, 0x49, 0x4d, 0x52, 0x45, 0x53, 0x00, 0x01]; // "SIMRES\0\1"
+const VERSION = 1;
+
+const F64 = 1;
+const I64 = 2;
+const DICT = 3;
+
+export interface DictColumn {
+  kind: 'dict';
+  codes: Uint32Array;
+  values: string[];
+}
+
+export type Column = Float64Array | BigInt64Array | DictColumn;
+
+export interface ResultTable {
+  rows: number;
+  columns: Map<string, Column>;
+}
+
+export interface SeriesView {
+  entity: string;
+  metric: string;
+  time: Float64Array;
+  value: Float64Array;
+}
+
+export interface HistogramView {
+  entity: string;
+  metric: string;
+  upper: Float64Array;
+  count: BigInt64Array;
+}
+
+const decoder = new TextDecoder();
+
+const align8 = (n: number) => (n + 7) & ~7;
+
+export function readResultTables(data: ArrayBuffer | Uint8Array): Map<string, ResultTable> {
+  let bytes = data instanceof Uint8Array ? data : new Uint8Array(data);
+  // Typed-array views need aligned offsets; only a misaligned slice is copied
+  if (bytes.byteOffset % 8 !== 0) bytes = bytes.slice();
+
+  const { buffer, byteOffset: base, byteLength } = bytes;
+  const view = new DataView(buffer, base, byteLength);
+  let pos = 0;
+
+  const need = (n: number) => {
+    if (pos + n > byteLength) throw new Error(`Truncated result file at byte ${pos}`);
+  };
+  const u32 = () => {
+    need(4);
+    const v = view.getUint32(pos, true);
+    pos += 4;
+    return v;
+  };
+  const u64 = () => {
+    need(8);
+    const v = Number(view.getBigUint64(pos, true));
+    pos += 8;
+    return v;
+  };
+  const text = () => {
+    const length = u32();
+    need(length);
+    const s = decoder.decode(bytes.subarray(pos, pos + length));
+    pos = align8(pos + length);
+    return s;
+  };
+  const array = <T>(Type: { new (b: ArrayBuffer, o: number, n: number): T; BYTES_PER_ELEMENT: number }, n: number) => {
+    need(n * Type.BYTES_PER_ELEMENT);
+    const a = new Type(buffer as ArrayBuffer, base + pos, n);
+    pos = align8(pos + n * Type.BYTES_PER_ELEMENT);
+    return a;
+  };
+
+  need(MAGIC.length);
+  if (MAGIC.some((b, i) => bytes[i] !== b)) throw new Error('Not a simulation result file');
+  pos = MAGIC.length;
+  const version = u32();
+  if (version !== VERSION) throw new Error(`Unsupported result file version ${version}`);
+
+  const tables = new Map<string, ResultTable>();
+  const tableCount = u32();
+  for (let t = 0; t < tableCount; t++) {
+    const name = text();
+    const rows = u64();
+    const columnCount = u32();
+    u32();
+
+    const columns = new Map<string, Column>();
+    for (let c = 0; c < columnCount; c++) {
+      const columnName = text();
+      const type = u32();
+      u32();
+
+      if (type === F64) {
+        columns.set(columnName, array(Float64Array, rows));
+      } else if (type === I64) {
+        columns.set(columnName, array(BigInt64Array, rows));
+      } else if (type === DICT) {
+        const entries = u32();
+        u32();
+        const offsets = array(Uint32Array, entries + 1);
+        const start = pos;
+        need(offsets[entries]);
+        const values = Array.from({ length: entries }, (_, i) =>
+          decoder.decode(bytes.subarray(start + offsets[i], start + offsets[i + 1]))
+        );
+        pos = align8(start + offsets[entries]);
+        columns.set(columnName, { kind: 'dict', codes: array(Uint32Array, rows), values });
+      } else {
+        throw new Error(`Unknown column type ${type} in ${name}.${columnName}`);
+      }
+    }
+    tables.set(name, { rows, columns });
+  }
+  return tables;
+}
+
+export function dictValue(column: DictColumn, row: number): string {
+  return column.values[column.codes[row]];
+}
+
+// The standard tables of one run, with per-series and per-histogram views
+export class SimulationResults {
+  readonly tables: Map<string, ResultTable>;
+  private seriesIndex: Map<string, number> | null = null;
+
+  constructor(data: ArrayBuffer | Uint8Array) {
+    this.tables = readResultTables(data);
+  }
+
+  table(name: string): ResultTable | undefined {
+    return this.tables.get(name);
+  }
+
+  private column<T extends Column>(table: string, column: string): T {
+    const c = this.tables.get(table)?.columns.get(column);
+    if (!c) throw new Error(`Result file has no ${table}.${column}`);
+    return c as T;
+  }
+
+  get seriesCount(): number {
+    return this.tables.get('series')?.rows ?? 0;
+  }
+
+  // Views into the samples table; nothing is copied
+  seriesAt(i: number): SeriesView {
+    const first = Number(this.column<BigInt64Array>('series', 'first')[i]);
+    const count = Number(this.column<BigInt64Array>('series', 'count')[i]);
+    const timeFirst = Number(this.column<BigInt64Array>('series', 'time_first')[i]);
+    return {
+      entity: dictValue(this.column<DictColumn>('series', 'entity'), i),
+      metric: dictValue(this.column<DictColumn>('series', 'metric'), i),
+      // Series sampled at the same instants share their time axis
+      time: this.column<Float64Array>('sample_times', 'time').subarray(timeFirst, timeFirst + count),
+      value: this.column<Float64Array>('samples', 'value').subarray(first, first + count),
+    };
+  }
+
+  series(entity: string, metric: string): SeriesView | undefined {
+    if (!this.seriesIndex) {
+      this.seriesIndex = new Map();
+      const entities = this.column<DictColumn>('series', 'entity');
+      const metrics = this.column<DictColumn>('series', 'metric');
+      for (let i = 0; i < this.seriesCount; i++) {
+        this.seriesIndex.set(`${dictValue(entities, i)}\u0000${dictValue(metrics, i)}`, i);
+      }
+    }
+    const i = this.seriesIndex.get(`${entity}\u0000${metric}`);
+    return i === undefined ? undefined : this.seriesAt(i);
+  }
+
+  summary(): Array<{ entity: string; metric: string; value: number }> {
+    const entities = this.column<DictColumn>('summary', 'entity');
+    const metrics = this.column<DictColumn>('summary', 'metric');
+    const values = this.column<Float64Array>('summary', 'value');
+    return Array.from(values, (value, i) => ({
+      entity: dictValue(entities, i),
+      metric: dictValue(metrics, i),
+      value,
+    }));
+  }
+
+  histograms(): HistogramView[] {
+    const entities = this.column<DictColumn>('histograms', 'entity');
+    const metrics = this.column<DictColumn>('histograms', 'metric');
+    const first = this.column<BigInt64Array>('histograms', 'first');
+    const count = this.column<BigInt64Array>('histograms', 'count');
+    const upper = this.column<Float64Array>('histogram_bins', 'upper');
+    const counts = this.column<BigInt64Array>('histogram_bins', 'count');
+    return Array.from({ length: first.length }, (_, i) => {
+      const a = Number(first[i]);
+      const b = a + Number(count[i]);
+      return {
+        entity: dictValue(entities, i),
+        metric: dictValue(metrics, i),
+        upper: upper.subarray(a, b),
+        count: counts.subarray(a, b),
+      };
+    });
+  }
+}